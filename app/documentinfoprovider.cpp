@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Local
 #include <lib/document/documentfactory.h>
+#include <lib/document/editchain.h>
 #include <lib/semanticinfo/sorteddirmodel.h>
 
 namespace Gwenview
@@ -60,11 +61,7 @@ void DocumentInfoProvider::thumbnailForDocument(const QUrl &url, ThumbnailGroup:
         return;
     }
 
-    QImage image = doc->image();
-    if (image.width() > pixelSize || image.height() > pixelSize) {
-        image = image.scaled(pixelSize, pixelSize, Qt::KeepAspectRatio);
-    }
-    *outPix = QPixmap::fromImage(image);
+    *outPix = QPixmap::fromImage(doc->scaledImage(pixelSize));
     *outFullSize = doc->size();
 }
 
@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Local
 #include <lib/datewidget.h>
+#include <lib/filenameindex.h>
 #include <lib/semanticinfo/sorteddirmodel.h>
 #include <lib/timeutils.h>
 
@@ -69,6 +70,7 @@ public:
     };
     NameFilter(SortedDirModel* model)
     : AbstractSortedDirModelFilter(model)
+    , mIndex(new FileNameIndex(model->sourceModel(), this))
     , mText()
     , mMode(Contains)
     {}
@@ -85,25 +87,32 @@ public:
         }
         switch (mMode) {
             case Contains:
-                return index.data().toString().contains(mText, Qt::CaseInsensitive);
+                return mIndex->matches(index);
             default: /*DoesNotContain:*/
-                return !index.data().toString().contains(mText, Qt::CaseInsensitive);
+                return !mIndex->matches(index);
         }
     }
 
     void setText(const QString& text)
     {
         mText = text;
-        model()->applyFilters();
+        // No need to filter all rows again if the same items match
+        if (mIndex->setText(text)) {
+            model()->applyFilters();
+        }
     }
 
     void setMode(Mode mode)
     {
+        if (mMode == mode) {
+            return;
+        }
         mMode = mode;
         model()->applyFilters();
     }
 
 private:
+    FileNameIndex* mIndex;
     QString mText;
     Mode mMode;
 };
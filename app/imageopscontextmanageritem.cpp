@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 // Qt
 #include <QApplication>
 #include <QAction>
+#include <QProgressDialog>
 #include <QRect>
 #include "gwenview_app_debug.h"
 
@@ -39,6 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "gvcore.h"
 #include "mainwindow.h"
 #include "sidebar.h"
+#include <lib/batchimagejob.h>
 #include <lib/contextmanager.h>
 #include <lib/crop/croptool.h>
 #include <lib/document/documentfactory.h>
@@ -46,6 +48,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include <lib/eventwatcher.h>
 #include <lib/redeyereduction/redeyereductiontool.h>
 #include <lib/gwenviewconfig.h>
+#include <lib/mimetypeutils.h>
 #include <lib/resize/resizeimageoperation.h>
 #include <lib/resize/resizeimagedialog.h>
 #include <lib/transformimageoperation.h>
@@ -144,6 +147,81 @@ struct ImageOpsContextManagerItem::Private
         );
         return false;
     }
+
+    /**
+     * Transformations are applied to all the selected images when the
+     * browse view is visible
+     */
+    bool isBatchMode() const
+    {
+        return !mMainWindow->viewMainPage()->isVisible()
+            && q->contextManager()->selectedFileItemList().count() > 1;
+    }
+
+    bool selectionIsRasterImages() const
+    {
+        const KFileItemList list = q->contextManager()->selectedFileItemList();
+        for (const KFileItem& item : list) {
+            if (MimeTypeUtils::fileItemKind(item) != MimeTypeUtils::KIND_RASTER_IMAGE) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void applyTransformation(Orientation orientation)
+    {
+        if (!isBatchMode()) {
+            q->applyImageOperation(new TransformImageOperation(orientation));
+            return;
+        }
+
+        QList<QUrl> urls;
+        const KFileItemList list = q->contextManager()->selectedFileItemList();
+        for (const KFileItem& item : list) {
+            const QUrl url = item.url();
+            Document::Ptr doc = DocumentFactory::instance()->getCachedDocument(url);
+            if (doc && doc->isModified()) {
+                // Do not lose unsaved changes: transform the document instead
+                // of the file
+                TransformImageOperation* op = new TransformImageOperation(orientation);
+                op->applyToDocument(doc);
+            } else {
+                urls << url;
+            }
+        }
+        if (urls.isEmpty()) {
+            return;
+        }
+
+        BatchImageJob* job = new BatchImageJob(urls, {orientation});
+        QProgressDialog* dialog = new QProgressDialog(mMainWindow);
+        dialog->setLabelText(i18nc("@info:progress", "Modifying images..."));
+        dialog->setCancelButtonText(i18n("&Stop"));
+        dialog->setRange(0, urls.size());
+        dialog->setValue(0);
+        QObject::connect(dialog, &QProgressDialog::canceled, job, [job]() {
+            job->kill(KJob::EmitResult);
+        });
+        QObject::connect(job, &KJob::processedAmount, dialog, [dialog](KJob*, KJob::Unit, qulonglong amount) {
+            dialog->setValue(int(amount));
+        });
+        QObject::connect(job, &KJob::result, q, [this, job, dialog]() {
+            dialog->deleteLater();
+            const QStringList errorList = job->errorList();
+            if (errorList.isEmpty()) {
+                return;
+            }
+            QString msg = i18ncp("@info", "One image could not be modified:", "%1 images could not be modified:", errorList.count());
+            msg += "<ul>";
+            for (const QString& item : errorList) {
+                msg += "<li>" + item + "</li>";
+            }
+            msg += "</ul>";
+            KMessageBox::sorry(mMainWindow, msg);
+        });
+        job->start();
+    }
 };
 
 ImageOpsContextManagerItem::ImageOpsContextManagerItem(ContextManager* manager, MainWindow* mainWindow)
@@ -189,20 +267,23 @@ void ImageOpsContextManagerItem::updateSideBarContent()
 void ImageOpsContextManagerItem::updateActions()
 {
     bool canModify = contextManager()->currentUrlIsRasterImage();
+    bool canTransform = canModify;
     bool viewMainPageIsVisible = d->mMainWindow->viewMainPage()->isVisible();
     if (!viewMainPageIsVisible) {
-        // Since we only support image operations on one image for now,
-        // disable actions if several images are selected and the document
-        // view is not visible.
-        if (contextManager()->selectedFileItemList().count() != 1) {
+        // Transformations can be applied to several images at once, other
+        // operations only support one image for now: disable them if
+        // several images are selected and the document view is not visible.
+        const int count = contextManager()->selectedFileItemList().count();
+        if (count != 1) {
             canModify = false;
         }
+        canTransform = count == 1 ? canModify : (count > 1 && d->selectionIsRasterImages());
     }
 
-    d->mRotateLeftAction->setEnabled(canModify);
-    d->mRotateRightAction->setEnabled(canModify);
-    d->mMirrorAction->setEnabled(canModify);
-    d->mFlipAction->setEnabled(canModify);
+    d->mRotateLeftAction->setEnabled(canTransform);
+    d->mRotateRightAction->setEnabled(canTransform);
+    d->mMirrorAction->setEnabled(canTransform);
+    d->mFlipAction->setEnabled(canTransform);
     d->mResizeAction->setEnabled(canModify);
     d->mCropAction->setEnabled(canModify && viewMainPageIsVisible);
     d->mRedEyeReductionAction->setEnabled(canModify && viewMainPageIsVisible);
@@ -212,26 +293,22 @@ void ImageOpsContextManagerItem::updateActions()
 
 void ImageOpsContextManagerItem::rotateLeft()
 {
-    TransformImageOperation* op = new TransformImageOperation(ROT_270);
-    applyImageOperation(op);
+    d->applyTransformation(ROT_270);
 }
 
 void ImageOpsContextManagerItem::rotateRight()
 {
-    TransformImageOperation* op = new TransformImageOperation(ROT_90);
-    applyImageOperation(op);
+    d->applyTransformation(ROT_90);
 }
 
 void ImageOpsContextManagerItem::mirror()
 {
-    TransformImageOperation* op = new TransformImageOperation(HFLIP);
-    applyImageOperation(op);
+    d->applyTransformation(HFLIP);
 }
 
 void ImageOpsContextManagerItem::flip()
 {
-    TransformImageOperation* op = new TransformImageOperation(VFLIP);
-    applyImageOperation(op);
+    d->applyTransformation(VFLIP);
 }
 
 void ImageOpsContextManagerItem::resizeImage()
@@ -22,9 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include "saveallhelper.h"
 
 // Qt
-#include <QFuture>
-#include <QFutureWatcher>
-#include <QSet>
+#include <QFileInfo>
+#include <QHash>
 #include <QStringList>
 #include <QUrl>
 #include <QProgressDialog>
@@ -34,21 +33,128 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <KMessageBox>
 
 // Local
+#include "savequeue.h"
 #include <lib/document/document.h>
 #include <lib/document/documentfactory.h>
 #include <lib/document/documentjob.h>
+#include <lib/gwenviewconfig.h>
 
 namespace Gwenview
 {
 
+/**
+ * Returns the size the saved file of the document at @p url should have, so
+ * that progress can be reported in bytes before it is known
+ */
+static qint64 estimatedFileSize(const QUrl& url)
+{
+    if (url.isLocalFile()) {
+        const qint64 size = QFileInfo(url.toLocalFile()).size();
+        if (size > 0) {
+            return size;
+        }
+    }
+    const Document::Ptr doc = DocumentFactory::instance()->getCachedDocument(url);
+    // Assume a compression ratio close to the one of JPEG images
+    return doc ? qMax(qint64(1), qint64(doc->width()) * doc->height() / 4) : 1;
+}
+
+/**
+ * Returns the memory needed to save @p doc: pending edits are applied to the
+ * full image, and the encoder works on a copy of it in the worst case
+ */
+static qint64 documentMemoryCost(const Document::Ptr& doc)
+{
+    return qint64(doc->width()) * doc->height() * 4;
+}
+
+struct RunningSave
+{
+    qint64 mEstimatedSize;
+    qint64 mWrittenBytes;
+};
+
+struct SaveAllHelperPrivate;
+
+/**
+ * Loads documents only when their turn comes
+ */
+class DocumentSaveQueue : public SaveQueue
+{
+public:
+    DocumentSaveQueue(SaveAllHelperPrivate* helper, QObject* parent);
+
+protected:
+    qint64 memoryCost(const QUrl& url) override;
+    KJob* createJob(const QUrl& url) override;
+
+private:
+    SaveAllHelperPrivate* mHelper;
+};
+
 struct SaveAllHelperPrivate
 {
     QWidget* mParent;
     QProgressDialog* mProgressDialog;
-    QSet<DocumentJob*> mJobSet;
+    DocumentSaveQueue* mQueue;
+    QHash<KJob*, RunningSave> mRunningSaves;
     QStringList mErrorList;
+
+    // Progress is counted in bytes: mDoneBytes holds the estimated sizes of
+    // the documents which are done
+    qint64 mTotalBytes;
+    qint64 mDoneBytes;
+
+    void addError(const QUrl& url, const QString& message)
+    {
+        QString name = url.fileName().isEmpty() ? url.toDisplayString() : url.fileName();
+        mErrorList << xi18nc("@info %1 is the name of the document which failed to save, %2 is the reason for the failure",
+                             "<filename>%1</filename>: %2", name, kxi18n(qPrintable(message)));
+    }
+
+    void updateProgress()
+    {
+        qint64 bytes = mDoneBytes;
+        for (const RunningSave& save : qAsConst(mRunningSaves)) {
+            bytes += qMin(save.mWrittenBytes, save.mEstimatedSize);
+        }
+        const int maximum = mProgressDialog->maximum();
+        if (mQueue->isEmpty()) {
+            // Reaching the maximum closes the dialog
+            mProgressDialog->setValue(maximum);
+        } else {
+            mProgressDialog->setValue(qMin(int(bytes / 1024), maximum - 1));
+        }
+    }
 };
 
+DocumentSaveQueue::DocumentSaveQueue(SaveAllHelperPrivate* helper, QObject* parent)
+: SaveQueue(GwenviewConfig::saveAllConcurrency(), qint64(GwenviewConfig::saveAllMemoryBudget()) * 1024 * 1024, parent)
+, mHelper(helper)
+{
+}
+
+qint64 DocumentSaveQueue::memoryCost(const QUrl& url)
+{
+    return documentMemoryCost(DocumentFactory::instance()->load(url));
+}
+
+KJob* DocumentSaveQueue::createJob(const QUrl& url)
+{
+    Document::Ptr doc = DocumentFactory::instance()->load(url);
+    DocumentJob* job = doc->save(url, doc->format());
+    if (!job) {
+        mHelper->addError(url, doc->errorString());
+        mHelper->mDoneBytes += estimatedFileSize(url);
+        return nullptr;
+    }
+    // Once the job is gone, nothing but the cache holds the document
+    connect(job, &QObject::destroyed, this, [url]() {
+        DocumentFactory::instance()->release(url);
+    });
+    return job;
+}
+
 SaveAllHelper::SaveAllHelper(QWidget* parent)
 : d(new SaveAllHelperPrivate)
 {
@@ -58,6 +164,11 @@ SaveAllHelper::SaveAllHelper(QWidget* parent)
     d->mProgressDialog->setLabelText(i18nc("@info:progress saving all image changes", "Saving..."));
     d->mProgressDialog->setCancelButtonText(i18n("&Stop"));
     d->mProgressDialog->setMinimum(0);
+    d->mQueue = new DocumentSaveQueue(d, this);
+    connect(d->mQueue, &SaveQueue::jobStarted, this, &SaveAllHelper::slotJobStarted);
+    connect(d->mQueue, &SaveQueue::jobFinished, this, &SaveAllHelper::slotJobFinished);
+    d->mTotalBytes = 0;
+    d->mDoneBytes = 0;
 }
 
 SaveAllHelper::~SaveAllHelper()
@@ -68,14 +179,18 @@ SaveAllHelper::~SaveAllHelper()
 void SaveAllHelper::save()
 {
     const QList<QUrl> list = DocumentFactory::instance()->modifiedDocumentList();
-    d->mProgressDialog->setRange(0, list.size());
-    d->mProgressDialog->setValue(0);
+    if (list.isEmpty()) {
+        return;
+    }
     for (const QUrl &url : list) {
-        Document::Ptr doc = DocumentFactory::instance()->load(url);
-        DocumentJob* job = doc->save(url, doc->format());
-        connect(job, &DocumentJob::result, this, &SaveAllHelper::slotResult);
-        d->mJobSet << job;
+        d->mQueue->enqueue(url);
+        d->mTotalBytes += estimatedFileSize(url);
     }
+    // Count in kilobytes, QProgressDialog only takes ints
+    d->mProgressDialog->setRange(0, qMax(1, int(d->mTotalBytes / 1024)));
+    d->mProgressDialog->setValue(0);
+    d->mQueue->startJobs();
+    d->updateProgress();
 
     d->mProgressDialog->exec();
 
@@ -93,22 +208,40 @@ void SaveAllHelper::save()
 
 void SaveAllHelper::slotCanceled()
 {
-    for (DocumentJob * job : qAsConst(d->mJobSet)) {
-        job->kill();
+    d->mQueue->cancel();
+    d->mRunningSaves.clear();
+}
+
+void SaveAllHelper::slotProcessedAmount(KJob* job, KJob::Unit unit, qulonglong amount)
+{
+    if (unit != KJob::Bytes) {
+        return;
     }
+    auto it = d->mRunningSaves.find(job);
+    if (it == d->mRunningSaves.end()) {
+        return;
+    }
+    it->mWrittenBytes = amount;
+    d->updateProgress();
 }
 
-void SaveAllHelper::slotResult(KJob* _job)
+void SaveAllHelper::slotJobStarted(const QUrl& url, KJob* job)
+{
+    connect(job, &KJob::processedAmount, this, &SaveAllHelper::slotProcessedAmount);
+    RunningSave save;
+    save.mEstimatedSize = estimatedFileSize(url);
+    save.mWrittenBytes = 0;
+    d->mRunningSaves.insert(job, save);
+    d->updateProgress();
+}
+
+void SaveAllHelper::slotJobFinished(const QUrl& url, KJob* job)
 {
-    DocumentJob* job = static_cast<DocumentJob*>(_job);
     if (job->error()) {
-        QUrl url = job->document()->url();
-        QString name = url.fileName().isEmpty() ? url.toDisplayString() : url.fileName();
-        d->mErrorList << xi18nc("@info %1 is the name of the document which failed to save, %2 is the reason for the failure",
-                                "<filename>%1</filename>: %2", name, kxi18n(qPrintable(job->errorString())));
+        d->addError(url, job->errorString());
     }
-    d->mJobSet.remove(job);
-    d->mProgressDialog->setValue(d->mProgressDialog->value() + 1);
+    d->mDoneBytes += d->mRunningSaves.take(job).mEstimatedSize;
+    d->updateProgress();
 }
 
 } // namespace
@@ -25,11 +25,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <QObject>
 
 // KDE
+#include <KJob>
 
 // Local
 
-class KJob;
-
 namespace Gwenview
 {
 
@@ -45,7 +44,9 @@ public:
 
 private Q_SLOTS:
     void slotCanceled();
-    void slotResult(KJob*);
+    void slotProcessedAmount(KJob*, KJob::Unit, qulonglong);
+    void slotJobStarted(const QUrl& url, KJob* job);
+    void slotJobFinished(const QUrl& url, KJob* job);
 
 private:
     SaveAllHelperPrivate* const d;
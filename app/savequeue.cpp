@@ -0,0 +1,130 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "savequeue.h"
+
+// Qt
+#include <QHash>
+#include <QQueue>
+#include <QUrl>
+
+// KDE
+#include <KJob>
+
+// Local
+
+namespace Gwenview
+{
+
+struct RunningJob
+{
+    QUrl mUrl;
+    qint64 mMemoryCost;
+};
+
+struct SaveQueuePrivate
+{
+    int mMaxRunningJobs;
+    qint64 mMemoryBudget;
+    QQueue<QUrl> mPendingUrls;
+    QHash<KJob*, RunningJob> mRunningJobs;
+    qint64 mRunningMemoryCost;
+};
+
+SaveQueue::SaveQueue(int maxRunningJobs, qint64 memoryBudget, QObject* parent)
+: QObject(parent)
+, d(new SaveQueuePrivate)
+{
+    d->mMaxRunningJobs = qMax(1, maxRunningJobs);
+    d->mMemoryBudget = memoryBudget;
+    d->mRunningMemoryCost = 0;
+}
+
+SaveQueue::~SaveQueue()
+{
+    delete d;
+}
+
+void SaveQueue::enqueue(const QUrl& url)
+{
+    d->mPendingUrls.enqueue(url);
+}
+
+void SaveQueue::startJobs()
+{
+    while (!d->mPendingUrls.isEmpty() && d->mRunningJobs.count() < d->mMaxRunningJobs) {
+        const QUrl url = d->mPendingUrls.head();
+        const qint64 cost = memoryCost(url);
+        if (!d->mRunningJobs.isEmpty() && d->mRunningMemoryCost + cost > d->mMemoryBudget) {
+            break;
+        }
+        d->mPendingUrls.dequeue();
+
+        KJob* job = createJob(url);
+        if (!job) {
+            continue;
+        }
+        connect(job, &KJob::result, this, &SaveQueue::slotResult);
+        RunningJob running;
+        running.mUrl = url;
+        running.mMemoryCost = cost;
+        d->mRunningJobs.insert(job, running);
+        d->mRunningMemoryCost += cost;
+        emit jobStarted(url, job);
+    }
+}
+
+void SaveQueue::cancel()
+{
+    d->mPendingUrls.clear();
+    const QList<KJob*> jobs = d->mRunningJobs.keys();
+    d->mRunningJobs.clear();
+    d->mRunningMemoryCost = 0;
+    for (KJob* job : jobs) {
+        job->disconnect(this);
+        job->kill();
+    }
+}
+
+bool SaveQueue::isEmpty() const
+{
+    return d->mPendingUrls.isEmpty() && d->mRunningJobs.isEmpty();
+}
+
+int SaveQueue::runningJobCount() const
+{
+    return d->mRunningJobs.count();
+}
+
+qint64 SaveQueue::runningMemoryCost() const
+{
+    return d->mRunningMemoryCost;
+}
+
+void SaveQueue::slotResult(KJob* job)
+{
+    const RunningJob running = d->mRunningJobs.take(job);
+    d->mRunningMemoryCost -= running.mMemoryCost;
+    startJobs();
+    emit jobFinished(running.mUrl, job);
+}
+
+} // namespace
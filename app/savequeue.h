@@ -0,0 +1,104 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef SAVEQUEUE_H
+#define SAVEQUEUE_H
+
+// Qt
+#include <QObject>
+
+// KDE
+
+// Local
+
+class KJob;
+class QUrl;
+
+namespace Gwenview
+{
+
+struct SaveQueuePrivate;
+/**
+ * Runs one job per queued url, in order. At most maxRunningJobs jobs run at
+ * the same time, and no job is started while the memory cost of the running
+ * ones would exceed memoryBudget. One job always runs, whatever its cost.
+ *
+ * Subclasses tell how much memory the job of an url needs and create it.
+ */
+class SaveQueue : public QObject
+{
+    Q_OBJECT
+public:
+    SaveQueue(int maxRunningJobs, qint64 memoryBudget, QObject* parent = nullptr);
+    ~SaveQueue() override;
+
+    void enqueue(const QUrl& url);
+
+    /**
+     * Starts jobs for the queued urls, as many as the limits allow. Called
+     * again each time a job finishes.
+     */
+    void startJobs();
+
+    /**
+     * Drops the queued urls and kills the running jobs. jobFinished() is not
+     * emitted for them.
+     */
+    void cancel();
+
+    /**
+     * Returns true if there is no queued url and no running job
+     */
+    bool isEmpty() const;
+
+    int runningJobCount() const;
+
+    qint64 runningMemoryCost() const;
+
+Q_SIGNALS:
+    void jobStarted(const QUrl& url, KJob* job);
+
+    /**
+     * Emitted once the queue has started the jobs which could replace job
+     */
+    void jobFinished(const QUrl& url, KJob* job);
+
+protected:
+    /**
+     * Returns the memory the job of url needs while it runs
+     */
+    virtual qint64 memoryCost(const QUrl& url) = 0;
+
+    /**
+     * Creates and starts the job of url, or returns nullptr if url cannot be
+     * processed. The queue then moves on to the next url.
+     */
+    virtual KJob* createJob(const QUrl& url) = 0;
+
+private Q_SLOTS:
+    void slotResult(KJob* job);
+
+private:
+    SaveQueuePrivate* const d;
+};
+
+} // namespace
+
+#endif /* SAVEQUEUE_H */
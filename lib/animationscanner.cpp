@@ -0,0 +1,294 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "animationscanner.h"
+
+// STL
+#include <cstring>
+
+// Qt
+#include <QByteArray>
+#include "gwenview_lib_debug.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+namespace AnimationScanner
+{
+
+/**
+ * Bounds-checked cursor over the raw file data. All reads past the end
+ * return 0 and mark the reader as truncated, so that the parsers below do
+ * not need to check the size before each access.
+ */
+class Reader
+{
+public:
+    Reader(const QByteArray& data)
+    : mData(reinterpret_cast<const uchar*>(data.constData()))
+    , mSize(data.size())
+    , mPos(0)
+    {}
+
+    bool atEnd() const
+    {
+        return mPos >= mSize;
+    }
+
+    bool has(qint64 count) const
+    {
+        return mPos + count <= mSize;
+    }
+
+    qint64 pos() const
+    {
+        return mPos;
+    }
+
+    void seek(qint64 pos)
+    {
+        mPos = pos;
+    }
+
+    void skip(qint64 count)
+    {
+        mPos += count;
+    }
+
+    bool startsWith(const char* magic, int length, qint64 offset = 0) const
+    {
+        if (offset + length > mSize) {
+            return false;
+        }
+        return memcmp(mData + offset, magic, length) == 0;
+    }
+
+    uint byteAt(qint64 pos) const
+    {
+        return pos < mSize ? mData[pos] : 0;
+    }
+
+    uint readByte()
+    {
+        return byteAt(mPos++);
+    }
+
+    uint readUInt16LE()
+    {
+        uint value = byteAt(mPos) | byteAt(mPos + 1) << 8;
+        mPos += 2;
+        return value;
+    }
+
+    uint readUInt24LE()
+    {
+        uint value = byteAt(mPos) | byteAt(mPos + 1) << 8 | byteAt(mPos + 2) << 16;
+        mPos += 3;
+        return value;
+    }
+
+    quint32 readUInt32LE()
+    {
+        quint32 value = readUInt16LE();
+        return value | quint32(readUInt16LE()) << 16;
+    }
+
+    uint readUInt16BE()
+    {
+        uint value = byteAt(mPos) << 8 | byteAt(mPos + 1);
+        mPos += 2;
+        return value;
+    }
+
+    quint32 readUInt32BE()
+    {
+        quint32 value = quint32(readUInt16BE()) << 16;
+        return value | readUInt16BE();
+    }
+
+private:
+    const uchar* mData;
+    qint64 mSize;
+    qint64 mPos;
+};
+
+/**
+ * @return false if the data ended before the block terminator
+ */
+static bool skipGifSubBlocks(Reader* reader)
+{
+    while (!reader->atEnd()) {
+        uint length = reader->readByte();
+        if (length == 0) {
+            return true;
+        }
+        reader->skip(length);
+    }
+    return false;
+}
+
+static bool scanGif(Reader* reader, Info* info)
+{
+    // Header (6) + logical screen descriptor (7)
+    reader->seek(10);
+    uint flags = reader->readByte();
+    reader->skip(2);
+    if (flags & 0x80) {
+        reader->skip(3 * (2 << (flags & 7)));
+    }
+
+    int pendingDelay = 0;
+    while (!reader->atEnd()) {
+        uint introducer = reader->readByte();
+        if (introducer == 0x3B) {
+            // Trailer
+            break;
+        } else if (introducer == 0x21) {
+            uint label = reader->readByte();
+            if (label == 0xF9 && reader->has(4) && reader->byteAt(reader->pos()) >= 4) {
+                // Graphic control extension: delay is in 1/100th of second
+                reader->skip(2);
+                pendingDelay = reader->readUInt16LE() * 10;
+                reader->skip(-4);
+            }
+            skipGifSubBlocks(reader);
+        } else if (introducer == 0x2C) {
+            // Image descriptor, followed by the LZW minimum code size
+            reader->skip(8);
+            uint imageFlags = reader->readByte();
+            if (imageFlags & 0x80) {
+                reader->skip(3 * (2 << (imageFlags & 7)));
+            }
+            reader->skip(1);
+            if (!skipGifSubBlocks(reader)) {
+                // Truncated frame
+                break;
+            }
+            ++info->frameCount;
+            info->duration += pendingDelay;
+            pendingDelay = 0;
+        } else {
+            LOG("Unexpected GIF block" << introducer);
+            break;
+        }
+    }
+    return info->frameCount > 0;
+}
+
+static bool scanPng(Reader* reader, Info* info)
+{
+    reader->seek(8);
+    bool animated = false;
+    int fctlCount = 0;
+    while (reader->has(12)) {
+        quint32 length = reader->readUInt32BE();
+        qint64 dataPos = reader->pos() + 4;
+        if (reader->startsWith("acTL", 4, reader->pos())) {
+            reader->skip(4);
+            info->frameCount = reader->readUInt32BE();
+            animated = true;
+        } else if (reader->startsWith("fcTL", 4, reader->pos())) {
+            // sequence number (4), width, height, x and y offsets (16)
+            reader->skip(4 + 20);
+            uint delayNum = reader->readUInt16BE();
+            uint delayDen = reader->readUInt16BE();
+            if (delayDen == 0) {
+                delayDen = 100;
+            }
+            info->duration += delayNum * 1000 / delayDen;
+            ++fctlCount;
+        } else if (reader->startsWith("IDAT", 4, reader->pos()) && !animated) {
+            // acTL must come before the first IDAT chunk: this is a plain
+            // PNG, no need to go further
+            break;
+        } else if (reader->startsWith("IEND", 4, reader->pos())) {
+            break;
+        }
+        // Skip data and CRC
+        reader->seek(dataPos + qint64(length) + 4);
+    }
+
+    if (!animated) {
+        info->frameCount = 1;
+        info->duration = 0;
+    } else if (fctlCount > 0 && fctlCount < info->frameCount) {
+        // Truncated file, only trust what we have seen
+        info->frameCount = fctlCount;
+    }
+    return info->frameCount > 0;
+}
+
+static bool scanWebP(Reader* reader, Info* info)
+{
+    reader->seek(12);
+    while (reader->has(8)) {
+        qint64 fourccPos = reader->pos();
+        reader->skip(4);
+        quint32 length = reader->readUInt32LE();
+        qint64 dataPos = reader->pos();
+        if (reader->startsWith("ANMF", 4, fourccPos)) {
+            // Frame x, y, width and height (4 * 3 bytes), then duration
+            reader->skip(12);
+            info->duration += reader->readUInt24LE();
+            ++info->frameCount;
+        }
+        // Chunks are padded to an even size
+        reader->seek(dataPos + qint64(length) + (length & 1));
+    }
+
+    if (info->frameCount == 0) {
+        // Simple (VP8, VP8L) or extended WebP without animation
+        info->frameCount = 1;
+    }
+    return true;
+}
+
+bool scan(const QByteArray& data, Info* info)
+{
+    Q_ASSERT(info);
+    *info = Info();
+    Reader reader(data);
+    bool ok;
+    if (reader.startsWith("GIF87a", 6) || reader.startsWith("GIF89a", 6)) {
+        ok = scanGif(&reader, info);
+    } else if (reader.startsWith("\x89PNG\r\n\x1a\n", 8)) {
+        ok = scanPng(&reader, info);
+    } else if (reader.startsWith("RIFF", 4) && reader.startsWith("WEBP", 4, 8)) {
+        ok = scanWebP(&reader, info);
+    } else {
+        return false;
+    }
+    LOG("ok:" << ok << "frameCount:" << info->frameCount << "duration:" << info->duration);
+    return ok;
+}
+
+} // namespace
+
+} // namespace
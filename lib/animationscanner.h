@@ -0,0 +1,62 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef ANIMATIONSCANNER_H
+#define ANIMATIONSCANNER_H
+
+#include <lib/gwenviewlib_export.h>
+
+class QByteArray;
+
+namespace Gwenview
+{
+
+/**
+ * Reads the frame structure of GIF, APNG and WebP files by walking their
+ * container blocks, without decoding any pixel.
+ */
+namespace AnimationScanner
+{
+
+struct Info
+{
+    Info()
+    : frameCount(0)
+    , duration(0)
+    {}
+
+    int frameCount;
+    /// Sum of the frame delays, in milliseconds, as stored in the file
+    int duration;
+};
+
+/**
+ * Scans @p data and fills @p info.
+ * @return false if the format is not recognized or if the data is too
+ * truncated to contain a single frame. Callers should then fall back to
+ * QImageReader.
+ */
+GWENVIEWLIB_EXPORT bool scan(const QByteArray& data, Info* info);
+
+} // namespace
+
+} // namespace
+
+#endif /* ANIMATIONSCANNER_H */
@@ -0,0 +1,382 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "batchimagejob.h"
+
+// STL
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+// Qt
+#include <QBitArray>
+#include <QBuffer>
+#include <QFile>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QtConcurrentMap>
+#include "gwenview_lib_debug.h"
+
+// KDE
+#include <KLocalizedString>
+
+// Exiv2
+#include <exiv2/exiv2.hpp>
+
+// Local
+#include "document/documentfactory.h"
+#include "gwenviewconfig.h"
+#include "imageutils.h"
+#include "jpegcontent.h"
+#include "thumbnailprovider/thumbnailprovider.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+/**
+ * Formats which can be written back without losing pixels. Other formats
+ * are refused rather than re-encoded with a lower quality.
+ */
+static bool isLosslessFormat(const QByteArray& format)
+{
+    static const QByteArray formats[] = {"bmp", "pbm", "pgm", "png", "ppm", "tif", "tiff", "xbm", "xpm"};
+    return std::find(std::begin(formats), std::end(formats), format) != std::end(formats);
+}
+
+/**
+ * Processes one file. Runs in a worker thread, so it must not touch
+ * GwenviewConfig or any GUI object: everything it needs is copied in the
+ * constructor.
+ * Returns an empty string on success, an error message otherwise.
+ */
+struct BatchTransformer
+{
+    typedef QString result_type;
+
+    QVector<Orientation> mTransformations;
+    bool mApplyExifOrientation;
+
+    QString operator()(const QUrl& url) const
+    {
+        if (!url.isLocalFile()) {
+            return i18n("Only local files can be modified in batch.");
+        }
+        const QString path = url.toLocalFile();
+        QByteArray format = QImageReader::imageFormat(path);
+        if (format == "jpg") {
+            format = "jpeg";
+        }
+        if (format.isEmpty()) {
+            return i18n("Unknown image format.");
+        }
+        return format == "jpeg" ? transformJpeg(path) : transformImage(path, format);
+    }
+
+    QString transformJpeg(const QString& path) const
+    {
+        JpegContent content;
+        if (!content.load(path)) {
+            return i18n("Could not load the image.");
+        }
+
+        // thumbnail() already applies the Exif orientation, so the thumbnail
+        // only goes through the requested transformations
+        QImage thumbnail = content.thumbnail();
+
+        // Same steps as JpegDocumentLoadedImpl::applyTransformation()
+        if (mApplyExifOrientation) {
+            content.transform(content.orientation());
+            content.resetOrientation();
+        }
+        for (Orientation orientation : mTransformations) {
+            content.transform(orientation);
+            if (!thumbnail.isNull()) {
+                thumbnail = ImageUtils::transformed(thumbnail, orientation);
+            }
+        }
+        if (!thumbnail.isNull()) {
+            content.setThumbnail(thumbnail);
+        }
+
+        // Write to a new file: JpegContent reads its data from the original
+        // one until the transformation is applied
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return file.errorString();
+        }
+        if (!content.save(&file)) {
+            file.cancelWriting();
+            return content.errorString().isEmpty() ? i18n("Could not save the image.") : content.errorString();
+        }
+        if (!file.commit()) {
+            return file.errorString();
+        }
+        return QString();
+    }
+
+    QString transformImage(const QString& path, const QByteArray& format) const
+    {
+        if (!isLosslessFormat(format) || !QImageWriter::supportedImageFormats().contains(format)) {
+            return i18n("Gwenview cannot modify images in '%1' format without losing quality.", QString::fromLatin1(format));
+        }
+
+        QByteArray originalData;
+        {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                return file.errorString();
+            }
+            originalData = file.readAll();
+        }
+
+        QImage image;
+        QImage original;
+        bool orientationApplied = false;
+        {
+            QBuffer buffer(&originalData);
+            buffer.open(QIODevice::ReadOnly);
+            QImageReader reader(&buffer, format);
+            if (!reader.read(&original)) {
+                return reader.errorString();
+            }
+            image = original;
+            if (mApplyExifOrientation && reader.transformation() != QImageIOHandler::TransformationNone) {
+                image = ImageUtils::transformed(image, ImageUtils::orientationForTransformation(reader.transformation()));
+                orientationApplied = true;
+            }
+        }
+        for (Orientation orientation : mTransformations) {
+            image = ImageUtils::transformed(image, orientation);
+        }
+        // Text chunks are not carried over by transformations
+        const QStringList keys = original.textKeys();
+        for (const QString& key : keys) {
+            image.setText(key, original.text(key));
+        }
+
+        QByteArray data;
+        {
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::WriteOnly);
+            QImageWriter writer(&buffer, format);
+            if (!writer.write(image)) {
+                return writer.errorString();
+            }
+        }
+        if (!copyMetadata(originalData, orientationApplied, &data)) {
+            return i18n("Could not keep the metadata of the image.");
+        }
+
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return file.errorString();
+        }
+        if (file.write(data) != data.size()) {
+            file.cancelWriting();
+            return file.errorString();
+        }
+        if (!file.commit()) {
+            return file.errorString();
+        }
+        return QString();
+    }
+
+    /**
+     * Copies the Exif, IPTC and XMP metadata, the comment and the color
+     * profile of originalData to data. The orientation is reset if
+     * orientationApplied is true, since the pixels already have it.
+     * Returns false if some metadata could not be kept.
+     */
+    bool copyMetadata(const QByteArray& originalData, bool orientationApplied, QByteArray* data) const
+    {
+        std::unique_ptr<Exiv2::Image> source;
+        try {
+            source.reset(Exiv2::ImageFactory::open((const Exiv2::byte*)originalData.constData(), originalData.size()).release());
+            source->readMetadata();
+        } catch (const Exiv2::Error& error) {
+            // Nothing Exiv2 could keep
+            LOG("No metadata:" << error.what());
+            return true;
+        }
+        bool hasIccProfile = false;
+#if EXIV2_TEST_VERSION(0,27,0)
+        hasIccProfile = source->iccProfileDefined();
+#endif
+        if (source->exifData().empty() && source->iptcData().empty() && source->xmpData().empty()
+                && source->comment().empty() && !hasIccProfile) {
+            return true;
+        }
+
+        try {
+            std::unique_ptr<Exiv2::Image> target;
+            target.reset(Exiv2::ImageFactory::open((const Exiv2::byte*)data->constData(), data->size()).release());
+            target->setMetadata(*source);
+#if EXIV2_TEST_VERSION(0,27,0)
+            if (hasIccProfile) {
+                Exiv2::DataBuf profile(source->iccProfile()->pData_, source->iccProfile()->size_);
+                target->setIccProfile(profile);
+            }
+#endif
+            if (orientationApplied) {
+                Exiv2::ExifData& exifData = target->exifData();
+                Exiv2::ExifData::iterator it = exifData.findKey(Exiv2::ExifKey("Exif.Image.Orientation"));
+                if (it != exifData.end()) {
+                    *it = uint16_t(NORMAL);
+                }
+                Exiv2::XmpData& xmpData = target->xmpData();
+                Exiv2::XmpData::iterator xmpIt = xmpData.findKey(Exiv2::XmpKey("Xmp.tiff.Orientation"));
+                if (xmpIt != xmpData.end()) {
+                    xmpData.erase(xmpIt);
+                }
+            }
+            target->writeMetadata();
+
+            Exiv2::BasicIo& io = target->io();
+            io.seek(0, Exiv2::BasicIo::beg);
+            data->resize(io.size());
+            io.read((Exiv2::byte*)data->data(), io.size());
+        } catch (const Exiv2::Error& error) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not copy metadata:" << error.what();
+            return false;
+        }
+        return true;
+    }
+};
+
+struct BatchImageJobPrivate
+{
+    QList<QUrl> mUrls;
+    BatchTransformer mTransformer;
+    QFuture<QString> mFuture;
+    QFutureWatcher<QString> mWatcher;
+    QBitArray mHandled;
+    int mProcessedCount;
+    QStringList mErrorList;
+};
+
+BatchImageJob::BatchImageJob(const QList<QUrl>& urls, const QVector<Orientation>& transformations, QObject* parent)
+: KJob(parent)
+, d(new BatchImageJobPrivate)
+{
+    d->mUrls = urls;
+    d->mTransformer.mTransformations = transformations;
+    d->mTransformer.mApplyExifOrientation = GwenviewConfig::applyExifOrientation();
+    d->mHandled.resize(urls.size());
+    d->mProcessedCount = 0;
+    setCapabilities(Killable);
+    connect(&d->mWatcher, &QFutureWatcher<QString>::resultReadyAt, this, &BatchImageJob::slotResultReadyAt);
+    connect(&d->mWatcher, &QFutureWatcher<QString>::finished, this, &BatchImageJob::slotFinished);
+}
+
+BatchImageJob::~BatchImageJob()
+{
+    d->mWatcher.disconnect(this);
+    d->mFuture.cancel();
+    d->mFuture.waitForFinished();
+    delete d;
+}
+
+QStringList BatchImageJob::errorList() const
+{
+    return d->mErrorList;
+}
+
+void BatchImageJob::start()
+{
+    setTotalAmount(KJob::Files, d->mUrls.size());
+    if (d->mUrls.isEmpty()) {
+        emitResult();
+        return;
+    }
+    LOG("Processing" << d->mUrls.size() << "files");
+    d->mFuture = QtConcurrent::mapped(d->mUrls, d->mTransformer);
+    d->mWatcher.setFuture(d->mFuture);
+}
+
+void BatchImageJob::slotResultReadyAt(int index)
+{
+    if (d->mHandled.testBit(index)) {
+        return;
+    }
+    d->mHandled.setBit(index);
+    const QUrl url = d->mUrls.at(index);
+    const QString error = d->mFuture.resultAt(index);
+    if (error.isEmpty()) {
+        // The file changed behind our back: make sure nobody keeps using the
+        // old pixels
+        ThumbnailProvider::deleteImageThumbnail(url);
+        Document::Ptr doc = DocumentFactory::instance()->getCachedDocument(url);
+        if (doc) {
+            doc->reload();
+        }
+        emit urlProcessed(url);
+    } else {
+        LOG(url << "failed:" << error);
+        const QString name = url.fileName().isEmpty() ? url.toDisplayString() : url.fileName();
+        d->mErrorList << xi18nc("@info %1 is the name of the file which could not be modified, %2 is the reason for the failure",
+                                "<filename>%1</filename>: %2", name, error);
+    }
+    ++d->mProcessedCount;
+    setProcessedAmount(KJob::Files, d->mProcessedCount);
+}
+
+void BatchImageJob::slotFinished()
+{
+    if (d->mFuture.isCanceled()) {
+        // doKill() takes care of emitting the result
+        return;
+    }
+    if (!d->mErrorList.isEmpty()) {
+        setError(UserDefinedError);
+        setErrorText(i18np("One file could not be modified.", "%1 files could not be modified.", d->mErrorList.count()));
+    }
+    emitResult();
+}
+
+bool BatchImageJob::doKill()
+{
+    d->mWatcher.disconnect(this);
+    d->mFuture.cancel();
+    // Files which are being processed cannot be interrupted. Wait for them so
+    // that their documents and thumbnails get refreshed.
+    d->mFuture.waitForFinished();
+    for (int index = 0; index < d->mUrls.size(); ++index) {
+        if (d->mFuture.isResultReadyAt(index)) {
+            slotResultReadyAt(index);
+        }
+    }
+    return true;
+}
+
+} // namespace
@@ -0,0 +1,88 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef BATCHIMAGEJOB_H
+#define BATCHIMAGEJOB_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QList>
+#include <QStringList>
+#include <QUrl>
+#include <QVector>
+
+// KDE
+#include <KJob>
+
+// Local
+#include <lib/orientation.h>
+
+namespace Gwenview
+{
+
+struct BatchImageJobPrivate;
+
+/**
+ * Applies a chain of transformations to a list of image files, directly on
+ * disk and without going through Document.
+ *
+ * Files are processed in parallel on the global thread pool. JPEG files are
+ * transformed losslessly. Other formats are decoded and saved back in their
+ * original format, keeping their metadata, if the format is lossless: lossy
+ * formats are refused.
+ *
+ * Once a file has been processed, its thumbnail is invalidated and its
+ * document is reloaded if it is in the document cache. Documents with
+ * unsaved changes must not be passed to this job: they would be reloaded and
+ * lose their changes.
+ */
+class GWENVIEWLIB_EXPORT BatchImageJob : public KJob
+{
+    Q_OBJECT
+public:
+    BatchImageJob(const QList<QUrl>& urls, const QVector<Orientation>& transformations, QObject* parent = nullptr);
+    ~BatchImageJob() override;
+
+    void start() override;
+
+    /**
+     * Messages describing the files which could not be processed, formatted
+     * as "<filename>name</filename>: reason"
+     */
+    QStringList errorList() const;
+
+Q_SIGNALS:
+    void urlProcessed(const QUrl&);
+
+protected:
+    bool doKill() override;
+
+private Q_SLOTS:
+    void slotResultReadyAt(int index);
+    void slotFinished();
+
+private:
+    BatchImageJobPrivate* const d;
+};
+
+} // namespace
+
+#endif /* BATCHIMAGEJOB_H */
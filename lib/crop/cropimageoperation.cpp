@@ -48,9 +48,7 @@ public:
         if (!checkDocumentEditor()) {
             return;
         }
-        const QImage src = document()->image();
-        const QImage dst = src.copy(mRect);
-        document()->editor()->setImage(dst);
+        document()->editor()->applyCrop(mRect);
         setError(NoError);
     }
 
@@ -61,7 +59,6 @@ private:
 struct CropImageOperationPrivate
 {
     QRect mRect;
-    QImage mOriginalImage;
 };
 
 CropImageOperation::CropImageOperation(const QRect& rect)
@@ -78,7 +75,6 @@ CropImageOperation::~CropImageOperation()
 
 void CropImageOperation::redo()
 {
-    d->mOriginalImage = document()->image();
     redoAsDocumentJob(new CropJob(d->mRect));
 }
 
@@ -88,7 +84,7 @@ void CropImageOperation::undo()
         qCWarning(GWENVIEW_LIB_LOG) << "!document->editor()";
         return;
     }
-    document()->editor()->setImage(d->mOriginalImage);
+    document()->editor()->revertLastEdit();
     finish(true);
 }
 
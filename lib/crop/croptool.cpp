@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 // KDE
 
 // Local
+#include <lib/document/abstractdocumenteditor.h>
 #include <lib/documentview/rasterimageview.h>
 #include "cropimageoperation.h"
 #include "cropwidget.h"
@@ -212,6 +213,28 @@ struct CropToolPrivate
         QObject::connect(view, &RasterImageView::imageRectUpdated, mCropWidget, &CropWidget::updateCropRatio);
     }
 
+    /**
+     * Move the top-left corner of rect up and left to the lossless crop grid
+     * of the document, keeping the bottom-right corner in place. Pixels before
+     * the origin of the grid cannot be kept, the corner moves to the origin
+     * instead.
+     */
+    QRect alignForLosslessCrop(const QRect& rect) const
+    {
+        AbstractDocumentEditor* editor = q->imageView()->document()->editor();
+        const QSize alignment = editor ? editor->losslessCropAlignment() : QSize();
+        if (!alignment.isValid()) {
+            return rect;
+        }
+        const QPoint origin = editor->losslessCropOrigin();
+        const int left = qMax(rect.left(), origin.x()) - origin.x();
+        const int top = qMax(rect.top(), origin.y()) - origin.y();
+        QRect aligned = rect;
+        aligned.setLeft(origin.x() + left - left % alignment.width());
+        aligned.setTop(origin.y() + top - top % alignment.height());
+        return aligned;
+    }
+
     QRect computeVisibleImageRect() const
     {
         RasterImageView* view = q->imageView();
@@ -456,6 +479,7 @@ void CropTool::toolActivated()
 {
     d->mCropWidget->setAdvancedSettingsEnabled(GwenviewConfig::cropAdvancedSettingsEnabled());
     d->mCropWidget->setPreserveAspectRatio(GwenviewConfig::cropPreserveAspectRatio());
+    d->mCropWidget->setLosslessCrop(GwenviewConfig::cropLossless());
     const int index = GwenviewConfig::cropRatioIndex();
     if (index >= 0) {
         // Preset ratio
@@ -471,6 +495,7 @@ void CropTool::toolDeactivated()
 {
     GwenviewConfig::setCropAdvancedSettingsEnabled(d->mCropWidget->advancedSettingsEnabled());
     GwenviewConfig::setCropPreserveAspectRatio(d->mCropWidget->preserveAspectRatio());
+    GwenviewConfig::setCropLossless(d->mCropWidget->losslessCrop());
     GwenviewConfig::setCropRatioIndex(d->mCropWidget->cropRatioIndex());
     const QSizeF ratio = d->mCropWidget->cropRatio();
     GwenviewConfig::setCropRatioWidth(ratio.width());
@@ -479,7 +504,11 @@ void CropTool::toolDeactivated()
 
 void CropTool::slotCropRequested()
 {
-    CropImageOperation* op = new CropImageOperation(d->mRect);
+    QRect rect = d->mRect;
+    if (d->mCropWidget->losslessCrop()) {
+        rect = d->alignForLosslessCrop(rect);
+    }
+    CropImageOperation* op = new CropImageOperation(rect);
     emit imageOperationRequested(op);
     emit done();
 }
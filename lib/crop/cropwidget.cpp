@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include <KLocalizedString>
 
 // Local
+#include <lib/document/abstractdocumenteditor.h>
 #include <lib/documentview/rasterimageview.h>
 #include <QFontDatabase>
 #include "croptool.h"
@@ -66,6 +67,7 @@ struct CropWidgetPrivate : public QWidget
     CropWidget* q;
     QList<QWidget*> mAdvancedWidgets;
     QWidget* mPreserveAspectRatioWidget;
+    QWidget* mLosslessCropWidget;
     QCheckBox* advancedCheckBox;
     QComboBox* ratioComboBox;
     QSpinBox* widthSpinBox;
@@ -73,6 +75,7 @@ struct CropWidgetPrivate : public QWidget
     QSpinBox* leftSpinBox;
     QSpinBox* topSpinBox;
     QCheckBox* preserveAspectRatioCheckBox;
+    QCheckBox* losslessCropCheckBox;
     QDialogButtonBox* dialogButtonBox;
 
     Document::Ptr mDocument;
@@ -368,7 +371,16 @@ struct CropWidgetPrivate : public QWidget
         flowLayout->addWidget(mPreserveAspectRatioWidget);
         flowLayout->addSpacing(18);
 
-        // (6) Dialog buttons
+        // (6) Lossless crop checkbox, only shown for documents supporting it
+        mLosslessCropWidget = boxWidget(cropWidget);
+        losslessCropCheckBox = new QCheckBox(i18nc("@option:check", "Lossless"), mLosslessCropWidget);
+        losslessCropCheckBox->setToolTip(i18nc("@info:tooltip",
+            "Move the top-left corner of the selection to the nearest JPEG block boundary, so that the image can be cropped without being recompressed."));
+        mLosslessCropWidget->layout()->addWidget(losslessCropCheckBox);
+        flowLayout->addWidget(mLosslessCropWidget);
+        flowLayout->addSpacing(18);
+
+        // (7) Dialog buttons
         box = boxWidget(cropWidget);
         dialogButtonBox = new QDialogButtonBox(QDialogButtonBox::Cancel | QDialogButtonBox::Reset | QDialogButtonBox::Ok, box);
         box->layout()->addWidget(dialogButtonBox);
@@ -395,6 +407,9 @@ CropWidget::CropWidget(QWidget* parent, RasterImageView* imageView, CropTool* cr
 
     connect(d->preserveAspectRatioCheckBox, &QCheckBox::toggled, this, &CropWidget::applyRatioConstraint);
 
+    AbstractDocumentEditor* editor = d->mDocument->editor();
+    d->mLosslessCropWidget->setVisible(editor && editor->losslessCropAlignment().isValid());
+
     d->initRatioComboBox();
 
     connect(d->mCropTool, &CropTool::rectUpdated, this, &CropWidget::setCropRect);
@@ -445,6 +460,16 @@ bool CropWidget::preserveAspectRatio() const
     return d->preserveAspectRatioCheckBox->isChecked();
 }
 
+void CropWidget::setLosslessCrop(bool lossless)
+{
+    d->losslessCropCheckBox->setChecked(lossless);
+}
+
+bool CropWidget::losslessCrop() const
+{
+    return d->losslessCropCheckBox->isChecked();
+}
+
 void CropWidget::setCropRatio(QSizeF size)
 {
     d->setChosenRatio(size);
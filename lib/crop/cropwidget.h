@@ -48,6 +48,8 @@ public:
     void setAdvancedSettingsEnabled(bool enable);
     bool advancedSettingsEnabled() const;
     void setPreserveAspectRatio(bool preserve);
+    void setLosslessCrop(bool lossless);
+    bool losslessCrop() const;
     bool preserveAspectRatio() const;
     void setCropRatio(QSizeF size);
     int cropRatioIndex() const;
@@ -0,0 +1,184 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Self
+#include "dirsnapshot.h"
+
+// STL
+#include <limits>
+
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include "gwenview_lib_debug.h"
+
+// KDE
+
+// Local
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+static const quint32 SNAPSHOT_MAGIC = 0x47564453; // "GVDS"
+static const quint32 SNAPSHOT_VERSION = 1;
+
+// Number of dirs for which a snapshot is kept
+static const int MAX_SNAPSHOT_COUNT = 32;
+
+static const qint64 INVALID_TIME = std::numeric_limits<qint64>::min();
+
+static qint64 timeToMSecs(const QDateTime& dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : INVALID_TIME;
+}
+
+static QDateTime timeFromMSecs(qint64 msecs)
+{
+    return msecs == INVALID_TIME ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(DirSnapshot, sInstance,
+    (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/dirsnapshots")))
+
+struct DirSnapshotPrivate
+{
+    QString mStoragePath;
+    // Serializes writes and the removal of old snapshots
+    QMutex mMutex;
+
+    QString pathForUrl(const QUrl& dirUrl) const
+    {
+        const QByteArray hash = QCryptographicHash::hash(dirUrl.toEncoded(), QCryptographicHash::Sha1);
+        return mStoragePath + QLatin1Char('/') + QString::fromLatin1(hash.toHex()) + QStringLiteral(".snapshot");
+    }
+
+    void removeOldSnapshots()
+    {
+        QDir dir(mStoragePath);
+        const QFileInfoList list = dir.entryInfoList(
+            QStringList() << QStringLiteral("*.snapshot"), QDir::Files, QDir::Time);
+        for (int idx = MAX_SNAPSHOT_COUNT; idx < list.count(); ++idx) {
+            LOG("Removing" << list.at(idx).filePath());
+            QFile::remove(list.at(idx).filePath());
+        }
+    }
+};
+
+DirSnapshot* DirSnapshot::instance()
+{
+    return sInstance;
+}
+
+DirSnapshot::DirSnapshot(const QString& storagePath)
+: d(new DirSnapshotPrivate)
+{
+    d->mStoragePath = storagePath;
+}
+
+DirSnapshot::~DirSnapshot()
+{
+    delete d;
+}
+
+DirSnapshot::Entries DirSnapshot::load(const QUrl& dirUrl) const
+{
+    Entries entries;
+    QFile file(d->pathForUrl(dirUrl));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return entries;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic, version;
+    QUrl url;
+    qint32 count;
+    stream >> magic >> version >> url >> count;
+    if (stream.status() != QDataStream::Ok || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION
+        || url != dirUrl || count < 0) {
+        qCWarning(GWENVIEW_LIB_LOG) << "Ignoring invalid dir snapshot" << file.fileName();
+        return entries;
+    }
+
+    entries.reserve(count);
+    for (int idx = 0; idx < count; ++idx) {
+        QString name;
+        qint64 mtime, size, captureDate;
+        quint32 kind;
+        stream >> name >> mtime >> size >> kind >> captureDate;
+        if (stream.status() != QDataStream::Ok) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Truncated dir snapshot" << file.fileName();
+            return Entries();
+        }
+        Entry entry;
+        entry.mtime = timeFromMSecs(mtime);
+        entry.size = size;
+        entry.kind = MimeTypeUtils::Kind(kind);
+        entry.hasCaptureDate = captureDate != INVALID_TIME;
+        entry.captureDate = timeFromMSecs(captureDate);
+        entries.insert(name, entry);
+    }
+    LOG("Loaded" << entries.count() << "entries for" << dirUrl);
+    return entries;
+}
+
+void DirSnapshot::save(const QUrl& dirUrl, const Entries& entries)
+{
+    QMutexLocker locker(&d->mMutex);
+    QDir().mkpath(d->mStoragePath);
+    QSaveFile file(d->pathForUrl(dirUrl));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(GWENVIEW_LIB_LOG) << "Could not write dir snapshot" << file.fileName() << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << dirUrl << qint32(entries.count());
+    for (auto it = entries.constBegin(), end = entries.constEnd(); it != end; ++it) {
+        const Entry& entry = it.value();
+        stream << it.key()
+            << timeToMSecs(entry.mtime)
+            << entry.size
+            << quint32(entry.kind)
+            << (entry.hasCaptureDate ? timeToMSecs(entry.captureDate) : INVALID_TIME);
+    }
+    if (!file.commit()) {
+        qCWarning(GWENVIEW_LIB_LOG) << "Could not write dir snapshot" << file.fileName() << file.errorString();
+        return;
+    }
+    LOG("Saved" << entries.count() << "entries for" << dirUrl);
+    d->removeOldSnapshots();
+}
+
+} // namespace
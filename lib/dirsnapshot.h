@@ -0,0 +1,92 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef DIRSNAPSHOT_H
+#define DIRSNAPSHOT_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QDateTime>
+#include <QHash>
+
+// KDE
+
+// Local
+#include <lib/mimetypeutils.h>
+
+class QString;
+class QUrl;
+
+namespace Gwenview
+{
+
+struct DirSnapshotPrivate;
+
+/**
+ * Stores on disk what SortedDirModel learned about the items of recently
+ * visited dirs, so that it does not have to work it out again the next time
+ * they are listed: item kinds and capture dates.
+ *
+ * There is one file per dir. Only the most recently saved snapshots are kept.
+ *
+ * All methods are thread-safe.
+ */
+class GWENVIEWLIB_EXPORT DirSnapshot
+{
+public:
+    struct Entry
+    {
+        Entry()
+        : size(0)
+        , kind(MimeTypeUtils::KIND_UNKNOWN)
+        , hasCaptureDate(false)
+        {}
+
+        /// Modification time and size of the file, the entry is outdated if
+        /// they changed
+        QDateTime mtime;
+        qint64 size;
+        MimeTypeUtils::Kind kind;
+        bool hasCaptureDate;
+        QDateTime captureDate;
+    };
+    /// Entries of a dir, by file name
+    typedef QHash<QString, Entry> Entries;
+
+    /**
+     * The snapshots shared by the application, stored in the cache directory
+     */
+    static DirSnapshot* instance();
+
+    explicit DirSnapshot(const QString& storagePath);
+    ~DirSnapshot();
+
+    Entries load(const QUrl& dirUrl) const;
+
+    void save(const QUrl& dirUrl, const Entries& entries);
+
+private:
+    DirSnapshotPrivate* const d;
+};
+
+} // namespace
+
+#endif /* DIRSNAPSHOT_H */
@@ -31,10 +31,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <lib/orientation.h>
 
 class QImage;
+class QPoint;
+class QRect;
+class QSize;
 
 namespace Gwenview
 {
 
+class ImageEdit;
+
 /**
  * An interface which can be returned by some implementations of
  * AbstractDocumentImpl if they support edition.
@@ -64,6 +69,46 @@ public:
      * AbstractImageOperation and applied through Document::undoStack().
      */
     virtual void applyTransformation(Orientation) = 0;
+
+    /**
+     * Crop the document image to rect.
+     *
+     * Like transformations, crops are handled by the Document class because
+     * some Document implementations can crop without re-encoding the image,
+     * provided rect is aligned on losslessCropAlignment().
+     *
+     * This method should only be called from a subclass of
+     * AbstractImageOperation and applied through Document::undoStack().
+     */
+    virtual void applyCrop(const QRect& rect) = 0;
+
+    /**
+     * Returns the grid the top-left corner of a crop rect must be aligned on
+     * for applyCrop() to be lossless, or an invalid size if the document
+     * cannot be cropped losslessly.
+     */
+    virtual QSize losslessCropAlignment() const = 0;
+
+    /**
+     * Returns the origin of the losslessCropAlignment() grid. Pixels above or
+     * left of it cannot be kept by a lossless crop.
+     */
+    virtual QPoint losslessCropOrigin() const = 0;
+
+    /**
+     * Records edit on the document image. Pixels are only edited when they
+     * are needed, see Document::edits().
+     *
+     * This method should only be called from a subclass of
+     * AbstractImageOperation and applied through Document::undoStack().
+     */
+    virtual void applyEdit(const ImageEdit& edit) = 0;
+
+    /**
+     * Removes the last edit recorded by applyEdit() or applyCrop(). Used to
+     * undo them.
+     */
+    virtual void revertLastEdit() = 0;
 };
 
 } // namespace
@@ -68,6 +68,16 @@ void AbstractDocumentImpl::setDocumentImageSize(const QSize& size)
     d->mDocument->setSize(size);
 }
 
+void AbstractDocumentImpl::editDocumentImage(const ImageEdit& edit)
+{
+    d->mDocument->editImageInternal(edit);
+}
+
+void AbstractDocumentImpl::revertLastDocumentEdit()
+{
+    d->mDocument->revertLastEditInternal();
+}
+
 void AbstractDocumentImpl::setDocumentFormat(const QByteArray& format)
 {
     d->mDocument->setFormat(format);
@@ -83,6 +93,11 @@ void AbstractDocumentImpl::setDocumentExiv2Image(std::unique_ptr<Exiv2::Image> i
     d->mDocument->setExiv2Image(std::move(image));
 }
 
+void AbstractDocumentImpl::setDocumentAnimationInfo(int frameCount, int duration)
+{
+    d->mDocument->setAnimationInfo(frameCount, duration);
+}
+
 void AbstractDocumentImpl::setDocumentDownSampledImage(const QImage& image, int invertedZoom)
 {
     d->mDocument->setDownSampledImage(image, invertedZoom);
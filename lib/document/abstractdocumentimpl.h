@@ -45,6 +45,7 @@ namespace Gwenview
 class Document;
 class DocumentJob;
 class AbstractDocumentEditor;
+class ImageEdit;
 
 struct AbstractDocumentImplPrivate;
 class AbstractDocumentImpl : public QObject
@@ -93,6 +94,13 @@ public:
     virtual void stopAnimation()
     {}
 
+    /**
+     * Animated documents can decode their frames down sampled by
+     * @p invertedZoom. 1 means full size.
+     */
+    virtual void setAnimationInvertedZoom(int /*invertedZoom*/)
+    {}
+
     Document* document() const;
 
     virtual QSvgRenderer* svgRenderer() const
@@ -111,9 +119,12 @@ Q_SIGNALS:
 protected:
     void setDocumentImage(const QImage& image);
     void setDocumentImageSize(const QSize& size);
+    void editDocumentImage(const ImageEdit& edit);
+    void revertLastDocumentEdit();
     void setDocumentKind(MimeTypeUtils::Kind);
     void setDocumentFormat(const QByteArray& format);
     void setDocumentExiv2Image(std::unique_ptr<Exiv2::Image>);
+    void setDocumentAnimationInfo(int frameCount, int duration);
     void setDocumentDownSampledImage(const QImage&, int invertedZoom);
     void setDocumentCmsProfile(const Cms::Profile::Ptr &profile);
     void setDocumentErrorString(const QString&);
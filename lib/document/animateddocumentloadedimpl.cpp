@@ -22,36 +22,65 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include "animateddocumentloadedimpl.h"
 
 // Qt
-#include <QBuffer>
 #include <QImage>
-#include <QMovie>
+#include <QTimer>
 #include "gwenview_lib_debug.h"
 
 // KDE
 
 // Local
+#include "animatedframedecoder.h"
+#include "gwenviewconfig.h"
 
 namespace Gwenview
 {
 
 struct AnimatedDocumentLoadedImplPrivate
 {
+    AnimatedDocumentLoadedImpl* q;
     QByteArray mRawData;
-    QBuffer mMovieBuffer;
-    QMovie mMovie;
+    AnimatedFrameDecoder* mDecoder;
+    QTimer* mFrameTimer;
+    bool mRunning;
+    // True if it is time to show the next frame but the decoder has not
+    // produced it yet
+    bool mWaitingForFrame;
+    int mInvertedZoom;
+
+    void showFrame(const QImage& image)
+    {
+        const QSize documentSize = q->document()->size();
+        if (image.size() == documentSize) {
+            q->setDocumentImage(image);
+            emit q->imageRectUpdated(image.rect());
+            return;
+        }
+        if (mInvertedZoom == 1 || image.size() != documentSize / mInvertedZoom) {
+            // Left over from before the inverted zoom changed
+            return;
+        }
+        q->setDocumentDownSampledImage(image, mInvertedZoom);
+        emit q->imageRectUpdated(QRect(QPoint(0, 0), documentSize));
+    }
 };
 
 AnimatedDocumentLoadedImpl::AnimatedDocumentLoadedImpl(Document* document, const QByteArray& rawData)
 : AbstractDocumentImpl(document)
 , d(new AnimatedDocumentLoadedImplPrivate)
 {
+    d->q = this;
     d->mRawData = rawData;
+    d->mRunning = false;
+    d->mWaitingForFrame = false;
+    d->mInvertedZoom = 1;
 
-    connect(&d->mMovie, &QMovie::frameChanged, this, &AnimatedDocumentLoadedImpl::slotFrameChanged);
+    d->mDecoder = new AnimatedFrameDecoder(rawData, document->format(), this);
+    d->mDecoder->setMemoryBudget(GwenviewConfig::animationFrameBufferSize() * 1024 * 1024);
+    connect(d->mDecoder, &AnimatedFrameDecoder::frameAvailable, this, &AnimatedDocumentLoadedImpl::slotFrameAvailable);
 
-    d->mMovieBuffer.setBuffer(&d->mRawData);
-    d->mMovieBuffer.open(QIODevice::ReadOnly);
-    d->mMovie.setDevice(&d->mMovieBuffer);
+    d->mFrameTimer = new QTimer(this);
+    d->mFrameTimer->setSingleShot(true);
+    connect(d->mFrameTimer, &QTimer::timeout, this, &AnimatedDocumentLoadedImpl::showNextFrame);
 }
 
 AnimatedDocumentLoadedImpl::~AnimatedDocumentLoadedImpl()
@@ -81,11 +110,25 @@ QByteArray AnimatedDocumentLoadedImpl::rawData() const
     return d->mRawData;
 }
 
-void AnimatedDocumentLoadedImpl::slotFrameChanged(int /*frameNumber*/)
+void AnimatedDocumentLoadedImpl::showNextFrame()
+{
+    QImage image;
+    int delay;
+    if (!d->mDecoder->takeFrame(&image, &delay)) {
+        // Decoder is late, show the frame as soon as it is ready
+        d->mWaitingForFrame = !d->mDecoder->atEnd();
+        return;
+    }
+    d->showFrame(image);
+    d->mFrameTimer->start(delay);
+}
+
+void AnimatedDocumentLoadedImpl::slotFrameAvailable()
 {
-    QImage image = d->mMovie.currentImage();
-    setDocumentImage(image);
-    emit imageRectUpdated(image.rect());
+    if (d->mRunning && d->mWaitingForFrame) {
+        d->mWaitingForFrame = false;
+        showNextFrame();
+    }
 }
 
 bool AnimatedDocumentLoadedImpl::isAnimated() const
@@ -95,18 +138,36 @@ bool AnimatedDocumentLoadedImpl::isAnimated() const
 
 void AnimatedDocumentLoadedImpl::startAnimation()
 {
-    d->mMovie.start();
-    if (d->mMovie.state() == QMovie::NotRunning) {
-        // This is true with qt-copy as of 2008.08.23
-        //qCDebug(GWENVIEW_LIB_LOG) << "QMovie didn't start. This can happen in some cases when starting for the second time.";
-        //qCDebug(GWENVIEW_LIB_LOG) << "Trying to start again, it usually fixes the bug.";
-        d->mMovie.start();
+    if (d->mRunning) {
+        return;
     }
+    d->mRunning = true;
+    d->mDecoder->start();
+    showNextFrame();
 }
 
 void AnimatedDocumentLoadedImpl::stopAnimation()
 {
-    d->mMovie.stop();
+    d->mRunning = false;
+    d->mWaitingForFrame = false;
+    d->mFrameTimer->stop();
+    d->mDecoder->stop();
+}
+
+void AnimatedDocumentLoadedImpl::setAnimationInvertedZoom(int invertedZoom)
+{
+    if (!GwenviewConfig::decodeAnimationsAtDisplaySize()) {
+        invertedZoom = 1;
+    }
+    const QSize scaledSize = document()->size() / invertedZoom;
+    if (scaledSize.isEmpty()) {
+        invertedZoom = 1;
+    }
+    if (invertedZoom == d->mInvertedZoom) {
+        return;
+    }
+    d->mInvertedZoom = invertedZoom;
+    d->mDecoder->setScaledSize(invertedZoom == 1 ? QSize() : scaledSize);
 }
 
 } // namespace
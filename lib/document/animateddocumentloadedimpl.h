@@ -45,11 +45,14 @@ public:
     bool isAnimated() const override;
     void startAnimation() override;
     void stopAnimation() override;
+    void setAnimationInvertedZoom(int invertedZoom) override;
 
 private Q_SLOTS:
-    void slotFrameChanged(int frameNumber);
+    void showNextFrame();
+    void slotFrameAvailable();
 
 private:
+    friend struct AnimatedDocumentLoadedImplPrivate;
     AnimatedDocumentLoadedImplPrivate* const d;
 };
 
@@ -0,0 +1,281 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+// Self
+#include "animatedframedecoder.h"
+
+// STL
+#include <memory>
+
+// Qt
+#include <QBuffer>
+#include <QFuture>
+#include <QImage>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QtConcurrent>
+#include "gwenview_lib_debug.h"
+
+// Local
+#include "imageutils.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+// Like web browsers, use a sensible delay for frames which ask to be shown
+// for (almost) no time
+static const int MIN_FRAME_DELAY = 20;
+static const int DEFAULT_FRAME_DELAY = 100;
+
+// Always keep at least this number of frames ahead, even if it means going
+// over the memory budget
+static const int MIN_QUEUED_FRAMES = 2;
+
+struct AnimatedFrame
+{
+    QImage mImage;
+    int mDelay;
+};
+
+struct AnimatedFrameDecoderPrivate
+{
+    AnimatedFrameDecoder* q;
+    QByteArray mData;
+    QByteArray mFormat;
+    QFuture<void> mFuture;
+
+    // Only accessed by the decoding task
+    std::unique_ptr<QBuffer> mBuffer;
+    std::unique_ptr<QImageReader> mReader;
+    int mFrameNumber;
+    int mLoopsLeft;
+
+    // Shared between the GUI thread and the decoding task
+    mutable QMutex mMutex;
+    QQueue<AnimatedFrame> mFrames;
+    int mQueuedBytes;
+    int mMemoryBudget;
+    QSize mScaledSize;
+    bool mStopRequested;
+    bool mAtEnd;
+    // True while the decoding task is running. Not using mFuture.isRunning()
+    // because the task may be about to return after we made room in the queue
+    bool mDecoding;
+
+    bool isQueueFull() const
+    {
+        return mFrames.count() >= MIN_QUEUED_FRAMES && mQueuedBytes >= mMemoryBudget;
+    }
+
+    void startDecodingTask()
+    {
+        QMutexLocker locker(&mMutex);
+        if (mDecoding || mAtEnd || mStopRequested || isQueueFull()) {
+            return;
+        }
+        mDecoding = true;
+        mFuture = QtConcurrent::run(this, &AnimatedFrameDecoderPrivate::decodeAhead);
+    }
+
+    bool rewind()
+    {
+        mBuffer.reset(new QBuffer(&mData));
+        mBuffer->open(QIODevice::ReadOnly);
+        mReader.reset(new QImageReader(mBuffer.get(), mFormat));
+        mFrameNumber = 0;
+        return mReader->canRead();
+    }
+
+    /**
+     * Runs in a worker thread, decodes frames until the queue is full or
+     * decoding is stopped
+     */
+    void decodeAhead()
+    {
+        while (true) {
+            QSize scaledSize;
+            {
+                QMutexLocker locker(&mMutex);
+                if (mStopRequested || mAtEnd || isQueueFull()) {
+                    mDecoding = false;
+                    return;
+                }
+                scaledSize = mScaledSize;
+            }
+
+            if (!mReader && !rewind()) {
+                qCWarning(GWENVIEW_LIB_LOG) << "Cannot decode animation:" << mReader->errorString();
+                setAtEnd();
+                return;
+            }
+
+            QImage image;
+            if (!mReader->read(&image)) {
+                if (mFrameNumber == 0) {
+                    qCWarning(GWENVIEW_LIB_LOG) << "Cannot decode animation frame:" << mReader->errorString();
+                    setAtEnd();
+                    return;
+                }
+                // End of the current loop
+                if (mLoopsLeft == 0 || !rewind()) {
+                    setAtEnd();
+                    return;
+                }
+                if (mLoopsLeft > 0) {
+                    --mLoopsLeft;
+                }
+                continue;
+            }
+            if (mFrameNumber == 0 && mLoopsLeft == -2) {
+                // First time we read the image: we now know how many times
+                // it wants to loop. -1 means forever.
+                mLoopsLeft = mReader->loopCount();
+            }
+            ++mFrameNumber;
+
+            AnimatedFrame frame;
+            frame.mDelay = mReader->nextImageDelay();
+            if (frame.mDelay <= 0) {
+                frame.mDelay = DEFAULT_FRAME_DELAY;
+            } else if (frame.mDelay < MIN_FRAME_DELAY) {
+                frame.mDelay = MIN_FRAME_DELAY;
+            }
+            if (scaledSize.isValid() && image.size() != scaledSize) {
+                image = image.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            }
+            frame.mImage = ImageUtils::convertToStorageFormat(image);
+
+            {
+                QMutexLocker locker(&mMutex);
+                if (scaledSize != mScaledSize) {
+                    // Scaled size changed while we were decoding, drop the
+                    // frame rather than queuing a frame of the wrong size
+                    continue;
+                }
+                mFrames.enqueue(frame);
+                mQueuedBytes += frame.mImage.byteCount();
+            }
+            QMetaObject::invokeMethod(q, "frameAvailable", Qt::QueuedConnection);
+        }
+    }
+
+    void setAtEnd()
+    {
+        QMutexLocker locker(&mMutex);
+        mAtEnd = true;
+        mDecoding = false;
+    }
+};
+
+AnimatedFrameDecoder::AnimatedFrameDecoder(const QByteArray& data, const QByteArray& format, QObject* parent)
+: QObject(parent)
+, d(new AnimatedFrameDecoderPrivate)
+{
+    d->q = this;
+    d->mData = data;
+    d->mFormat = format;
+    d->mFrameNumber = 0;
+    // -2: loop count not known yet
+    d->mLoopsLeft = -2;
+    d->mQueuedBytes = 0;
+    d->mMemoryBudget = 64 * 1024 * 1024;
+    d->mStopRequested = true;
+    d->mAtEnd = false;
+    d->mDecoding = false;
+}
+
+AnimatedFrameDecoder::~AnimatedFrameDecoder()
+{
+    {
+        QMutexLocker locker(&d->mMutex);
+        d->mStopRequested = true;
+    }
+    d->mFuture.waitForFinished();
+    delete d;
+}
+
+void AnimatedFrameDecoder::setMemoryBudget(int bytes)
+{
+    QMutexLocker locker(&d->mMutex);
+    d->mMemoryBudget = bytes;
+}
+
+void AnimatedFrameDecoder::setScaledSize(const QSize& size)
+{
+    QMutexLocker locker(&d->mMutex);
+    if (size == d->mScaledSize) {
+        return;
+    }
+    LOG("Scaled size changed to" << size);
+    d->mScaledSize = size;
+    d->mFrames.clear();
+    d->mQueuedBytes = 0;
+}
+
+void AnimatedFrameDecoder::start()
+{
+    {
+        QMutexLocker locker(&d->mMutex);
+        d->mStopRequested = false;
+    }
+    d->startDecodingTask();
+}
+
+void AnimatedFrameDecoder::stop()
+{
+    QMutexLocker locker(&d->mMutex);
+    d->mStopRequested = true;
+}
+
+bool AnimatedFrameDecoder::takeFrame(QImage* image, int* delay)
+{
+    {
+        QMutexLocker locker(&d->mMutex);
+        if (d->mFrames.isEmpty()) {
+            return false;
+        }
+        const AnimatedFrame frame = d->mFrames.dequeue();
+        d->mQueuedBytes -= frame.mImage.byteCount();
+        *image = frame.mImage;
+        *delay = frame.mDelay;
+    }
+    // We made room in the queue, decode more frames
+    d->startDecodingTask();
+    return true;
+}
+
+bool AnimatedFrameDecoder::atEnd() const
+{
+    QMutexLocker locker(&d->mMutex);
+    return d->mAtEnd && d->mFrames.isEmpty();
+}
+
+} // namespace
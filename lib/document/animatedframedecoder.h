@@ -0,0 +1,93 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+#ifndef ANIMATEDFRAMEDECODER_H
+#define ANIMATEDFRAMEDECODER_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QObject>
+
+class QByteArray;
+class QImage;
+class QSize;
+
+namespace Gwenview
+{
+
+struct AnimatedFrameDecoderPrivate;
+/**
+ * Decodes the frames of an animated image ahead of time, in a worker thread.
+ *
+ * Decoded frames are kept in a queue until they are taken with takeFrame().
+ * Decoding pauses when the queued frames use more than the memory budget.
+ * The animation loops as many times as the image requests.
+ */
+class GWENVIEWLIB_EXPORT AnimatedFrameDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    AnimatedFrameDecoder(const QByteArray& data, const QByteArray& format, QObject* parent = nullptr);
+    ~AnimatedFrameDecoder() override;
+
+    /**
+     * Maximum amount of memory used by queued frames, in bytes
+     */
+    void setMemoryBudget(int bytes);
+
+    /**
+     * If @p size is valid, frames are scaled down to @p size before being
+     * queued. Already queued frames are dropped.
+     */
+    void setScaledSize(const QSize& size);
+
+    /**
+     * Starts decoding frames ahead
+     */
+    void start();
+
+    /**
+     * Stops decoding frames ahead. Already queued frames are kept.
+     */
+    void stop();
+
+    /**
+     * Takes the next frame from the queue and the time it must be shown, in
+     * milliseconds. Returns false if no frame has been decoded yet, in this
+     * case frameAvailable() will be emitted when one is ready.
+     */
+    bool takeFrame(QImage* image, int* delay);
+
+    /**
+     * Returns true once the last frame of the last loop has been decoded
+     */
+    bool atEnd() const;
+
+Q_SIGNALS:
+    void frameAvailable();
+
+private:
+    AnimatedFrameDecoderPrivate* const d;
+};
+
+} // namespace
+
+#endif /* ANIMATEDFRAMEDECODER_H */
@@ -134,6 +134,15 @@ void DocumentPrivate::downSampleImage(int invertedZoom)
     emit q->downSampledImageReady();
 }
 
+void DocumentPrivate::applyEdits()
+{
+    if (mEdits.isEmpty() || !mEditedImage.isNull()) {
+        return;
+    }
+    LOG("Applying pending edits to" << mImage.size());
+    mEditedImage = mEdits.apply(mImage);
+}
+
 //- DownSamplingJob ---------------------------------------
 void DownSamplingJob::doStart()
 {
@@ -173,8 +182,11 @@ void Document::reload()
 {
     d->mSize = QSize();
     d->mImage = QImage();
+    d->mEdits = EditChain();
+    d->mEditedImage = QImage();
     d->mDownSampledImageMap.clear();
     d->mExiv2Image.reset();
+    d->mImageMetaInfoModel.setExiv2Image(nullptr);
     d->mKind = MimeTypeUtils::KIND_UNKNOWN;
     d->mFormat = QByteArray();
     d->mImageMetaInfoModel.setUrl(d->mUrl);
@@ -186,10 +198,37 @@ void Document::reload()
 }
 
 const QImage& Document::image() const
+{
+    if (d->mEdits.isEmpty()) {
+        return d->mImage;
+    }
+    d->applyEdits();
+    return d->mEditedImage;
+}
+
+const QImage& Document::sourceImage() const
 {
     return d->mImage;
 }
 
+const EditChain& Document::edits() const
+{
+    return d->mEdits;
+}
+
+QImage Document::imageRect(const QRect& rect) const
+{
+    if (d->mEdits.isEmpty()) {
+        return d->mImage.copy(rect);
+    }
+    if (!d->mEditedImage.isNull()) {
+        return d->mEditedImage.copy(rect);
+    }
+    QRect editedRect = d->mEdits.sourceRect(rect, d->mImage.size());
+    const QImage part = d->mEdits.apply(d->mImage.copy(editedRect), &editedRect, d->mImage.size());
+    return part.copy(rect.translated(-editedRect.topLeft()));
+}
+
 /**
  * invertedZoom is the biggest power of 2 for which zoom < 1/invertedZoom.
  * Example:
@@ -203,6 +242,25 @@ inline int invertedZoomForZoom(qreal zoom)
     return invertedZoom;
 }
 
+QImage Document::scaledImage(int pixelSize) const
+{
+    const QSize fullSize = size();
+    if (fullSize.isEmpty() || d->mImage.isNull()) {
+        return QImage();
+    }
+    const qreal zoom = qMin(qreal(1), qMin(qreal(pixelSize) / fullSize.width(), qreal(pixelSize) / fullSize.height()));
+    if (!d->mEditedImage.isNull()) {
+        return d->mEditedImage.scaled(fullSize * zoom, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    const QImage& downSampled = downSampledImageForZoom(zoom);
+    const QImage& source = downSampled.isNull() ? d->mImage : downSampled;
+    // Edits keep proportions between the source and the edited image, so
+    // scaling the source by zoom gives an edited image scaled by zoom
+    QImage image = source.scaled(d->mImage.size() * zoom, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    return d->mEdits.isEmpty() ? image : d->mEdits.apply(image);
+}
+
 const QImage& Document::downSampledImageForZoom(qreal zoom) const
 {
     static const QImage sNullImage;
@@ -257,6 +315,8 @@ void Document::switchToImpl(AbstractDocumentImpl* impl)
 void Document::setImageInternal(const QImage& image)
 {
     d->mImage = image;
+    d->mEdits = EditChain();
+    d->mEditedImage = QImage();
     d->mDownSampledImageMap.clear();
 
     // If we didn't get the image size before decoding the full image, set it
@@ -264,6 +324,22 @@ void Document::setImageInternal(const QImage& image)
     setSize(d->mImage.size());
 }
 
+void Document::editImageInternal(const ImageEdit& edit)
+{
+    // Only record the edit, pixels are edited when someone needs them, see
+    // image()
+    d->mEdits.append(edit, d->mSize);
+    d->mEditedImage = QImage();
+    setSize(d->mEdits.isEmpty() ? d->mImage.size() : d->mEdits.size());
+}
+
+void Document::revertLastEditInternal()
+{
+    d->mEdits.removeLast();
+    d->mEditedImage = QImage();
+    setSize(d->mEdits.isEmpty() ? d->mImage.size() : d->mEdits.size());
+}
+
 QUrl Document::url() const
 {
     return d->mUrl;
@@ -364,7 +440,10 @@ bool Document::hasAlphaChannel() const
 int Document::memoryUsage() const
 {
     // FIXME: Take undo stack into account
-    int usage = d->mImage.byteCount();
+    int usage = d->mImage.byteCount() + d->mEditedImage.byteCount();
+    for (const QImage& image : qAsConst(d->mDownSampledImageMap)) {
+        usage += image.byteCount();
+    }
     usage += rawData().length();
     return usage;
 }
@@ -396,9 +475,16 @@ void Document::setExiv2Image(std::unique_ptr<Exiv2::Image> image)
     emit metaInfoUpdated();
 }
 
+void Document::setAnimationInfo(int frameCount, int duration)
+{
+    d->mImageMetaInfoModel.setAnimationInfo(frameCount, duration);
+    emit metaInfoUpdated();
+}
+
 void Document::setDownSampledImage(const QImage& image, int invertedZoom)
 {
-    Q_ASSERT(!d->mDownSampledImageMap.contains(invertedZoom));
+    // Animated documents replace down sampled images for each frame
+    Q_ASSERT(isAnimated() || !d->mDownSampledImageMap.contains(invertedZoom));
     d->mDownSampledImageMap[invertedZoom] = image;
     emit downSampledImageReady();
 }
@@ -515,6 +601,12 @@ void Document::stopAnimation()
     return d->mImpl->stopAnimation();
 }
 
+void Document::setAnimationDisplayZoom(qreal zoom)
+{
+    const int invertedZoom = zoom < maxDownSampledZoom() ? invertedZoomForZoom(zoom) : 1;
+    d->mImpl->setAnimationInvertedZoom(invertedZoom);
+}
+
 void Document::enqueueJob(DocumentJob* job)
 {
     LOG("job=" << job);
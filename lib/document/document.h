@@ -56,6 +56,8 @@ class AbstractDocumentImpl;
 class DocumentJob;
 class DocumentFactory;
 struct DocumentPrivate;
+class EditChain;
+class ImageEdit;
 class ImageMetaInfoModel;
 
 /**
@@ -120,8 +122,42 @@ public:
 
     bool isModified() const;
 
+    /**
+     * Returns the full image. If edits are pending (see edits()), they are
+     * applied to the pixels first. The result is kept until the next edit,
+     * so this must only be called from the GUI thread.
+     */
     const QImage& image() const;
 
+    /**
+     * Returns the full image, without edits() applied. Use it together with
+     * edits() to show the image without editing all of its pixels.
+     */
+    const QImage& sourceImage() const;
+
+    /**
+     * Edits which have been applied to the document but not yet to the
+     * pixels of sourceImage() and of the down sampled images. size() already
+     * takes them into account.
+     */
+    const EditChain& edits() const;
+
+    /**
+     * Returns @p rect of image(). Only the pixels needed for @p rect are
+     * edited, the full image is not.
+     */
+    QImage imageRect(const QRect& rect) const;
+
+    /**
+     * Returns image() scaled down to fit in a @p pixelSize square. Unless
+     * image() has already been computed, the closest down sampled image is
+     * scaled and edited instead of the full image.
+     */
+    QImage scaledImage(int pixelSize) const;
+
+    /**
+     * Note: returned image does not have edits() applied.
+     */
     const QImage& downSampledImageForZoom(qreal zoom) const;
 
     /**
@@ -200,6 +236,13 @@ public:
      */
     void stopAnimation();
 
+    /**
+     * Tells an animated document the zoom it is displayed at. If zoom is
+     * below maxDownSampledZoom(), frames may be decoded down sampled and made
+     * available through downSampledImageForZoom().
+     */
+    void setAnimationDisplayZoom(qreal zoom);
+
     void enqueueJob(DocumentJob*);
 
     void imageOperationCompleted();
@@ -237,10 +280,13 @@ private:
     friend class DownSamplingJob;
 
     void setImageInternal(const QImage&);
+    void editImageInternal(const ImageEdit&);
+    void revertLastEditInternal();
     void setKind(MimeTypeUtils::Kind);
     void setFormat(const QByteArray&);
     void setSize(const QSize&);
     void setExiv2Image(std::unique_ptr<Exiv2::Image>);
+    void setAnimationInfo(int frameCount, int duration);
     void setDownSampledImage(const QImage&, int invertedZoom);
     void switchToImpl(AbstractDocumentImpl* impl);
     void setErrorString(const QString&);
@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 // Local
 #include <imagemetainfomodel.h>
 #include <document/documentjob.h>
+#include <document/editchain.h>
 
 // KDE
 #include <QUrl>
@@ -61,6 +62,9 @@ struct DocumentPrivate
      */
     QSize mSize;
     QImage mImage;
+    // Pending edits, see Document::edits(), and their result once computed
+    EditChain mEdits;
+    QImage mEditedImage;
     QMap<int, QImage> mDownSampledImageMap;
     std::unique_ptr<Exiv2::Image> mExiv2Image;
     MimeTypeUtils::Kind mKind;
@@ -74,6 +78,7 @@ struct DocumentPrivate
     void scheduleImageLoading(int invertedZoom);
     void scheduleImageDownSampling(int invertedZoom);
     void downSampleImage(int invertedZoom);
+    void applyEdits();
 };
 
 
@@ -295,4 +295,18 @@ void DocumentFactory::forget(const QUrl &url)
     }
 }
 
+void DocumentFactory::release(const QUrl &url)
+{
+    DocumentMap::Iterator it = d->mDocumentMap.find(url);
+    if (it == d->mDocumentMap.end()) {
+        return;
+    }
+    const Document::Ptr& doc = it.value()->mDocument;
+    if (doc->ref == 1 && !doc->isModified()) {
+        LOG("Releasing" << url);
+        delete it.value();
+        d->mDocumentMap.erase(it);
+    }
+}
+
 } // namespace
@@ -75,6 +75,13 @@ public:
      */
     void forget(const QUrl &url);
 
+    /**
+     * Removes the document whose url is @url from the cache if it is not
+     * modified and not used elsewhere, to free its memory right away instead
+     * of when the cache is full
+     */
+    void release(const QUrl &url);
+
 Q_SIGNALS:
     void modifiedDocumentListChanged();
     void documentChanged(const QUrl&);
@@ -25,7 +25,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include <QByteArray>
 #include <QImage>
 #include <QImageWriter>
-#include <QTransform>
+#include <QIODevice>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
 #include "gwenview_lib_debug.h"
 #include <QUrl>
 
@@ -33,8 +37,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
 // Local
 #include "documentjob.h"
+#include "editchain.h"
 #include "gwenviewconfig.h"
 #include "imageutils.h"
+#include "paralleljpegencoder.h"
 #include "savejob.h"
 
 namespace Gwenview
@@ -44,6 +50,11 @@ struct DocumentLoadedImplPrivate
 {
     QByteArray mRawData;
     bool mQuietInit;
+
+    // Edits recorded from ThreadedDocumentJob worker threads, waiting to be
+    // applied to the document from the GUI thread
+    QMutex mQueuedEditsMutex;
+    QVector<ImageEdit> mQueuedEdits;
 };
 
 DocumentLoadedImpl::DocumentLoadedImpl(Document* document, const QByteArray& rawData, bool quietInit)
@@ -79,14 +90,26 @@ Document::LoadingState DocumentLoadedImpl::loadingState() const
     return Document::Loaded;
 }
 
-bool DocumentLoadedImpl::saveInternal(QIODevice* device, const QByteArray& format)
+bool DocumentLoadedImpl::saveInternal(QIODevice* device, const QByteArray& format, const DocumentSaveData& saveData)
 {
-    QImageWriter writer(device, format);
+    const QImage image = saveData.image();
     // If we're saving a non-JPEG image as a JPEG, respect the quality setting
+    if (format == QByteArrayLiteral("jpeg")) {
+        const QByteArray data = ParallelJpegEncoder::encode(image, GwenviewConfig::jPEGQuality());
+        if (!data.isEmpty()) {
+            if (device->write(data) != data.size()) {
+                setDocumentErrorString(device->errorString());
+                return false;
+            }
+            setDocumentFormat(format);
+            return true;
+        }
+    }
+    QImageWriter writer(device, format);
     if (format == QByteArrayLiteral("jpeg")) {
         writer.setQuality(GwenviewConfig::jPEGQuality());
     }
-    bool ok = writer.write(document()->image());
+    bool ok = writer.write(image);
     if (ok) {
         setDocumentFormat(format);
     } else {
@@ -107,17 +130,73 @@ AbstractDocumentEditor* DocumentLoadedImpl::editor()
 
 void DocumentLoadedImpl::setImage(const QImage& image)
 {
-    setDocumentImage(image);
-    emit imageRectUpdated(image.rect());
+    const QImage storedImage = ImageUtils::convertToStorageFormat(image);
+    setDocumentImage(storedImage);
+    emit imageRectUpdated(storedImage.rect());
 }
 
 void DocumentLoadedImpl::applyTransformation(Orientation orientation)
 {
-    QImage image = document()->image();
-    QTransform matrix = ImageUtils::transformMatrix(orientation);
-    image = image.transformed(matrix);
-    setDocumentImage(image);
-    emit imageRectUpdated(image.rect());
+    recordEdit(ImageEdit::transformation(orientation));
+}
+
+void DocumentLoadedImpl::applyCrop(const QRect& rect)
+{
+    recordEdit(ImageEdit::crop(rect));
+}
+
+QSize DocumentLoadedImpl::losslessCropAlignment() const
+{
+    return QSize();
+}
+
+QPoint DocumentLoadedImpl::losslessCropOrigin() const
+{
+    return QPoint();
+}
+
+void DocumentLoadedImpl::applyEdit(const ImageEdit& edit)
+{
+    recordEdit(edit);
+}
+
+void DocumentLoadedImpl::recordEdit(const ImageEdit& edit)
+{
+    if (QThread::currentThread() == thread()) {
+        applyQueuedEdits();
+        editDocumentImage(edit);
+        emit imageRectUpdated(QRect(QPoint(0, 0), document()->size()));
+        return;
+    }
+    // Image operations run in worker threads, but the GUI thread reads the
+    // edits and the size of the document while painting: change them from
+    // the GUI thread. The call is queued before the job emits its result.
+    QMutexLocker locker(&d->mQueuedEditsMutex);
+    d->mQueuedEdits << edit;
+    QMetaObject::invokeMethod(this, "applyQueuedEdits", Qt::QueuedConnection);
+}
+
+void DocumentLoadedImpl::applyQueuedEdits()
+{
+    QVector<ImageEdit> edits;
+    {
+        QMutexLocker locker(&d->mQueuedEditsMutex);
+        edits.swap(d->mQueuedEdits);
+    }
+    if (edits.isEmpty()) {
+        return;
+    }
+    for (const ImageEdit& edit : qAsConst(edits)) {
+        editDocumentImage(edit);
+    }
+    emit imageRectUpdated(QRect(QPoint(0, 0), document()->size()));
+}
+
+void DocumentLoadedImpl::revertLastEdit()
+{
+    applyQueuedEdits();
+    revertLastDocumentEdit();
+    emit imageRectUpdated(QRect(QPoint(0, 0), document()->size()));
 }
 
 QByteArray DocumentLoadedImpl::rawData() const
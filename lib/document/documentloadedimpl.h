@@ -22,12 +22,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #define DOCUMENTLOADEDIMPL_H
 
 // Qt
+#include <QImage>
 
 // KDE
 
 // Local
 #include <lib/document/abstractdocumenteditor.h>
 #include <lib/document/abstractdocumentimpl.h>
+#include <lib/document/editchain.h>
 
 class QByteArray;
 class QIODevice;
@@ -37,6 +39,30 @@ class QUrl;
 namespace Gwenview
 {
 
+/**
+ * What DocumentLoadedImpl::saveInternal() needs from the document. SaveJob
+ * copies it in the GUI thread, the edits are only applied in the worker
+ * thread, and only if the pixels are needed.
+ */
+struct DocumentSaveData
+{
+    QImage sourceImage;
+    EditChain edits;
+    /**
+     * The edited image, scaled down to fit the Large thumbnail group. It is
+     * computed from the closest down sampled image.
+     */
+    QImage thumbnail;
+
+    /**
+     * Returns what Document::image() would return
+     */
+    QImage image() const
+    {
+        return edits.isEmpty() ? sourceImage : edits.apply(sourceImage);
+    }
+};
+
 struct DocumentLoadedImplPrivate;
 class DocumentLoadedImpl : public AbstractDocumentImpl, protected AbstractDocumentEditor
 {
@@ -58,16 +84,30 @@ public:
     //
 
 protected:
-    virtual bool saveInternal(QIODevice* device, const QByteArray& format);
+    /**
+     * Called by SaveJob in a worker thread. Implementations must not access
+     * the image data of the document, only @p data.
+     */
+    virtual bool saveInternal(QIODevice* device, const QByteArray& format, const DocumentSaveData& data);
 
     // AbstractDocumentEditor
     void setImage(const QImage&) override;
     void applyTransformation(Orientation orientation) override;
+    void applyCrop(const QRect& rect) override;
+    QSize losslessCropAlignment() const override;
+    QPoint losslessCropOrigin() const override;
+    void applyEdit(const ImageEdit& edit) override;
+    void revertLastEdit() override;
     //
 
+private Q_SLOTS:
+    void applyQueuedEdits();
+
 private:
     DocumentLoadedImplPrivate* const d;
 
+    void recordEdit(const ImageEdit&);
+
     friend class SaveJob;
 };
 
@@ -0,0 +1,274 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "editchain.h"
+
+// Qt
+#include <QImage>
+
+// KDE
+
+// Local
+#include "imageutils.h"
+
+namespace Gwenview
+{
+
+// Amount of pixels to keep around a part before resizing it, so that smooth
+// scaling is correct on its borders
+static const int RESIZE_MARGIN = 2;
+
+static inline QRect scaledRect(const QRect& rect, qreal sx, qreal sy)
+{
+    return QRectF(rect.x() * sx, rect.y() * sy, rect.width() * sx, rect.height() * sy).toAlignedRect();
+}
+
+static inline bool isTransposing(const QTransform& matrix)
+{
+    return qFuzzyIsNull(matrix.m11());
+}
+
+/**
+ * Returns @p matrix followed by the translation which brings an image of
+ * size @p size back to the origin once transformed
+ */
+static QTransform placedMatrix(const QTransform& matrix, const QSize& size)
+{
+    const QRectF rect = matrix.mapRect(QRectF(QPointF(0, 0), QSizeF(size)));
+    return matrix * QTransform::fromTranslate(-rect.x(), -rect.y());
+}
+
+/**
+ * Returns the crop rect @p rect, defined on an image of size @p inputSize,
+ * for the same image scaled to @p size
+ */
+static QRect scaledCropRect(const QRect& rect, const QSize& inputSize, const QSize& size)
+{
+    const qreal sx = qreal(size.width()) / inputSize.width();
+    const qreal sy = qreal(size.height()) / inputSize.height();
+    return scaledRect(rect, sx, sy) & QRect(QPoint(0, 0), size);
+}
+
+//- ImageEdit ---------------------------------------------
+ImageEdit::ImageEdit(Kind kind)
+: mKind(kind)
+{
+}
+
+ImageEdit ImageEdit::transformation(Orientation orientation)
+{
+    ImageEdit edit(Transformation);
+    edit.mMatrix = ImageUtils::transformMatrix(orientation);
+    return edit;
+}
+
+ImageEdit ImageEdit::crop(const QRect& rect)
+{
+    ImageEdit edit(Crop);
+    edit.mRect = rect;
+    return edit;
+}
+
+ImageEdit ImageEdit::resize(const QSize& size)
+{
+    ImageEdit edit(Resize);
+    edit.mOutputSize = size;
+    return edit;
+}
+
+ImageEdit ImageEdit::pixelFunction(const Function& function)
+{
+    ImageEdit edit(PixelFunction);
+    edit.mFunction = function;
+    return edit;
+}
+
+//- EditChain ---------------------------------------------
+bool EditChain::isEmpty() const
+{
+    return mEdits.isEmpty();
+}
+
+void EditChain::append(const ImageEdit& edit, const QSize& inputSize)
+{
+    if (edit.mKind == ImageEdit::Transformation && !mEdits.isEmpty()
+        && mEdits.last().mKind == ImageEdit::Transformation) {
+        ImageEdit& last = mEdits.last();
+        last.mMatrix *= edit.mMatrix;
+        if (last.mMatrix.isIdentity()) {
+            mEdits.removeLast();
+            return;
+        }
+        last.mOutputSize = isTransposing(last.mMatrix) ? last.mInputSize.transposed() : last.mInputSize;
+        return;
+    }
+
+    ImageEdit newEdit = edit;
+    newEdit.mInputSize = inputSize;
+    switch (newEdit.mKind) {
+    case ImageEdit::Transformation:
+        newEdit.mOutputSize = isTransposing(newEdit.mMatrix) ? inputSize.transposed() : inputSize;
+        break;
+    case ImageEdit::Crop:
+        newEdit.mRect &= QRect(QPoint(0, 0), inputSize);
+        newEdit.mOutputSize = newEdit.mRect.size();
+        break;
+    case ImageEdit::Resize:
+        break;
+    case ImageEdit::PixelFunction:
+        newEdit.mOutputSize = inputSize;
+        break;
+    }
+    mEdits << newEdit;
+}
+
+void EditChain::removeLast()
+{
+    Q_ASSERT(!mEdits.isEmpty());
+    mEdits.removeLast();
+}
+
+QSize EditChain::sourceSize() const
+{
+    return mEdits.isEmpty() ? QSize() : mEdits.first().mInputSize;
+}
+
+QSize EditChain::size() const
+{
+    return mEdits.isEmpty() ? QSize() : mEdits.last().mOutputSize;
+}
+
+QVector<QSize> EditChain::scaledSizes(const QSize& sourceSize) const
+{
+    QVector<QSize> sizes;
+    sizes.reserve(mEdits.count() + 1);
+    sizes << sourceSize;
+    for (const ImageEdit& edit : mEdits) {
+        const QSize size = sizes.last();
+        switch (edit.mKind) {
+        case ImageEdit::Transformation:
+            sizes << (isTransposing(edit.mMatrix) ? size.transposed() : size);
+            break;
+        case ImageEdit::Crop:
+            sizes << scaledCropRect(edit.mRect, edit.mInputSize, size).size();
+            break;
+        case ImageEdit::Resize: {
+            const qreal sx = qreal(size.width()) / edit.mInputSize.width();
+            const qreal sy = qreal(size.height()) / edit.mInputSize.height();
+            sizes << QSize(qMax(1, qRound(edit.mOutputSize.width() * sx)),
+                           qMax(1, qRound(edit.mOutputSize.height() * sy)));
+            break;
+        }
+        case ImageEdit::PixelFunction:
+            sizes << size;
+            break;
+        }
+    }
+    return sizes;
+}
+
+QRect EditChain::sourceRect(const QRect& rect, const QSize& sourceSize) const
+{
+    const QVector<QSize> sizes = scaledSizes(sourceSize);
+    QRect result = rect & QRect(QPoint(0, 0), sizes.last());
+    for (int i = mEdits.count() - 1; i >= 0 && !result.isEmpty(); --i) {
+        const ImageEdit& edit = mEdits.at(i);
+        const QSize& size = sizes.at(i);
+        switch (edit.mKind) {
+        case ImageEdit::Transformation:
+            result = placedMatrix(edit.mMatrix, size).inverted().mapRect(QRectF(result)).toAlignedRect();
+            break;
+        case ImageEdit::Crop:
+            result.translate(scaledCropRect(edit.mRect, edit.mInputSize, size).topLeft());
+            break;
+        case ImageEdit::Resize: {
+            const qreal fx = qreal(sizes.at(i + 1).width()) / size.width();
+            const qreal fy = qreal(sizes.at(i + 1).height()) / size.height();
+            result = scaledRect(result, 1 / fx, 1 / fy)
+                .adjusted(-RESIZE_MARGIN, -RESIZE_MARGIN, RESIZE_MARGIN, RESIZE_MARGIN)
+                & QRect(QPoint(0, 0), size);
+            break;
+        }
+        case ImageEdit::PixelFunction:
+            // Pixels do not move
+            break;
+        }
+    }
+    return result;
+}
+
+QImage EditChain::apply(const QImage& part, QRect* rect, const QSize& sourceSize) const
+{
+    const QVector<QSize> sizes = scaledSizes(sourceSize);
+    QImage image = part;
+    QRect imageRect = *rect;
+    for (int i = 0; i < mEdits.count() && !image.isNull(); ++i) {
+        const ImageEdit& edit = mEdits.at(i);
+        const QSize& size = sizes.at(i);
+        switch (edit.mKind) {
+        case ImageEdit::Transformation:
+            image = ImageUtils::transformed(image, edit.mMatrix);
+            imageRect = placedMatrix(edit.mMatrix, size).mapRect(QRectF(imageRect)).toAlignedRect();
+            break;
+        case ImageEdit::Crop: {
+            const QRect cropRect = scaledCropRect(edit.mRect, edit.mInputSize, size);
+            const QRect partRect = imageRect & cropRect;
+            if (partRect.isEmpty()) {
+                image = QImage();
+            } else if (partRect != imageRect) {
+                image = image.copy(partRect.translated(-imageRect.topLeft()));
+            }
+            imageRect = partRect.translated(-cropRect.topLeft());
+            break;
+        }
+        case ImageEdit::Resize: {
+            const qreal fx = qreal(sizes.at(i + 1).width()) / size.width();
+            const qreal fy = qreal(sizes.at(i + 1).height()) / size.height();
+            const QRect partRect = scaledRect(imageRect, fx, fy) & QRect(QPoint(0, 0), sizes.at(i + 1));
+            if (partRect.isEmpty()) {
+                image = QImage();
+            } else {
+                image = image.scaled(partRect.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            }
+            imageRect = partRect;
+            break;
+        }
+        case ImageEdit::PixelFunction: {
+            const qreal sx = qreal(size.width()) / edit.mInputSize.width();
+            const qreal sy = qreal(size.height()) / edit.mInputSize.height();
+            const QTransform matrix = QTransform::fromScale(sx, sy)
+                * QTransform::fromTranslate(-imageRect.x(), -imageRect.y());
+            edit.mFunction(&image, matrix);
+            break;
+        }
+        }
+    }
+    *rect = image.isNull() ? QRect() : imageRect;
+    return image;
+}
+
+QImage EditChain::apply(const QImage& image) const
+{
+    QRect rect = image.rect();
+    return apply(image, &rect, image.size());
+}
+
+} // namespace
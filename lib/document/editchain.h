@@ -0,0 +1,150 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef EDITCHAIN_H
+#define EDITCHAIN_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QRect>
+#include <QSize>
+#include <QTransform>
+#include <QVector>
+
+// KDE
+
+// Local
+#include <lib/orientation.h>
+
+// STL
+#include <functional>
+
+class QImage;
+
+namespace Gwenview
+{
+
+/**
+ * An edit recorded on a document image, see Document::edits()
+ */
+class GWENVIEWLIB_EXPORT ImageEdit
+{
+public:
+    enum Kind {
+        Transformation, ///< A rotation or a flip
+        Crop,
+        Resize,
+        PixelFunction   ///< A change of pixels which does not move them
+    };
+
+    /**
+     * Changes the pixels of @p image in place. @p matrix maps coordinates of
+     * the full size image to coordinates in @p image, which can be a part of
+     * it, possibly scaled down. The function can change the image format.
+     */
+    typedef std::function<void(QImage* image, const QTransform& matrix)> Function;
+
+    static ImageEdit transformation(Orientation);
+    static ImageEdit crop(const QRect&);
+    static ImageEdit resize(const QSize&);
+    static ImageEdit pixelFunction(const Function&);
+
+    Kind kind() const
+    {
+        return mKind;
+    }
+
+private:
+    friend class EditChain;
+    explicit ImageEdit(Kind kind);
+
+    Kind mKind;
+    QTransform mMatrix;
+    QRect mRect;
+    QSize mInputSize;
+    QSize mOutputSize;
+    Function mFunction;
+};
+
+/**
+ * The edits applied to a document image, in order, which have not been
+ * applied to its pixels yet.
+ *
+ * Edits can be applied to the part of the image which is visible, at the
+ * resolution it is shown at, without touching the rest of the image. The
+ * full size result is only computed when it is needed, for example when the
+ * image is saved.
+ */
+class GWENVIEWLIB_EXPORT EditChain
+{
+public:
+    bool isEmpty() const;
+
+    /**
+     * Appends @p edit, which applies to an image of size @p inputSize.
+     * Consecutive transformations are merged, and dropped if they cancel each
+     * other.
+     */
+    void append(const ImageEdit& edit, const QSize& inputSize);
+
+    void removeLast();
+
+    /**
+     * Size of the image the edits apply to. Invalid if the chain is empty.
+     */
+    QSize sourceSize() const;
+
+    /**
+     * Size of the edited image. Invalid if the chain is empty.
+     */
+    QSize size() const;
+
+    /**
+     * Returns the rect of a source image of size @p sourceSize needed to
+     * compute @p rect of the edited image. @p sourceSize can be a scaled
+     * version of sourceSize(), @p rect and the returned rect are then at the
+     * same scale.
+     */
+    QRect sourceRect(const QRect& rect, const QSize& sourceSize) const;
+
+    /**
+     * Applies the edits to @p part, which covers @p rect of a source image of
+     * size @p sourceSize. Returns the edited pixels and sets @p rect to the
+     * rect of the edited image they cover. Returns a null image if the edits
+     * leave nothing of @p part.
+     */
+    QImage apply(const QImage& part, QRect* rect, const QSize& sourceSize) const;
+
+    /**
+     * Applies the edits to @p image, which can be a scaled version of the
+     * source image.
+     */
+    QImage apply(const QImage& image) const;
+
+private:
+    QVector<QSize> scaledSizes(const QSize& sourceSize) const;
+
+    QVector<ImageEdit> mEdits;
+};
+
+} // namespace
+
+#endif /* EDITCHAIN_H */
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 // KDE
 
 // Local
+#include "editchain.h"
 #include "jpegcontent.h"
 
 namespace Gwenview
@@ -36,6 +37,9 @@ namespace Gwenview
 struct JpegDocumentLoadedImplPrivate
 {
     JpegContent* mJpegContent;
+    // False when mJpegContent does not hold the result of the document edits
+    // anymore: the image must then be encoded again on save
+    bool mJpegContentUpToDate;
 };
 
 JpegDocumentLoadedImpl::JpegDocumentLoadedImpl(Document* doc, JpegContent* jpegContent)
@@ -44,6 +48,7 @@ JpegDocumentLoadedImpl::JpegDocumentLoadedImpl(Document* doc, JpegContent* jpegC
 {
     Q_ASSERT(jpegContent);
     d->mJpegContent = jpegContent;
+    d->mJpegContentUpToDate = true;
 }
 
 JpegDocumentLoadedImpl::~JpegDocumentLoadedImpl()
@@ -52,27 +57,37 @@ JpegDocumentLoadedImpl::~JpegDocumentLoadedImpl()
     delete d;
 }
 
-bool JpegDocumentLoadedImpl::saveInternal(QIODevice* device, const QByteArray& format)
+bool JpegDocumentLoadedImpl::saveInternal(QIODevice* device, const QByteArray& format, const DocumentSaveData& data)
 {
     if (format == "jpeg") {
+        if (!d->mJpegContentUpToDate) {
+            d->mJpegContent->setImage(data.image());
+        }
         if (!d->mJpegContent->thumbnail().isNull()) {
-            QImage thumbnail = document()->image().scaled(128, 128, Qt::KeepAspectRatio);
-            d->mJpegContent->setThumbnail(thumbnail);
+            // Do not compute the full edited image if it is not needed:
+            // JpegContent applies transformations and crops losslessly
+            const QImage& thumbnail = data.thumbnail;
+            d->mJpegContent->setThumbnail(qMax(thumbnail.width(), thumbnail.height()) > 128
+                ? thumbnail.scaled(128, 128, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+                : thumbnail);
         }
 
         bool ok = d->mJpegContent->save(device);
-        if (!ok) {
+        if (ok) {
+            d->mJpegContentUpToDate = true;
+        } else {
             setDocumentErrorString(d->mJpegContent->errorString());
         }
         return ok;
     } else {
-        return DocumentLoadedImpl::saveInternal(device, format);
+        return DocumentLoadedImpl::saveInternal(device, format, data);
     }
 }
 
 void JpegDocumentLoadedImpl::setImage(const QImage& image)
 {
     d->mJpegContent->setImage(image);
+    d->mJpegContentUpToDate = true;
     DocumentLoadedImpl::setImage(image);
 }
 
@@ -87,6 +102,37 @@ void JpegDocumentLoadedImpl::applyTransformation(Orientation orientation)
     d->mJpegContent->transform(orientation);
 }
 
+void JpegDocumentLoadedImpl::applyCrop(const QRect& rect)
+{
+    if (!d->mJpegContent->crop(rect)) {
+        // The image will be encoded again on save
+        d->mJpegContentUpToDate = false;
+    }
+    DocumentLoadedImpl::applyCrop(rect);
+}
+
+QSize JpegDocumentLoadedImpl::losslessCropAlignment() const
+{
+    return d->mJpegContent->losslessCropAlignment();
+}
+
+QPoint JpegDocumentLoadedImpl::losslessCropOrigin() const
+{
+    return d->mJpegContent->losslessCropOrigin();
+}
+
+void JpegDocumentLoadedImpl::applyEdit(const ImageEdit& edit)
+{
+    d->mJpegContentUpToDate = false;
+    DocumentLoadedImpl::applyEdit(edit);
+}
+
+void JpegDocumentLoadedImpl::revertLastEdit()
+{
+    d->mJpegContentUpToDate = false;
+    DocumentLoadedImpl::revertLastEdit();
+}
+
 QByteArray JpegDocumentLoadedImpl::rawData() const
 {
     return d->mJpegContent->rawData();
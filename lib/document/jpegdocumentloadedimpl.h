@@ -45,11 +45,16 @@ public:
     QByteArray rawData() const override;
 
 protected:
-    bool saveInternal(QIODevice* device, const QByteArray& format) override;
+    bool saveInternal(QIODevice* device, const QByteArray& format, const DocumentSaveData& data) override;
 
     // AbstractDocumentEditor
     void setImage(const QImage&) override;
     void applyTransformation(Orientation orientation) override;
+    void applyCrop(const QRect& rect) override;
+    QSize losslessCropAlignment() const override;
+    QPoint losslessCropOrigin() const override;
+    void applyEdit(const ImageEdit& edit) override;
+    void revertLastEdit() override;
     //
 
 private:
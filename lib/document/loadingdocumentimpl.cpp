@@ -52,6 +52,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
 // Local
 #include "animateddocumentloadedimpl.h"
+#include "animationscanner.h"
 #include "cms/cmsprofile.h"
 #include "document.h"
 #include "documentloadedimpl.h"
@@ -59,6 +60,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "exiv2imageloader.h"
 #include "gvdebug.h"
 #include "imageutils.h"
+#include "orientedjpegdecoder.h"
 #include "jpegcontent.h"
 #include "jpegdocumentloadedimpl.h"
 #include "orientation.h"
@@ -96,6 +98,8 @@ struct LoadingDocumentImplPrivate
 
     bool mMetaInfoLoaded;
     bool mAnimated;
+    bool mAnimationScanned;
+    AnimationScanner::Info mAnimationInfo;
     bool mDownSampledImageLoaded;
     QByteArray mFormatHint;
     QByteArray mData;
@@ -282,6 +286,10 @@ struct LoadingDocumentImplPrivate
 
         LOG("mImageSize" << mImageSize);
 
+        // Only walks the container blocks, so this is cheap even for big
+        // animations
+        mAnimationScanned = AnimationScanner::scan(mData, &mAnimationInfo);
+
         if (!mCmsProfile) {
             mCmsProfile = Cms::Profile::loadFromImageData(mData, mFormat);
         }
@@ -312,19 +320,45 @@ struct LoadingDocumentImplPrivate
             }
         }
 
+        Orientation orientation = NORMAL;
         if (GwenviewConfig::applyExifOrientation()) {
-            reader.setAutoTransform(true);
+            orientation = ImageUtils::orientationForTransformation(reader.transformation());
         }
 
-        bool ok = reader.read(&mImage);
-        if (!ok) {
-            LOG("QImageReader::read() failed");
-            return;
+        bool oriented = false;
+        if (mFormat == "jpeg" && orientation != NORMAL) {
+            // Decode straight into the rotated layout instead of rotating a
+            // fully decoded image: this avoids a second full size buffer
+            QBuffer jpegBuffer(&mData);
+            jpegBuffer.open(QIODevice::ReadOnly);
+            oriented = OrientedJpegDecoder::read(&jpegBuffer, orientation, reader.scaledSize(), &mImage);
         }
 
-        if (reader.supportsAnimation()
-                && reader.nextImageDelay() > 0 // Assume delay == 0 <=> only one frame
-           ) {
+        if (!oriented) {
+            bool ok = reader.read(&mImage);
+            if (!ok) {
+                LOG("QImageReader::read() failed");
+                return;
+            }
+        }
+        // Convert once here: compact formats are kept as is and alpha is
+        // premultiplied, so that the scaler, the display transform and
+        // QPainter do not have to convert every time the image is drawn
+        mImage = ImageUtils::convertToStorageFormat(mImage);
+
+        // Apply orientation ourselves rather than with
+        // QImageReader::setAutoTransform(): our kernels are faster
+        if (!oriented) {
+            mImage = ImageUtils::transformed(mImage, orientation);
+        }
+
+        if (!reader.supportsAnimation()) {
+            return;
+        }
+        if (mAnimationScanned) {
+            LOG("Frame count from container:" << mAnimationInfo.frameCount);
+            mAnimated = mAnimationInfo.frameCount > 1;
+        } else if (reader.nextImageDelay() > 0) { // Assume delay == 0 <=> only one frame
             /*
              * QImageReader is not really helpful to detect animated gif:
              * - QImageReader::imageCount() returns 0
@@ -333,8 +367,9 @@ struct LoadingDocumentImplPrivate
              *   Control Extension" (usually only present if we have an
              *   animation) (Bug #185523)
              *
-             * Decoding the next frame is the only reliable way I found to
-             * detect an animated gif
+             * AnimationScanner reads the frame count from GIF, APNG and WebP
+             * containers. For other formats, decoding the next frame is the
+             * only reliable way I found to detect an animated image.
              */
             LOG("May be an animated image. delay:" << reader.nextImageDelay());
             QImage nextImage;
@@ -355,6 +390,7 @@ LoadingDocumentImpl::LoadingDocumentImpl(Document* document)
     d->q = this;
     d->mMetaInfoLoaded = false;
     d->mAnimated = false;
+    d->mAnimationScanned = false;
     d->mDownSampledImageLoaded = false;
     d->mImageDataInvertedZoom = 0;
 
@@ -494,6 +530,7 @@ void LoadingDocumentImpl::slotMetaInfoLoaded()
     setDocumentImageSize(d->mImageSize);
     setDocumentExiv2Image(std::move(d->mExiv2Image));
     setDocumentCmsProfile(d->mCmsProfile);
+    setDocumentAnimationInfo(d->mAnimationInfo.frameCount, d->mAnimationInfo.duration);
 
     d->mMetaInfoLoaded = true;
     emit metaInfoLoaded();
@@ -22,13 +22,16 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include "savejob.h"
 
 // Qt
+#include <QAtomicInteger>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QImage>
 #include <QScopedPointer>
 #include <QtConcurrentRun>
 #include <QUrl>
 #include <QApplication>
 #include <QTemporaryFile>
+#include <QTimer>
 #include <QSaveFile>
 
 // KDE
@@ -39,10 +42,46 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Local
 #include "documentloadedimpl.h"
+#include <lib/thumbnailgroup.h>
+#include <lib/thumbnailprovider/thumbnailprovider.h>
 
 namespace Gwenview
 {
 
+// Interval at which the amount of bytes written is reported
+static const int PROGRESS_INTERVAL = 100;
+
+/**
+ * A QSaveFile which counts the bytes written to it. The count can be read
+ * from the GUI thread while the encoder writes from another one.
+ */
+class CountingSaveFile : public QSaveFile
+{
+public:
+    explicit CountingSaveFile(const QString& name)
+    : QSaveFile(name)
+    , mWrittenBytes(0)
+    {}
+
+    qint64 writtenBytes() const
+    {
+        return mWrittenBytes.load();
+    }
+
+protected:
+    qint64 writeData(const char* data, qint64 length) override
+    {
+        const qint64 written = QSaveFile::writeData(data, length);
+        if (written > 0) {
+            mWrittenBytes.fetchAndAddRelaxed(written);
+        }
+        return written;
+    }
+
+private:
+    QAtomicInteger<qint64> mWrittenBytes;
+};
+
 struct SaveJobPrivate
 {
     DocumentLoadedImpl* mImpl;
@@ -50,8 +89,15 @@ struct SaveJobPrivate
     QUrl mNewUrl;
     QByteArray mFormat;
     QScopedPointer<QTemporaryFile> mTemporaryFile;
-    QScopedPointer<QSaveFile> mSaveFile;
+    QScopedPointer<CountingSaveFile> mSaveFile;
     QScopedPointer<QFutureWatcher<void> > mInternalSaveWatcher;
+    QTimer* mProgressTimer;
+    // Copied from the document in the GUI thread for the worker thread
+    DocumentSaveData mData;
+    QImage mDownSampledImage;
+    qreal mThumbnailZoom;
+    // Image the thumbnails of the saved file are generated from
+    QImage mThumbnailImage;
 
     bool mKillReceived;
 };
@@ -64,6 +110,10 @@ SaveJob::SaveJob(DocumentLoadedImpl* impl, const QUrl &url, const QByteArray& fo
     d->mNewUrl = url;
     d->mFormat = format;
     d->mKillReceived = false;
+    d->mThumbnailZoom = 1;
+    d->mProgressTimer = new QTimer(this);
+    d->mProgressTimer->setInterval(PROGRESS_INTERVAL);
+    connect(d->mProgressTimer, &QTimer::timeout, this, &SaveJob::updateProgress);
     setCapabilities(Killable);
 }
 
@@ -74,10 +124,22 @@ SaveJob::~SaveJob()
 
 void SaveJob::saveInternal()
 {
-    if (!d->mImpl->saveInternal(d->mSaveFile.data(), d->mFormat)) {
+    // Like Document::scaledImage(), but from the copies we were given: scale
+    // the closest down sampled image, then edit it
+    if (!d->mData.sourceImage.isNull()) {
+        const QImage& source = d->mDownSampledImage.isNull() ? d->mData.sourceImage : d->mDownSampledImage;
+        const QImage scaled = source.scaled(d->mData.sourceImage.size() * d->mThumbnailZoom, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        d->mData.thumbnail = d->mData.edits.apply(scaled);
+    }
+
+    if (!d->mImpl->saveInternal(d->mSaveFile.data(), d->mFormat, d->mData)) {
         d->mSaveFile->cancelWriting();
         setError(UserDefinedError + 2);
         setErrorText(d->mImpl->document()->errorString());
+        return;
+    }
+    if (d->mNewUrl.isLocalFile()) {
+        d->mThumbnailImage = d->mData.thumbnail;
     }
 }
 
@@ -97,7 +159,7 @@ void SaveJob::doStart()
         fileName = d->mTemporaryFile->fileName();
     }
 
-    d->mSaveFile.reset(new QSaveFile(fileName));
+    d->mSaveFile.reset(new CountingSaveFile(fileName));
 
     if (!d->mSaveFile->open(QSaveFile::WriteOnly)) {
         QUrl dirUrl = d->mNewUrl;
@@ -112,15 +174,37 @@ void SaveJob::doStart()
         return;
     }
 
+    // The GUI thread keeps changing the images of the document, give the
+    // worker thread copies. Copying the source image is cheap, edits are only
+    // applied in the worker thread if they are needed.
+    const Document* document = d->mImpl->document();
+    d->mData.sourceImage = document->sourceImage();
+    d->mData.edits = document->edits();
+    const QSize size = document->size();
+    const int pixelSize = ThumbnailGroup::pixelSize(ThumbnailGroup::Large);
+    d->mThumbnailZoom = size.isEmpty()
+        ? 1.
+        : qMin(qreal(1), qMin(qreal(pixelSize) / size.width(), qreal(pixelSize) / size.height()));
+    d->mDownSampledImage = document->downSampledImageForZoom(d->mThumbnailZoom);
     QFuture<void> future = QtConcurrent::run(this, &SaveJob::saveInternal);
     d->mInternalSaveWatcher.reset(new QFutureWatcher<void>(this));
     connect(d->mInternalSaveWatcher.data(), &QFutureWatcherBase::finished, this, &SaveJob::finishSave);
     d->mInternalSaveWatcher->setFuture(future);
+    d->mProgressTimer->start();
+}
+
+void SaveJob::updateProgress()
+{
+    setProcessedAmount(Bytes, d->mSaveFile->writtenBytes());
 }
 
 void SaveJob::finishSave()
 {
     d->mInternalSaveWatcher.reset(nullptr);
+    d->mData = DocumentSaveData();
+    d->mDownSampledImage = QImage();
+    d->mProgressTimer->stop();
+    updateProgress();
     if (d->mKillReceived) {
         return;
     }
@@ -134,10 +218,15 @@ void SaveJob::finishSave()
         setErrorText(xi18nc("@info", "Could not overwrite file, check that you have the necessary rights to write in <filename>%1</filename>.",
                             d->mNewUrl.toString()));
         setError(UserDefinedError + 3);
+        emitResult();
         return;
     }
 
     if (d->mNewUrl.isLocalFile()) {
+        // The thumbnails in the cache are outdated now, replace them with
+        // ones made from the image in memory instead of decoding the file
+        ThumbnailProvider::cacheThumbnails(d->mNewUrl, d->mThumbnailImage, d->mImpl->document()->size());
+        d->mThumbnailImage = QImage();
         emitResult();
     } else {
         KIO::Job* job = KIO::copy(QUrl::fromLocalFile(d->mTemporaryFile->fileName()), d->mNewUrl);
@@ -167,6 +256,7 @@ QUrl SaveJob::newUrl() const
 bool SaveJob::doKill()
 {
     d->mKillReceived = true;
+    d->mProgressTimer->stop();
     if (d->mInternalSaveWatcher) {
         d->mInternalSaveWatcher->waitForFinished();
     }
@@ -39,6 +39,10 @@ namespace Gwenview
 class DocumentLoadedImpl;
 
 struct SaveJobPrivate;
+/**
+ * Saves a document. The amount of bytes written so far is reported through
+ * KJob::processedAmount(), in KJob::Bytes.
+ */
 class GWENVIEWLIB_EXPORT SaveJob : public DocumentJob
 {
     Q_OBJECT
@@ -59,6 +63,7 @@ protected:
 
 private Q_SLOTS:
     void finishSave();
+    void updateProgress();
 
 private:
     SaveJobPrivate* const d;
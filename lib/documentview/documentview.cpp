@@ -59,6 +59,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <lib/documentview/messageviewadapter.h>
 #include <lib/documentview/rasterimageview.h>
 #include <lib/documentview/rasterimageviewadapter.h>
+#include <lib/documentview/renderscheduler.h>
 #include <lib/documentview/svgviewadapter.h>
 #include <lib/documentview/videoviewadapter.h>
 #include <lib/hud/hudbutton.h>
@@ -121,10 +122,15 @@ struct DocumentViewPrivate
 
     Touch* mTouch;
 
+    QPointer<RenderScheduler> mRenderScheduler;
+
     void setCurrentAdapter(AbstractDocumentViewAdapter* adapter)
     {
         Q_ASSERT(adapter);
         mAdapter.reset(adapter);
+        if (adapter->rasterImageView()) {
+            adapter->rasterImageView()->setRenderScheduler(mRenderScheduler);
+        }
 
         adapter->widget()->setParentItem(q);
         resizeAdapterWidget();
@@ -901,6 +907,14 @@ qreal DocumentView::minimumZoom() const
     return qBound(qreal(0.001), d->mAdapter->computeZoomToFit(), qreal(1.));
 }
 
+void DocumentView::setRenderScheduler(RenderScheduler* scheduler)
+{
+    d->mRenderScheduler = scheduler;
+    if (d->mAdapter->rasterImageView()) {
+        d->mAdapter->rasterImageView()->setRenderScheduler(scheduler);
+    }
+}
+
 void DocumentView::setCompareMode(bool compare)
 {
     d->mCompareMode = compare;
@@ -39,6 +39,7 @@ namespace Gwenview
 
 class AbstractRasterImageViewTool;
 class RasterImageView;
+class RenderScheduler;
 
 struct DocumentViewPrivate;
 
@@ -110,6 +111,12 @@ public:
 
     void setCompareMode(bool);
 
+    /**
+     * Set the scheduler used to render raster images. It is shared by all the
+     * views of a DocumentViewContainer.
+     */
+    void setRenderScheduler(RenderScheduler*);
+
     bool zoomToFit() const;
 
     bool zoomToFill() const;
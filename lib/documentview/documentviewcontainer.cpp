@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Local
 #include <lib/documentview/documentview.h>
+#include <lib/documentview/renderscheduler.h>
 #include <lib/graphicswidgetfloater.h>
 #include <lib/gvdebug.h>
 #include <lib/gwenviewconfig.h>
@@ -52,6 +53,7 @@ struct DocumentViewContainerPrivate
     DocumentViewSet mAddedViews;
     DocumentViewSet mRemovedViews;
     QTimer* mLayoutUpdateTimer;
+    RenderScheduler* mRenderScheduler;
 
     void scheduleLayoutUpdate()
     {
@@ -87,6 +89,7 @@ DocumentViewContainer::DocumentViewContainer(QWidget* parent)
 {
     d->q = this;
     d->mScene = new QGraphicsScene(this);
+    d->mRenderScheduler = new RenderScheduler(this);
     if (GwenviewConfig::animationMethod() == DocumentView::GLAnimation) {
         QGLWidget* glWidget = new QGLWidget;
         if (glWidget->isValid()) {
@@ -120,6 +123,7 @@ DocumentView* DocumentViewContainer::createView()
 {
     DocumentView* view = new DocumentView(d->mScene);
     view->setPalette(palette());
+    view->setRenderScheduler(d->mRenderScheduler);
     d->mAddedViews << view;
     view->show();
     connect(view, &DocumentView::fadeInFinished, this, &DocumentViewContainer::slotFadeInFinished);
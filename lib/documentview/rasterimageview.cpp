@@ -95,11 +95,24 @@ struct RasterImageViewPrivate
         case QImage::Format_ARGB32:
             cmsFormat = TYPE_BGRA_8;
             break;
+        case QImage::Format_ARGB32_Premultiplied:
+#ifdef TYPE_BGRA_8_PREMUL
+            cmsFormat = TYPE_BGRA_8_PREMUL;
+#else
+            // Older lcms versions do not know about premultiplied alpha:
+            // updateFromScaler() unpremultiplies the image before applying
+            // the transform
+            cmsFormat = TYPE_BGRA_8;
+#endif
+            break;
+        case QImage::Format_RGB888:
+            cmsFormat = TYPE_RGB_8;
+            break;
         case QImage::Format_Grayscale8:
             cmsFormat = TYPE_GRAY_8;
             break;
         default:
-            qCWarning(GWENVIEW_LIB_LOG) << "Gwenview can only apply color profile on RGB32 or ARGB32 images";
+            qCWarning(GWENVIEW_LIB_LOG) << "Gwenview can only apply color profile on RGB32, ARGB32, RGB888 or Grayscale8 images";
             return;
         }
 
@@ -109,6 +122,17 @@ struct RasterImageViewPrivate
         mApplyDisplayTransform = true;
     }
 
+    void applyDisplayTransform(QImage* image)
+    {
+        // Transform line by line: lines of 24 and 8 bits images are padded
+        // to 32 bits
+        const int width = image->width();
+        for (int y = 0; y < image->height(); ++y) {
+            uchar* line = const_cast<uchar*>(image->constScanLine(y));
+            cmsDoTransform(mDisplayTransform, line, line, width);
+        }
+    }
+
     void setupUpdateTimer()
     {
         mUpdateTimer = new QTimer(q);
@@ -120,6 +144,7 @@ struct RasterImageViewPrivate
     void startAnimationIfNecessary()
     {
         if (q->document() && q->isVisible()) {
+            q->document()->setAnimationDisplayZoom(q->zoom());
             q->document()->startAnimation();
         }
     }
@@ -246,6 +271,11 @@ void RasterImageView::setRenderingIntent(const RenderingIntent::Enum& renderingI
     }
 }
 
+void RasterImageView::setRenderScheduler(RenderScheduler* scheduler)
+{
+    d->mScaler->setRenderScheduler(scheduler);
+}
+
 void RasterImageView::loadFromDocument()
 {
     Document::Ptr doc = document();
@@ -331,11 +361,20 @@ void RasterImageView::slotDocumentIsAnimatedUpdated()
 
 void RasterImageView::updateFromScaler(int zoomedImageLeft, int zoomedImageTop, const QImage& image)
 {
+    QImage displayImage = image;
     if (d->mApplyDisplayTransform) {
         d->updateDisplayTransform(image.format());
         if (d->mDisplayTransform) {
-            quint8 *bytes = const_cast<quint8*>(image.bits());
-            cmsDoTransform(d->mDisplayTransform, bytes, bytes, image.width() * image.height());
+#ifndef TYPE_BGRA_8_PREMUL
+            if (image.format() == QImage::Format_ARGB32_Premultiplied) {
+                displayImage = image.convertToFormat(QImage::Format_ARGB32);
+                d->applyDisplayTransform(&displayImage);
+                displayImage = displayImage.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+            } else
+#endif
+            {
+                d->applyDisplayTransform(&displayImage);
+            }
         }
     }
 
@@ -348,14 +387,14 @@ void RasterImageView::updateFromScaler(int zoomedImageLeft, int zoomedImageTop,
         painter.setCompositionMode(QPainter::CompositionMode_Source);
         if (document()->hasAlphaChannel()) {
             d->drawAlphaBackground(
-                &painter, QRect(viewportLeft, viewportTop, image.width(), image.height()),
+                &painter, QRect(viewportLeft, viewportTop, displayImage.width(), displayImage.height()),
                 QPoint(zoomedImageLeft, zoomedImageTop),
                 alphaBackgroundTexture()
             );
             // This is required so transparent pixels don't replace our background
             painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
         }
-        painter.drawImage(viewportLeft, viewportTop, image);
+        painter.drawImage(viewportLeft, viewportTop, displayImage);
     }
     update();
 
@@ -367,6 +406,9 @@ void RasterImageView::updateFromScaler(int zoomedImageLeft, int zoomedImageTop,
 
 void RasterImageView::onZoomChanged()
 {
+    if (document() && document()->isAnimated()) {
+        document()->setAnimationDisplayZoom(zoom());
+    }
     d->mScaler->setZoom(zoom());
     if (!d->mUpdateTimer->isActive()) {
         updateBuffer();
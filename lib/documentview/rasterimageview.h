@@ -35,6 +35,7 @@ namespace Gwenview
 {
 
 class AbstractRasterImageViewTool;
+class RenderScheduler;
 
 struct RasterImageViewPrivate;
 class GWENVIEWLIB_EXPORT RasterImageView : public AbstractImageView
@@ -53,6 +54,11 @@ public:
     void setAlphaBackgroundColor(const QColor& color) override;
     void setRenderingIntent(const RenderingIntent::Enum& renderingIntent);
 
+    /**
+     * Share @p scheduler with other views, see RenderScheduler
+     */
+    void setRenderScheduler(RenderScheduler* scheduler);
+
 Q_SIGNALS:
     void currentToolChanged(AbstractRasterImageViewTool*);
     void imageRectUpdated();
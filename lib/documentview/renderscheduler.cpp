@@ -0,0 +1,127 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+// Self
+#include "renderscheduler.h"
+
+// Qt
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QTimer>
+#include <QtConcurrent>
+#include "gwenview_lib_debug.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+struct RenderRequest
+{
+    QPointer<QObject> mClient;
+    RenderScheduler::RenderFunction mRender;
+    RenderScheduler::DeliverFunction mDeliver;
+    RenderScheduler::Tile mTile;
+};
+
+typedef QList<RenderRequest> RenderRequestList;
+
+static void render(RenderRequest& request)
+{
+    request.mTile = request.mRender();
+}
+
+struct RenderSchedulerPrivate
+{
+    QTimer* mBatchTimer;
+    RenderRequestList mPendingRequests;
+    RenderRequestList mBatch;
+    QFutureWatcher<void> mBatchWatcher;
+};
+
+RenderScheduler::RenderScheduler(QObject* parent)
+: QObject(parent)
+, d(new RenderSchedulerPrivate)
+{
+    // Single-shot, 0 interval: collect all the requests made before going
+    // back to the event loop in the same batch
+    d->mBatchTimer = new QTimer(this);
+    d->mBatchTimer->setInterval(0);
+    d->mBatchTimer->setSingleShot(true);
+    connect(d->mBatchTimer, &QTimer::timeout, this, &RenderScheduler::startBatch);
+
+    connect(&d->mBatchWatcher, &QFutureWatcherBase::finished,
+            this, &RenderScheduler::finishBatch);
+}
+
+RenderScheduler::~RenderScheduler()
+{
+    d->mBatchWatcher.disconnect();
+    d->mBatchWatcher.waitForFinished();
+    delete d;
+}
+
+void RenderScheduler::schedule(QObject* client, const RenderFunction& render, const DeliverFunction& deliver)
+{
+    RenderRequest request;
+    request.mClient = client;
+    request.mRender = render;
+    request.mDeliver = deliver;
+    d->mPendingRequests << request;
+
+    if (!d->mBatchWatcher.isRunning()) {
+        d->mBatchTimer->start();
+    }
+}
+
+void RenderScheduler::startBatch()
+{
+    if (d->mPendingRequests.isEmpty() || d->mBatchWatcher.isRunning()) {
+        return;
+    }
+    LOG("Rendering" << d->mPendingRequests.count() << "tiles");
+    d->mBatch.swap(d->mPendingRequests);
+    d->mBatchWatcher.setFuture(QtConcurrent::map(d->mBatch, render));
+}
+
+void RenderScheduler::finishBatch()
+{
+    // Deliver all tiles in one go, so that all views get repainted in the
+    // same frame
+    for (const RenderRequest& request : qAsConst(d->mBatch)) {
+        if (request.mClient) {
+            request.mDeliver(request.mTile);
+        }
+    }
+    d->mBatch.clear();
+
+    if (!d->mPendingRequests.isEmpty()) {
+        startBatch();
+    }
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <lib/gwenviewlib_export.h>
+
+// STL
+#include <functional>
+
+// Qt
+#include <QImage>
+#include <QObject>
+#include <QPoint>
+
+namespace Gwenview
+{
+
+struct RenderSchedulerPrivate;
+/**
+ * Renders image tiles for all the views of a DocumentViewContainer.
+ *
+ * Requests made while the event loop is busy are batched together, rendered
+ * in parallel on the global thread pool and delivered together, so that
+ * synchronized views in compare mode are updated in the same frame.
+ */
+class GWENVIEWLIB_EXPORT RenderScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    struct Tile {
+        QPoint topLeft;
+        QImage image;
+    };
+
+    /**
+     * Called in a worker thread, must not touch any QObject
+     */
+    typedef std::function<Tile()> RenderFunction;
+
+    /**
+     * Called in the GUI thread, with the rendered tile
+     */
+    typedef std::function<void(const Tile&)> DeliverFunction;
+
+    explicit RenderScheduler(QObject* parent = nullptr);
+    ~RenderScheduler() override;
+
+    /**
+     * Schedule a call to @p render. Once it is done, @p deliver is called
+     * with the result, unless @p client has been deleted in the meantime.
+     */
+    void schedule(QObject* client, const RenderFunction& render, const DeliverFunction& deliver);
+
+private Q_SLOTS:
+    void startBatch();
+    void finishBatch();
+
+private:
+    RenderSchedulerPrivate* const d;
+};
+
+} // namespace
+
+#endif /* RENDERSCHEDULER_H */
@@ -0,0 +1,326 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+// Self
+#include "svgtilecache.h"
+
+// STL
+#include <algorithm>
+
+// Qt
+#include <QCache>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPainter>
+#include <QHash>
+#include <QSharedPointer>
+#include <QSvgRenderer>
+#include <QThreadStorage>
+#include <QtConcurrent>
+#include "gwenview_lib_debug.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+// Size of a tile, in device pixels
+static const int TILE_SIZE = 256;
+
+// Maximum amount of memory used by the tiles of one document
+static const int MAX_CACHE_COST = 64 * 1024 * 1024;
+
+// The preview is a rendering of the whole document which fits in a square of
+// this size. It is used while no better tile is available.
+static const int PREVIEW_SIZE = 1024;
+
+struct TileKey
+{
+    qreal zoom;
+    int column;
+    int row;
+
+    bool operator==(const TileKey& other) const
+    {
+        return zoom == other.zoom && column == other.column && row == other.row;
+    }
+};
+
+inline uint qHash(const TileKey& key, uint seed = 0)
+{
+    return qHash(key.zoom, seed) ^ (uint(key.column) << 16) ^ uint(key.row);
+}
+
+/**
+ * QSvgRenderer is not thread-safe: each worker thread gets its own instance.
+ */
+struct ThreadSvgRenderer
+{
+    QByteArray mData;
+    QScopedPointer<QSvgRenderer> mRenderer;
+};
+
+static QThreadStorage<ThreadSvgRenderer*> sThreadSvgRenderers;
+
+static QSvgRenderer* threadSvgRenderer(const QByteArray& data)
+{
+    if (!sThreadSvgRenderers.hasLocalData()) {
+        sThreadSvgRenderers.setLocalData(new ThreadSvgRenderer);
+    }
+    ThreadSvgRenderer* threadRenderer = sThreadSvgRenderers.localData();
+    // Comparing data pointers is enough: as long as we hold a reference to
+    // data, its buffer cannot be reused for another document
+    if (!threadRenderer->mRenderer || threadRenderer->mData.constData() != data.constData()) {
+        threadRenderer->mData = data;
+        threadRenderer->mRenderer.reset(new QSvgRenderer(data));
+    }
+    return threadRenderer->mRenderer.data();
+}
+
+/**
+ * Renders @p deviceRect of the SVG, zoomed by @p zoom. @p zoom is in device
+ * pixels: it includes the device pixel ratio. Called in a worker thread.
+ */
+static QImage renderSvgRect(const QByteArray& data, const QSize& size, const QRect& deviceRect, qreal zoom)
+{
+    QSvgRenderer* renderer = threadSvgRenderer(data);
+    QImage image(deviceRect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.translate(-deviceRect.topLeft());
+    renderer->render(&painter, QRectF(QPointF(0, 0), QSizeF(size) * zoom));
+    return image;
+}
+
+static inline QRectF scaledRect(const QRectF& rect, qreal factor)
+{
+    return QRectF(rect.topLeft() * factor, rect.size() * factor);
+}
+
+struct SvgTileCachePrivate
+{
+    SvgTileCache* q;
+    QByteArray mData;
+    QSize mSize;
+    // Tiles are keyed by device zoom: zoom * device pixel ratio
+    QCache<TileKey, QImage> mTiles;
+    // Zoom generation at which each pending tile has been queued
+    QHash<TileKey, int> mPendingTiles;
+    QImage mPreview;
+    qreal mPreviewZoom;
+    // Last zoom for which all visible tiles were available. Its tiles are
+    // used when tiles for the current zoom are missing.
+    qreal mFallbackZoom;
+    // Device zoom of the last paint. mZoomGeneration is bumped whenever it
+    // changes, so that queued tiles for previous zooms are skipped by the
+    // worker threads instead of flooding the thread pool during zoom
+    // animations.
+    qreal mCurrentZoom;
+    QSharedPointer<QAtomicInt> mZoomGeneration;
+
+    QRect zoomedImageRect(qreal zoom) const
+    {
+        return QRect(QPoint(0, 0), (QSizeF(mSize) * zoom).toSize());
+    }
+
+    QRect tileRect(qreal zoom, int column, int row) const
+    {
+        return QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+               .intersected(zoomedImageRect(zoom));
+    }
+
+    void startPreviewRendering()
+    {
+        mPreviewZoom = qMin(1., qreal(PREVIEW_SIZE) / qMax(mSize.width(), mSize.height()));
+        QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(q);
+        const QByteArray data = mData;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, q, [this, watcher, data]() {
+            // Ignore the result if the document changed in the meantime
+            if (data.constData() == mData.constData()) {
+                mPreview = watcher->result();
+                emit q->tileRendered();
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run(renderSvgRect, mData, mSize, zoomedImageRect(mPreviewZoom), mPreviewZoom));
+    }
+
+    void startTileRendering(const TileKey& key)
+    {
+        const int generation = mZoomGeneration->load();
+        if (mPendingTiles.value(key, -1) == generation) {
+            return;
+        }
+        LOG("Rendering" << key.zoom << key.column << key.row);
+        mPendingTiles.insert(key, generation);
+        QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(q);
+        const QByteArray data = mData;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, q, [this, watcher, data, key, generation]() {
+            if (data.constData() == mData.constData()) {
+                if (mPendingTiles.value(key, -1) == generation) {
+                    mPendingTiles.remove(key);
+                }
+                // The image is null if the tile was skipped
+                const QImage image = watcher->result();
+                if (!image.isNull()) {
+                    mTiles.insert(key, new QImage(image), image.byteCount());
+                    emit q->tileRendered();
+                }
+            }
+            watcher->deleteLater();
+        });
+        const QSize size = mSize;
+        const QRect rect = tileRect(key.zoom, key.column, key.row);
+        const qreal zoom = key.zoom;
+        const QSharedPointer<QAtomicInt> zoomGeneration = mZoomGeneration;
+        watcher->setFuture(QtConcurrent::run([data, size, rect, zoom, zoomGeneration, generation]() {
+            if (zoomGeneration->load() != generation) {
+                return QImage();
+            }
+            return renderSvgRect(data, size, rect, zoom);
+        }));
+    }
+
+    /**
+     * Draws what we have in store for the missing tile @p deviceRect at
+     * device zoom @p zoom: first the preview, then tiles from mFallbackZoom.
+     */
+    void drawFallback(QPainter* painter, const QPointF& imageTopLeft, const QRect& deviceRect, qreal zoom, qreal dpr)
+    {
+        const QRectF targetRect = scaledRect(deviceRect, 1. / dpr).translated(imageTopLeft);
+        painter->save();
+        painter->setClipRect(targetRect);
+        if (!mPreview.isNull()) {
+            const QRectF sourceRect = scaledRect(deviceRect, mPreviewZoom / zoom);
+            painter->drawImage(targetRect, mPreview, sourceRect);
+        }
+
+        if (mFallbackZoom > 0 && mFallbackZoom != zoom) {
+            const qreal factor = mFallbackZoom / zoom;
+            const QRect fallbackRect = scaledRect(deviceRect, factor).toAlignedRect();
+            for (int row = fallbackRect.top() / TILE_SIZE; row <= fallbackRect.bottom() / TILE_SIZE; ++row) {
+                for (int column = fallbackRect.left() / TILE_SIZE; column <= fallbackRect.right() / TILE_SIZE; ++column) {
+                    const QImage* tile = mTiles.object({mFallbackZoom, column, row});
+                    if (!tile) {
+                        continue;
+                    }
+                    const QRect fallbackTileRect = tileRect(mFallbackZoom, column, row);
+                    const QRectF rect = scaledRect(fallbackTileRect, 1. / (factor * dpr)).translated(imageTopLeft);
+                    painter->drawImage(rect, *tile);
+                }
+            }
+        }
+        painter->restore();
+    }
+};
+
+SvgTileCache::SvgTileCache(QObject* parent)
+: QObject(parent)
+, d(new SvgTileCachePrivate)
+{
+    d->q = this;
+    d->mTiles.setMaxCost(MAX_CACHE_COST);
+    d->mPreviewZoom = 0;
+    d->mFallbackZoom = 0;
+    d->mCurrentZoom = 0;
+    d->mZoomGeneration.reset(new QAtomicInt(0));
+}
+
+SvgTileCache::~SvgTileCache()
+{
+    delete d;
+}
+
+void SvgTileCache::setSvgData(const QByteArray& data, const QSize& size)
+{
+    d->mData = data;
+    d->mSize = size;
+    d->mTiles.clear();
+    d->mPendingTiles.clear();
+    d->mPreview = QImage();
+    d->mFallbackZoom = 0;
+    if (!d->mSize.isEmpty()) {
+        d->startPreviewRendering();
+    }
+}
+
+void SvgTileCache::paint(QPainter* painter, const QPointF& imageTopLeft, const QRectF& visibleRect, qreal zoom, qreal dpr)
+{
+    // Tiles are rendered at the resolution of the device
+    const qreal deviceZoom = zoom * dpr;
+    if (deviceZoom != d->mCurrentZoom) {
+        d->mCurrentZoom = deviceZoom;
+        d->mZoomGeneration->ref();
+    }
+    const QRect deviceRect = scaledRect(visibleRect, dpr).toAlignedRect()
+                             .intersected(d->zoomedImageRect(deviceZoom));
+    if (deviceRect.isEmpty()) {
+        return;
+    }
+
+    bool complete = true;
+    for (int row = deviceRect.top() / TILE_SIZE; row <= deviceRect.bottom() / TILE_SIZE; ++row) {
+        for (int column = deviceRect.left() / TILE_SIZE; column <= deviceRect.right() / TILE_SIZE; ++column) {
+            const TileKey key = {deviceZoom, column, row};
+            const QRect tileRect = d->tileRect(deviceZoom, column, row);
+            QImage* tile = d->mTiles.object(key);
+            if (tile) {
+                const QPointF pos = QPointF(tileRect.topLeft()) / dpr + imageTopLeft;
+                painter->drawImage(QRectF(pos, QSizeF(tileRect.size()) / dpr), *tile);
+            } else {
+                complete = false;
+                d->drawFallback(painter, imageTopLeft, tileRect, deviceZoom, dpr);
+                d->startTileRendering(key);
+            }
+        }
+    }
+
+    if (complete) {
+        d->mFallbackZoom = deviceZoom;
+    }
+}
+
+void SvgTileCache::setMaxCost(int cost)
+{
+    d->mTiles.setMaxCost(cost);
+}
+
+int SvgTileCache::cost() const
+{
+    return d->mTiles.totalCost();
+}
+
+int SvgTileCache::tileCount(qreal zoom, qreal dpr) const
+{
+    const qreal deviceZoom = zoom * dpr;
+    const QList<TileKey> keys = d->mTiles.keys();
+    return std::count_if(keys.begin(), keys.end(), [deviceZoom](const TileKey& key) {
+        return key.zoom == deviceZoom;
+    });
+}
+
+} // namespace
@@ -0,0 +1,92 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA.
+
+*/
+#ifndef SVGTILECACHE_H
+#define SVGTILECACHE_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QObject>
+
+class QByteArray;
+class QPainter;
+class QPointF;
+class QRectF;
+class QSize;
+
+namespace Gwenview
+{
+
+struct SvgTileCachePrivate;
+/**
+ * Rasterizes an SVG document in tiles, in worker threads, and keeps the tiles
+ * around so that the SVG is not rendered from vector data on every paint.
+ *
+ * Missing tiles are drawn from lower resolution tiles until they are ready.
+ * tileRendered() is emitted whenever a tile becomes available.
+ */
+class GWENVIEWLIB_EXPORT SvgTileCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SvgTileCache(QObject* parent = nullptr);
+    ~SvgTileCache() override;
+
+    /**
+     * @p data is the content of the SVG file, @p size its default size
+     */
+    void setSvgData(const QByteArray& data, const QSize& size);
+
+    /**
+     * Draws the part of the SVG zoomed by @p zoom which is inside
+     * @p visibleRect. @p visibleRect is in logical zoomed image coordinates,
+     * @p imageTopLeft is the position of the zoomed image in painter
+     * coordinates. Tiles are rendered at @p zoom times @p dpr, so that they
+     * are sharp on high DPI screens.
+     */
+    void paint(QPainter* painter, const QPointF& imageTopLeft, const QRectF& visibleRect, qreal zoom, qreal dpr);
+
+    /**
+     * Sets the maximum amount of memory the tiles can use, in bytes. The
+     * least recently used tiles are dropped to stay below it.
+     */
+    void setMaxCost(int cost);
+
+    /**
+     * Returns the amount of memory used by the tiles, in bytes
+     */
+    int cost() const;
+
+    /**
+     * Returns the number of tiles in store for @p zoom times @p dpr
+     */
+    int tileCount(qreal zoom, qreal dpr) const;
+
+Q_SIGNALS:
+    void tileRendered();
+
+private:
+    SvgTileCachePrivate* const d;
+};
+
+} // namespace
+
+#endif /* SVGTILECACHE_H */
@@ -23,7 +23,6 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Qt
 #include <QCursor>
-#include <QGraphicsSvgItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsWidget>
 #include <QPainter>
@@ -35,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 // Local
 #include "document/documentfactory.h"
 #include <qgraphicssceneevent.h>
+#include <lib/documentview/svgtilecache.h>
 #include <lib/gvdebug.h>
 #include <lib/gwenviewconfig.h>
 
@@ -44,17 +44,18 @@ namespace Gwenview
 /// SvgImageView ////
 SvgImageView::SvgImageView(QGraphicsItem* parent)
 : AbstractImageView(parent)
-, mSvgItem(new QGraphicsSvgItem(this))
+, mTileCache(new SvgTileCache(this))
 , mAlphaBackgroundMode(AbstractImageView::AlphaBackgroundCheckBoard)
 , mAlphaBackgroundColor(Qt::black)
 , mImageFullyLoaded(false)
 {
-    // At certain scales, the SVG can render outside its own bounds up to 1 pixel
-    // This clips it so it isn't drawn outside the background or over the selection rect
-    mSvgItem->setFlag(ItemClipsToShape);
-
-    // So we aren't unnecessarily drawing the background for every paint()
+    // So we aren't unnecessarily drawing the background and the tiles for
+    // every paint()
     setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
+    connect(mTileCache, &SvgTileCache::tileRendered, this, [this]() {
+        update();
+    });
 }
 
 void SvgImageView::loadFromDocument()
@@ -76,13 +77,15 @@ void SvgImageView::finishLoadFromDocument()
 {
     QSvgRenderer* renderer = document()->svgRenderer();
     GV_RETURN_IF_FAIL(renderer);
-    mSvgItem->setSharedRenderer(renderer);
+    // Tiles are rendered in worker threads, each with their own renderer
+    // created from the raw data
+    mTileCache->setSvgData(document()->rawData(), document()->size());
     if (zoomToFit()) {
         setZoom(computeZoomToFit(), QPointF(-1, -1), ForceUpdate);
     } else if (zoomToFill()) {
         setZoom(computeZoomToFill(), QPointF(-1, -1), ForceUpdate);
     } else {
-        mSvgItem->setScale(zoom());
+        update();
     }
     applyPendingScrollPos();
     emit completed();
@@ -91,23 +94,16 @@ void SvgImageView::finishLoadFromDocument()
 
 void SvgImageView::onZoomChanged()
 {
-    mSvgItem->setScale(zoom());
-    adjustItemPos();
+    update();
 }
 
 void SvgImageView::onImageOffsetChanged()
 {
-    adjustItemPos();
+    update();
 }
 
 void SvgImageView::onScrollPosChanged(const QPointF& /* oldPos */)
 {
-    adjustItemPos();
-}
-
-void SvgImageView::adjustItemPos()
-{
-    mSvgItem->setPos((imageOffset() - scrollPos()).toPoint());
     update();
 }
 
@@ -148,6 +144,9 @@ void SvgImageView::paint(QPainter* painter, const QStyleOptionGraphicsItem* /*op
 {
     if (mImageFullyLoaded) {
         drawAlphaBackground(painter);
+        const QPointF imageTopLeft = (imageOffset() - scrollPos()).toPoint();
+        const QRectF visibleRect(scrollPos(), visibleImageSize());
+        mTileCache->paint(painter, imageTopLeft, visibleRect, zoom(), devicePixelRatio());
     }
 }
 
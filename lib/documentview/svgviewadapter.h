@@ -32,11 +32,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <lib/documentview/abstractimageview.h>
 #include <lib/documentview/abstractdocumentviewadapter.h>
 
-class QGraphicsSvgItem;
-
 namespace Gwenview
 {
 
+class SvgTileCache;
+
 class SvgImageView : public AbstractImageView
 {
     Q_OBJECT
@@ -55,12 +55,11 @@ private Q_SLOTS:
     void finishLoadFromDocument();
 
 private:
-    QGraphicsSvgItem* mSvgItem;
+    SvgTileCache* mTileCache;
     AbstractImageView::AlphaBackgroundMode mAlphaBackgroundMode;
     QColor mAlphaBackgroundColor;
     bool mImageFullyLoaded;
 
-    void adjustItemPos();
     void drawAlphaBackground(QPainter* painter);
     void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
 };
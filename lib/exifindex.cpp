@@ -0,0 +1,370 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "exifindex.h"
+
+// STL
+#include <cstring>
+#include <limits>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QVector>
+#include "gwenview_lib_debug.h"
+
+// KDE
+
+// Local
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+static const char INDEX_MAGIC[4] = { 'G', 'V', 'E', 'I' };
+static const quint32 INDEX_VERSION = 1;
+static const int HEADER_SIZE = sizeof(INDEX_MAGIC) + sizeof(INDEX_VERSION);
+
+// New entries are written to disk when there are this many of them
+static const int FLUSH_THRESHOLD = 256;
+
+// When the index is rewritten, only the most recent entries are kept
+static const int MAX_ENTRY_COUNT = 200000;
+
+static const qint64 INVALID_TIME = std::numeric_limits<qint64>::min();
+
+/**
+ * On-disk layout of an entry. It is followed by pathLength bytes of
+ * encoded path. The index is a cache: it uses the native byte order.
+ */
+struct Record
+{
+    qint64 mtime;
+    qint64 fileSize;
+    qint64 dateTime;
+    qint32 width;
+    qint32 height;
+    quint16 orientation;
+    quint16 pathLength;
+    quint32 reserved;
+};
+
+Q_GLOBAL_STATIC_WITH_ARGS(ExifIndex, sInstance,
+    (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/exifindex")))
+
+/**
+ * Calls function(key, recordData) for each complete record of the size bytes
+ * at data. Returns the number of bytes these records take.
+ */
+template<typename Function>
+static qint64 forEachRecord(const uchar* data, qint64 size, Function function)
+{
+    qint64 pos = 0;
+    while (pos + qint64(sizeof(Record)) <= size) {
+        Record record;
+        memcpy(&record, data + pos, sizeof(Record));
+        const qint64 end = pos + sizeof(Record) + record.pathLength;
+        if (end > size) {
+            break;
+        }
+        const QByteArray key = QByteArray::fromRawData(reinterpret_cast<const char*>(data + pos + sizeof(Record)), record.pathLength);
+        function(key, data + pos);
+        pos = end;
+    }
+    return pos;
+}
+
+static void appendRecord(QByteArray* data, const QByteArray& key, const Record& record)
+{
+    data->append(reinterpret_cast<const char*>(&record), sizeof(Record));
+    data->append(key);
+}
+
+struct MappedRange
+{
+    const uchar* data;
+    qint64 size;
+};
+
+struct ExifIndexPrivate
+{
+    QString mIndexPath;
+    // Kept open for appending: appended records are then always in the
+    // mapped file, even if another process replaced it meanwhile
+    QFile mFile;
+    // The records of the file, then the ones appended since. Header excluded.
+    QVector<MappedRange> mMappedRanges;
+    // End of the last mapped range in the file
+    qint64 mMappedSize;
+    // Latest record of each path in the mapped file. Keys point to the map.
+    QHash<QByteArray, const uchar*> mMappedRecords;
+    // Records inserted since the last flush, or which could not be mapped
+    QHash<QByteArray, Record> mNewRecords;
+    // Keys of mNewRecords which have not been written yet
+    QSet<QByteArray> mPendingKeys;
+    bool mNeedsRewrite;
+    mutable QMutex mMutex;
+
+    void load()
+    {
+        mNeedsRewrite = true;
+        mMappedSize = 0;
+        if (!QFile::exists(mIndexPath)) {
+            return;
+        }
+        mFile.setFileName(mIndexPath);
+        if (!mFile.open(QIODevice::ReadWrite | QIODevice::Append | QIODevice::Unbuffered)) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not open" << mIndexPath;
+            return;
+        }
+        const qint64 fileSize = mFile.size();
+        if (fileSize < HEADER_SIZE) {
+            return;
+        }
+        const uchar* map = mFile.map(0, fileSize);
+        if (!map) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not map" << mIndexPath;
+            return;
+        }
+        quint32 version;
+        memcpy(&version, map + sizeof(INDEX_MAGIC), sizeof(version));
+        if (memcmp(map, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || version != INDEX_VERSION) {
+            LOG("Ignoring index with another format");
+            mFile.unmap(const_cast<uchar*>(map));
+            return;
+        }
+
+        int recordCount = 0;
+        const qint64 size = mapRange(map + HEADER_SIZE, fileSize - HEADER_SIZE, &recordCount);
+        mMappedSize = HEADER_SIZE + size;
+        LOG("Loaded" << mMappedRecords.size() << "entries from" << mIndexPath);
+
+        // Rewrite the file if it has been truncated, or if it contains too
+        // many outdated or old entries
+        mNeedsRewrite = mMappedSize != fileSize
+            || recordCount > 2 * mMappedRecords.size()
+            || mMappedRecords.size() > MAX_ENTRY_COUNT;
+    }
+
+    /**
+     * Indexes the records of a newly mapped range. They replace the records
+     * of mNewRecords with the same key, which have been written.
+     * Returns the number of bytes the records take.
+     */
+    qint64 mapRange(const uchar* data, qint64 size, int* recordCount = nullptr)
+    {
+        const qint64 mappedSize = forEachRecord(data, size, [this, recordCount](const QByteArray& key, const uchar* recordData) {
+            mMappedRecords.insert(key, recordData);
+            mNewRecords.remove(key);
+            if (recordCount) {
+                ++*recordCount;
+            }
+        });
+        MappedRange range;
+        range.data = data;
+        range.size = mappedSize;
+        mMappedRanges << range;
+        return mappedSize;
+    }
+
+    bool findRecord(const QByteArray& key, Record* record) const
+    {
+        const auto newIt = mNewRecords.constFind(key);
+        if (newIt != mNewRecords.constEnd()) {
+            *record = newIt.value();
+            return true;
+        }
+        const auto mappedIt = mMappedRecords.constFind(key);
+        if (mappedIt != mMappedRecords.constEnd()) {
+            memcpy(record, mappedIt.value(), sizeof(Record));
+            return true;
+        }
+        return false;
+    }
+
+    void append()
+    {
+        if (!mFile.isOpen() || mMappedRanges.isEmpty()) {
+            mNeedsRewrite = true;
+            return;
+        }
+        // Write the whole batch at once: with O_APPEND, records appended by
+        // other processes cannot end up in the middle of it
+        QByteArray data;
+        for (const QByteArray& key : qAsConst(mPendingKeys)) {
+            appendRecord(&data, key, mNewRecords.value(key));
+        }
+        if (mFile.write(data) != data.size()) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not write to" << mIndexPath;
+            return;
+        }
+        mPendingKeys.clear();
+
+        // Map what has been appended, so that the written records do not
+        // have to be kept in memory anymore
+        const qint64 fileSize = mFile.size();
+        const uchar* map = mFile.map(mMappedSize, fileSize - mMappedSize);
+        if (!map) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not map" << mIndexPath;
+            return;
+        }
+        mMappedSize += mapRange(map, fileSize - mMappedSize);
+    }
+
+    void rewrite()
+    {
+        QDir().mkpath(QFileInfo(mIndexPath).absolutePath());
+        QSaveFile file(mIndexPath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not open" << mIndexPath << "for writing";
+            return;
+        }
+        file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        file.write(reinterpret_cast<const char*>(&INDEX_VERSION), sizeof(INDEX_VERSION));
+
+        // Go through the mapped records in order, so that the oldest entries
+        // are the ones which get dropped
+        int toSkip = mMappedRecords.size() + mNewRecords.size() - MAX_ENTRY_COUNT;
+        for (auto it = mMappedRecords.constBegin(), end = mMappedRecords.constEnd(); it != end; ++it) {
+            if (mNewRecords.contains(it.key())) {
+                --toSkip;
+            }
+        }
+        QByteArray data;
+        for (const MappedRange& range : qAsConst(mMappedRanges)) {
+            forEachRecord(range.data, range.size, [this, &toSkip, &data](const QByteArray& key, const uchar* recordData) {
+                const bool latest = mMappedRecords.value(key) == recordData && !mNewRecords.contains(key);
+                if (!latest) {
+                    return;
+                }
+                if (toSkip > 0) {
+                    --toSkip;
+                    return;
+                }
+                Record record;
+                memcpy(&record, recordData, sizeof(Record));
+                appendRecord(&data, key, record);
+            });
+        }
+        for (auto it = mNewRecords.constBegin(), end = mNewRecords.constEnd(); it != end; ++it) {
+            appendRecord(&data, it.key(), it.value());
+        }
+        file.write(data);
+
+        if (!file.commit()) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Could not write" << mIndexPath;
+            return;
+        }
+
+        // Map the new file. The records of mNewRecords are part of it now.
+        mMappedRecords.clear();
+        mMappedRanges.clear();
+        mFile.close();
+        mNewRecords.clear();
+        mPendingKeys.clear();
+        load();
+    }
+};
+
+ExifIndex* ExifIndex::instance()
+{
+    return sInstance;
+}
+
+ExifIndex::ExifIndex(const QString& indexPath)
+: d(new ExifIndexPrivate)
+{
+    d->mIndexPath = indexPath;
+    d->load();
+}
+
+ExifIndex::~ExifIndex()
+{
+    flush();
+    delete d;
+}
+
+bool ExifIndex::find(const QString& path, const QDateTime& mtime, qint64 fileSize, Entry* entry) const
+{
+    QMutexLocker locker(&d->mMutex);
+    Record record;
+    if (!d->findRecord(QFile::encodeName(path), &record)) {
+        return false;
+    }
+    if (record.mtime != mtime.toMSecsSinceEpoch() || record.fileSize != fileSize) {
+        return false;
+    }
+    entry->dateTime = record.dateTime == INVALID_TIME ? QDateTime() : QDateTime::fromMSecsSinceEpoch(record.dateTime);
+    entry->size = QSize(record.width, record.height);
+    entry->orientation = Orientation(record.orientation);
+    return true;
+}
+
+void ExifIndex::insert(const QString& path, const QDateTime& mtime, qint64 fileSize, const Entry& entry)
+{
+    const QByteArray key = QFile::encodeName(path);
+    if (key.size() > std::numeric_limits<quint16>::max()) {
+        return;
+    }
+    Record record;
+    record.mtime = mtime.toMSecsSinceEpoch();
+    record.fileSize = fileSize;
+    record.dateTime = entry.dateTime.isValid() ? entry.dateTime.toMSecsSinceEpoch() : INVALID_TIME;
+    record.width = entry.size.width();
+    record.height = entry.size.height();
+    record.orientation = entry.orientation;
+    record.pathLength = key.size();
+    record.reserved = 0;
+
+    QMutexLocker locker(&d->mMutex);
+    d->mNewRecords.insert(key, record);
+    d->mPendingKeys.insert(key);
+    if (d->mPendingKeys.size() >= FLUSH_THRESHOLD) {
+        locker.unlock();
+        flush();
+    }
+}
+
+void ExifIndex::flush()
+{
+    QMutexLocker locker(&d->mMutex);
+    if (d->mNeedsRewrite) {
+        d->rewrite();
+    } else if (!d->mPendingKeys.isEmpty()) {
+        d->append();
+    }
+}
+
+} // namespace
@@ -0,0 +1,94 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef EXIFINDEX_H
+#define EXIFINDEX_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QDateTime>
+#include <QSize>
+
+// KDE
+
+// Local
+#include <lib/orientation.h>
+
+class QString;
+
+namespace Gwenview
+{
+
+struct ExifIndexPrivate;
+
+/**
+ * An on-disk index of the Exif information needed to sort and filter images
+ * by date, so that files do not have to be parsed again on each run.
+ *
+ * Entries are keyed by the path, modification time and size of a local
+ * file: an entry is ignored as soon as the file changes. The index file is
+ * memory-mapped when the index is created. New entries are appended to it
+ * in batches and when the index is destroyed, then mapped as well, so that
+ * they do not stay in memory. Each batch is written at once, several
+ * processes can append to the same file. The file is rewritten without
+ * outdated entries when they take too much space.
+ *
+ * All methods are thread-safe.
+ */
+class GWENVIEWLIB_EXPORT ExifIndex
+{
+public:
+    struct Entry
+    {
+        Entry()
+        : orientation(NOT_AVAILABLE)
+        {}
+
+        /// Capture date, invalid if the file has none
+        QDateTime dateTime;
+        QSize size;
+        Orientation orientation;
+    };
+
+    /**
+     * The index shared by the application, stored in the cache directory
+     */
+    static ExifIndex* instance();
+
+    explicit ExifIndex(const QString& indexPath);
+    ~ExifIndex();
+
+    bool find(const QString& path, const QDateTime& mtime, qint64 fileSize, Entry* entry) const;
+
+    void insert(const QString& path, const QDateTime& mtime, qint64 fileSize, const Entry& entry);
+
+    /**
+     * Writes new entries to the index file
+     */
+    void flush();
+
+private:
+    ExifIndexPrivate* const d;
+};
+
+} // namespace
+
+#endif /* EXIFINDEX_H */
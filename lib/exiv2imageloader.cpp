@@ -23,8 +23,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
 // Qt
 #include <QByteArray>
+#include <QCoreApplication>
 #include <QString>
 #include <QFile>
+#include <QSet>
 
 // KDE
 
@@ -41,8 +43,186 @@ struct Exiv2ImageLoaderPrivate
 {
     std::unique_ptr<Exiv2::Image> mImage;
     QString mErrorMessage;
+    // Exiv2 does not copy in-memory data, keep the header read by loadHeader()
+    // alive as long as the loader
+    QByteArray mHeaderData;
 };
 
+/**
+ * Headers bigger than this are not worth reading separately: load the whole
+ * file instead
+ */
+static const int MAX_HEADER_SIZE = 4 * 1024 * 1024;
+
+static const int MAX_TIFF_IFD_COUNT = 32;
+
+/**
+ * Reads the segments of a JPEG file up to the start of the scan data.
+ * Returns an empty array if the file is not a valid JPEG file or if the
+ * segments are too big.
+ */
+static QByteArray readJpegHeader(QFile* file)
+{
+    QByteArray data = file->read(2);
+    if (data != QByteArray("\xFF\xD8", 2)) {
+        return QByteArray();
+    }
+    for (;;) {
+        if (data.size() > MAX_HEADER_SIZE) {
+            return QByteArray();
+        }
+        char ch;
+        if (!file->getChar(&ch) || uchar(ch) != 0xFF) {
+            return QByteArray();
+        }
+        // Skip fill bytes
+        do {
+            if (!file->getChar(&ch)) {
+                return QByteArray();
+            }
+        } while (uchar(ch) == 0xFF);
+
+        const uchar marker = uchar(ch);
+        if (marker == 0xDA || marker == 0xD9) {
+            // SOS or EOI: no more metadata
+            break;
+        }
+        data.append('\xFF');
+        data.append(ch);
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            // TEM and RSTn have no payload
+            continue;
+        }
+        const QByteArray lengthBytes = file->read(2);
+        if (lengthBytes.size() != 2) {
+            return QByteArray();
+        }
+        const int length = (uchar(lengthBytes[0]) << 8) | uchar(lengthBytes[1]);
+        if (length < 2) {
+            return QByteArray();
+        }
+        const QByteArray payload = file->read(length - 2);
+        if (payload.size() != length - 2) {
+            return QByteArray();
+        }
+        data.append(lengthBytes);
+        data.append(payload);
+    }
+    // Exiv2 stops parsing at EOI, as it would at SOS
+    data.append("\xFF\xD9", 2);
+    return data;
+}
+
+/**
+ * Reads the leading part of a TIFF-based file (TIFF, DNG and most RAW
+ * formats), extended as needed to cover its IFDs and their values. Pixel data
+ * referenced by the IFDs is not read.
+ * Returns an empty array if the file is not TIFF-based or if the metadata
+ * is spread too far into the file.
+ */
+static QByteArray readTiffHeader(QFile* file)
+{
+    QByteArray data = file->read(8);
+    if (data.size() != 8) {
+        return QByteArray();
+    }
+    bool bigEndian;
+    if (data.startsWith("II")) {
+        bigEndian = false;
+    } else if (data.startsWith("MM")) {
+        bigEndian = true;
+    } else {
+        return QByteArray();
+    }
+
+    auto ensure = [file, &data](qint64 size) {
+        if (size > MAX_HEADER_SIZE) {
+            return false;
+        }
+        if (size > data.size()) {
+            data.append(file->read(size - data.size()));
+        }
+        return data.size() >= size;
+    };
+    auto readUShort = [&data, bigEndian](qint64 offset) -> quint32 {
+        const uchar* ptr = reinterpret_cast<const uchar*>(data.constData()) + offset;
+        return bigEndian ? (ptr[0] << 8) | ptr[1] : (ptr[1] << 8) | ptr[0];
+    };
+    auto readULong = [&data, bigEndian](qint64 offset) -> quint32 {
+        const uchar* ptr = reinterpret_cast<const uchar*>(data.constData()) + offset;
+        return bigEndian
+            ? (quint32(ptr[0]) << 24) | (ptr[1] << 16) | (ptr[2] << 8) | ptr[3]
+            : (quint32(ptr[3]) << 24) | (ptr[2] << 16) | (ptr[1] << 8) | ptr[0];
+    };
+    auto typeSize = [](quint32 type) -> qint64 {
+        switch (type) {
+        case 1: case 2: case 6: case 7: // (S)BYTE, ASCII, UNDEFINED
+            return 1;
+        case 3: case 8: // (S)SHORT
+            return 2;
+        case 4: case 9: case 11: case 13: // (S)LONG, FLOAT, IFD
+            return 4;
+        case 5: case 10: case 12: // (S)RATIONAL, DOUBLE
+            return 8;
+        default:
+            return 0;
+        }
+    };
+
+    // BigTIFF uses 64 bit offsets, let Exiv2 deal with it
+    if (readUShort(2) == 43) {
+        return QByteArray();
+    }
+
+    QList<quint32> pendingOffsets;
+    pendingOffsets << readULong(4);
+    QSet<quint32> visitedOffsets;
+    while (!pendingOffsets.isEmpty()) {
+        const quint32 offset = pendingOffsets.takeFirst();
+        if (offset == 0 || visitedOffsets.contains(offset)) {
+            continue;
+        }
+        if (visitedOffsets.size() == MAX_TIFF_IFD_COUNT) {
+            return QByteArray();
+        }
+        visitedOffsets << offset;
+
+        if (!ensure(qint64(offset) + 2)) {
+            return QByteArray();
+        }
+        const quint32 entryCount = readUShort(offset);
+        const qint64 entriesOffset = qint64(offset) + 2;
+        if (!ensure(entriesOffset + entryCount * 12 + 4)) {
+            return QByteArray();
+        }
+        for (quint32 idx = 0; idx < entryCount; ++idx) {
+            const qint64 entryOffset = entriesOffset + idx * 12;
+            const quint32 tag = readUShort(entryOffset);
+            const quint32 type = readUShort(entryOffset + 2);
+            const quint32 count = readULong(entryOffset + 4);
+            const qint64 size = typeSize(type) * count;
+            qint64 valueOffset = entryOffset + 8;
+            if (size > 4) {
+                valueOffset = readULong(entryOffset + 8);
+                if (!ensure(valueOffset + size)) {
+                    return QByteArray();
+                }
+            }
+            // Exif, GPS, Interoperability and SubIFDs pointers
+            if (tag == 0x8769 || tag == 0x8825 || tag == 0xA005 || tag == 0x014A) {
+                if (typeSize(type) != 4) {
+                    continue;
+                }
+                for (quint32 subIdx = 0; subIdx < count; ++subIdx) {
+                    pendingOffsets << readULong(valueOffset + subIdx * 4);
+                }
+            }
+        }
+        pendingOffsets << readULong(entriesOffset + entryCount * 12);
+    }
+    return data;
+}
+
 struct Exiv2LogHandler {
     static void handleMessage(int level, const char *message) {
         switch(level) {
@@ -106,6 +286,30 @@ bool Exiv2ImageLoader::load(const QByteArray& data)
     return true;
 }
 
+bool Exiv2ImageLoader::loadHeader(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->mErrorMessage = file.errorString();
+        return false;
+    }
+    QByteArray header = readJpegHeader(&file);
+    if (header.isEmpty()) {
+        file.seek(0);
+        header = readTiffHeader(&file);
+    }
+    if (header.isEmpty()) {
+        file.close();
+        return load(filePath);
+    }
+    d->mHeaderData = header;
+    if (!load(d->mHeaderData)) {
+        // Be safe: the header may have been misinterpreted
+        return load(filePath);
+    }
+    return true;
+}
+
 QString Exiv2ImageLoader::errorMessage() const
 {
     return d->mErrorMessage;
@@ -117,3 +321,15 @@ std::unique_ptr<Exiv2::Image> Exiv2ImageLoader::popImage()
 }
 
 } // namespace
+
+/**
+ * Exiv2 initializes its XMP parser the first time XMP data is read, and this
+ * initialization is not thread-safe. Metadata is read from worker threads,
+ * for example by SortedDirModel when sorting by date: initialize the parser
+ * from the main thread as soon as the application starts.
+ */
+static void initializeXmpParser()
+{
+    Exiv2::XmpParser::initialize();
+}
+Q_COREAPP_STARTUP_FUNCTION(initializeXmpParser)
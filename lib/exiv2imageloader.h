@@ -58,6 +58,17 @@ public:
 
     bool load(const QString&);
     bool load(const QByteArray&);
+
+    /**
+     * Loads the metadata of @p filePath, reading only the leading part of the
+     * file: the segments before the scan data for JPEG files, the IFDs and
+     * their values for TIFF-based files. Other formats, or files whose
+     * metadata is not near the start, are loaded with load(const QString&).
+     *
+     * The returned image does not have access to the pixel data, so it must
+     * only be used to read metadata.
+     */
+    bool loadHeader(const QString& filePath);
     QString errorMessage() const;
     std::unique_ptr<Exiv2::Image> popImage();
 
@@ -0,0 +1,223 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Self
+#include "filenameindex.h"
+
+// Qt
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
+
+// KDE
+
+// Local
+
+namespace Gwenview
+{
+
+typedef QSet<const void*> NodeSet;
+
+static quint64 trigramAt(const QString& text, int pos)
+{
+    return (quint64(text.at(pos).unicode()) << 32)
+        | (quint64(text.at(pos + 1).unicode()) << 16)
+        | quint64(text.at(pos + 2).unicode());
+}
+
+struct FileNameIndexPrivate
+{
+    QAbstractItemModel* mModel;
+    // Case-folded names of the items
+    QHash<const void*, QString> mNames;
+    QHash<quint64, NodeSet> mNodesForTrigram;
+    // Case-folded text, and the items whose name contains it
+    QString mText;
+    NodeSet mMatches;
+
+    static QString foldedName(const QModelIndex& index)
+    {
+        return index.data().toString().toCaseFolded();
+    }
+
+    void addNode(const void* node, const QString& name)
+    {
+        removeNode(node);
+        mNames.insert(node, name);
+        for (int pos = 0; pos + 3 <= name.size(); ++pos) {
+            mNodesForTrigram[trigramAt(name, pos)].insert(node);
+        }
+        if (!mText.isEmpty() && name.contains(mText)) {
+            mMatches.insert(node);
+        }
+    }
+
+    void removeNode(const void* node)
+    {
+        auto it = mNames.find(node);
+        if (it == mNames.end()) {
+            return;
+        }
+        const QString& name = it.value();
+        for (int pos = 0; pos + 3 <= name.size(); ++pos) {
+            auto nodesIt = mNodesForTrigram.find(trigramAt(name, pos));
+            if (nodesIt == mNodesForTrigram.end()) {
+                continue;
+            }
+            nodesIt->remove(node);
+            if (nodesIt->isEmpty()) {
+                mNodesForTrigram.erase(nodesIt);
+            }
+        }
+        mNames.erase(it);
+        mMatches.remove(node);
+    }
+
+    void addRows(const QModelIndex& parent, int start, int end)
+    {
+        for (int row = start; row <= end; ++row) {
+            const QModelIndex index = mModel->index(row, 0, parent);
+            addNode(index.internalPointer(), foldedName(index));
+        }
+    }
+
+    /**
+     * Returns the items whose name contains @p text. If @p candidates is not
+     * null, only those items are checked.
+     */
+    NodeSet findMatches(const QString& text, const NodeSet* candidates) const
+    {
+        NodeSet matches;
+        if (!candidates && text.size() >= 3) {
+            // Only check the items sharing the least common trigram of text
+            for (int pos = 0; pos + 3 <= text.size(); ++pos) {
+                auto it = mNodesForTrigram.constFind(trigramAt(text, pos));
+                if (it == mNodesForTrigram.constEnd()) {
+                    return matches;
+                }
+                if (!candidates || it->size() < candidates->size()) {
+                    candidates = &it.value();
+                }
+            }
+        }
+        if (candidates) {
+            for (const void* node : *candidates) {
+                if (mNames.value(node).contains(text)) {
+                    matches.insert(node);
+                }
+            }
+        } else {
+            for (auto it = mNames.constBegin(), end = mNames.constEnd(); it != end; ++it) {
+                if (it.value().contains(text)) {
+                    matches.insert(it.key());
+                }
+            }
+        }
+        return matches;
+    }
+};
+
+FileNameIndex::FileNameIndex(QAbstractItemModel* model, QObject* parent)
+: QObject(parent)
+, d(new FileNameIndexPrivate)
+{
+    d->mModel = model;
+    connect(model, &QAbstractItemModel::rowsInserted, this, &FileNameIndex::slotRowsInserted);
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &FileNameIndex::slotRowsAboutToBeRemoved);
+    connect(model, &QAbstractItemModel::dataChanged, this, &FileNameIndex::slotDataChanged);
+    connect(model, &QAbstractItemModel::modelReset, this, &FileNameIndex::slotModelReset);
+    slotModelReset();
+}
+
+FileNameIndex::~FileNameIndex()
+{
+    delete d;
+}
+
+bool FileNameIndex::setText(const QString& text)
+{
+    const QString foldedText = text.toCaseFolded();
+    if (foldedText == d->mText) {
+        return false;
+    }
+    NodeSet matches;
+    if (!foldedText.isEmpty()) {
+        // Typing more characters narrows the previous matches
+        const bool narrowing = !d->mText.isEmpty() && foldedText.contains(d->mText);
+        matches = d->findMatches(foldedText, narrowing ? &d->mMatches : nullptr);
+    }
+    const bool changed = foldedText.isEmpty() != d->mText.isEmpty() || matches != d->mMatches;
+    d->mText = foldedText;
+    d->mMatches = matches;
+    return changed;
+}
+
+bool FileNameIndex::matches(const QModelIndex& index) const
+{
+    if (d->mText.isEmpty()) {
+        return true;
+    }
+    const void* node = index.internalPointer();
+    if (d->mNames.contains(node)) {
+        return d->mMatches.contains(node);
+    }
+    // Proxy models may look at new rows before we are notified about them
+    return FileNameIndexPrivate::foldedName(index).contains(d->mText);
+}
+
+void FileNameIndex::slotRowsInserted(const QModelIndex& parent, int start, int end)
+{
+    d->addRows(parent, start, end);
+}
+
+void FileNameIndex::slotRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end)
+{
+    for (int row = start; row <= end; ++row) {
+        d->removeNode(d->mModel->index(row, 0, parent).internalPointer());
+    }
+}
+
+void FileNameIndex::slotDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    if (topLeft.column() > 0) {
+        return;
+    }
+    // Items may have been renamed
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex index = d->mModel->index(row, 0, topLeft.parent());
+        const QString name = FileNameIndexPrivate::foldedName(index);
+        if (d->mNames.value(index.internalPointer()) != name) {
+            d->addNode(index.internalPointer(), name);
+        }
+    }
+}
+
+void FileNameIndex::slotModelReset()
+{
+    d->mNames.clear();
+    d->mNodesForTrigram.clear();
+    d->mMatches.clear();
+    const int count = d->mModel->rowCount();
+    if (count > 0) {
+        d->addRows(QModelIndex(), 0, count - 1);
+    }
+}
+
+} // namespace
@@ -0,0 +1,81 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef FILENAMEINDEX_H
+#define FILENAMEINDEX_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QObject>
+
+// KDE
+
+// Local
+
+class QAbstractItemModel;
+class QModelIndex;
+
+namespace Gwenview
+{
+
+struct FileNameIndexPrivate;
+
+/**
+ * Indexes the names of the items of a KDirModel by trigrams, to quickly find
+ * the items whose name contains a text. The index follows the changes of the
+ * model.
+ *
+ * Items are identified by the internal pointer of their index, which is
+ * stable for KDirModel items but not for all models.
+ */
+class GWENVIEWLIB_EXPORT FileNameIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileNameIndex(QAbstractItemModel* model, QObject* parent = nullptr);
+    ~FileNameIndex() override;
+
+    /**
+     * Defines the text names must contain, case insensitively. If the new
+     * text contains the previous one, only the previous matches are checked.
+     * Returns true if the set of matching items changed.
+     */
+    bool setText(const QString& text);
+
+    /**
+     * Returns true if the name of @p index contains the text. Always true
+     * when the text is empty.
+     */
+    bool matches(const QModelIndex& index) const;
+
+private Q_SLOTS:
+    void slotRowsInserted(const QModelIndex& parent, int start, int end);
+    void slotRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+    void slotDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void slotModelReset();
+
+private:
+    FileNameIndexPrivate* const d;
+};
+
+} // namespace
+
+#endif /* FILENAMEINDEX_H */
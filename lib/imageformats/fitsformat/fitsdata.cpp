@@ -22,6 +22,8 @@ Gwenview: an image viewer
 
 #include "fitsdata.h"
 
+#include "pixelkernels.h"
+
 #include <QApplication>
 #include <QImage>
 
@@ -576,45 +578,41 @@ QString FITSData::getLastError() const
 template <typename T>
 void FITSData::convertToQImage(double dataMin, double dataMax, double scale, double zero, QImage &image)
 {
-    T *buffer = (T*)getImageBuffer();
+    const T *buffer = (T*)getImageBuffer();
     const T limit   = std::numeric_limits<T>::max();
-    T bMin    = dataMin < 0 ? 0 : dataMin;
-    T bMax    = dataMax > limit ? limit : dataMax;
-    uint16_t w    = getWidth();
-    uint16_t h    = getHeight();
-    uint32_t size = getSize();
-    double val;
+    const T bMin    = dataMin < 0 ? 0 : dataMin;
+    const T bMax    = dataMax > limit ? limit : dataMax;
+    const uint16_t w    = getWidth();
+    const uint32_t size = getSize();
+
+    // Linear scale, clamped to the 0-255 range. Kept inline so that the
+    // loops below can be vectorized.
+    auto toByte = [bMin, bMax, scale, zero](T sample) {
+        const double val = double(qBound(bMin, sample, bMax)) * scale + zero;
+        return int(qBound(0., val, 255.));
+    };
 
     if (getNumOfChannels() == 1) {
-        /* Fill in pixel values using indexed map, linear scale */
-        for (int j = 0; j < h; j++) {
-            unsigned char *scanLine = image.scanLine(j);
-
-            for (int i = 0; i < w; i++) {
-                val         = qBound(bMin, buffer[j * w + i], bMax);
-                val         = val * scale + zero;
-                scanLine[i] = qBound<unsigned char>(0, (unsigned char)val, 255);
+        /* Fill in pixel values using indexed map */
+        Gwenview::PixelKernels::forEachRow(&image, image.rect(), [&](uchar *scanLine, int, int j, int width) {
+            const T *src = buffer + j * w;
+            for (int i = 0; i < width; i++) {
+                scanLine[i] = toByte(src[i]);
             }
-        }
+        });
     }
     else
     {
-        double rval = 0, gval = 0, bval = 0;
-        QRgb value;
-        /* Fill in pixel values using indexed map, linear scale */
-        for (int j = 0; j < h; j++) {
-            QRgb *scanLine = reinterpret_cast<QRgb *>((image.scanLine(j)));
-
-            for (int i = 0; i < w; i++) {
-                rval = qBound(bMin, buffer[j * w + i], bMax);
-                gval = qBound(bMin, buffer[j * w + i + size], bMax);
-                bval = qBound(bMin, buffer[j * w + i + size * 2], bMax);
-
-                value = qRgb(rval * scale + zero, gval * scale + zero, bval * scale + zero);
-
-                scanLine[i] = value;
+        /* Fill in pixel values from the planar channels */
+        Gwenview::PixelKernels::forEachRow(&image, image.rect(), [&](uchar *line, int, int j, int width) {
+            QRgb *scanLine = reinterpret_cast<QRgb *>(line);
+            const T *rSrc = buffer + j * w;
+            const T *gSrc = rSrc + size;
+            const T *bSrc = rSrc + size * 2;
+            for (int i = 0; i < width; i++) {
+                scanLine[i] = qRgb(toByte(rSrc[i]), toByte(gSrc[i]), toByte(bSrc[i]));
             }
-        }
+        });
     }
 }
 
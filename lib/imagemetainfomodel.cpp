@@ -23,9 +23,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "config-gwenview.h"
 
 // Qt
+#include <QFutureWatcher>
+#include <QSet>
 #include <QSize>
 #include "gwenview_lib_debug.h"
 #include <QLocale>
+#include <QtConcurrentRun>
 
 // KDE
 #include <KFileItem>
@@ -196,10 +199,69 @@ private:
     QString mLabel;
 };
 
+typedef QList<MetaInfoGroup::Entry> EntryList;
+
+/**
+ * Formats the entries of an Exiv2 container. If @p onlyKey is not empty, only
+ * the entries with this key are formatted.
+ * This is called from worker threads, so it must not touch the model.
+ */
+template <class Container>
+static EntryList formatExivData(const Container& container, const QString& onlyKey)
+{
+    // key aren't always unique (for example, "Iptc.Application2.Keywords"
+    // may appear multiple times): values of such keys are merged in one entry
+    EntryList list;
+    QHash<QString, int> indexForKey;
+    const std::string onlyKeyString = onlyKey.toStdString();
+
+    for (auto it = container.begin(), end = container.end(); it != end; ++it) {
+        try {
+            if (!onlyKeyString.empty() && it->key() != onlyKeyString) {
+                continue;
+            }
+            // Skip metadatum if its tag is an hex number
+            if (it->tagName().substr(0, 2) == "0x") {
+                continue;
+            }
+            QString key = QString::fromUtf8(it->key().c_str());
+            QString label = QString::fromLocal8Bit(it->tagLabel().c_str());
+            std::ostringstream stream;
+            stream << *it;
+            QString value = QString::fromLocal8Bit(stream.str().c_str());
+
+            auto indexIt = indexForKey.constFind(key);
+            if (indexIt != indexForKey.constEnd()) {
+                list[indexIt.value()].appendValue(value);
+            } else {
+                indexForKey.insert(key, list.size());
+                list << MetaInfoGroup::Entry(key, label, value);
+            }
+        } catch (const Exiv2::Error& error) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Failed to read some meta info:" << error.what();
+        }
+    }
+    return list;
+}
+
 struct ImageMetaInfoModelPrivate
 {
     QVector<MetaInfoGroup*> mMetaInfoGroupVector;
     ImageMetaInfoModel* q;
+    // Copies of the metadata of the image: the image belongs to the Document,
+    // which may delete it at any time
+    Exiv2::ExifData mExifData;
+    Exiv2::IptcData mIptcData;
+    Exiv2::XmpData mXmpData;
+    // Exiv2 groups which have not been filled from the metadata yet
+    QSet<int> mPendingGroups;
+    // Pending groups being formatted in a worker thread
+    QSet<int> mLoadingGroups;
+    // Groups a view fetched: they are filled as soon as an image is set,
+    // since the view won't fetch them a second time
+    QSet<int> mRequestedGroups;
+    // Incremented when the image changes, to drop outdated results
+    int mGeneration = 0;
 
     void clearGroup(MetaInfoGroup* group, const QModelIndex& parent)
     {
@@ -253,54 +315,71 @@ struct ImageMetaInfoModelPrivate
         group->addEntry(QStringLiteral("General.Size"), i18nc("@item:intable", "File Size"), QString());
         group->addEntry(QStringLiteral("General.Time"), i18nc("@item:intable", "File Time"), QString());
         group->addEntry(QStringLiteral("General.ImageSize"), i18nc("@item:intable", "Image Size"), QString());
+        group->addEntry(QStringLiteral("General.FrameCount"), i18nc("@item:intable Number of frames of an animated image", "Frames"), QString());
+        group->addEntry(QStringLiteral("General.Duration"), i18nc("@item:intable Duration of an animated image", "Duration"), QString());
         group->addEntry(QStringLiteral("General.Comment"), i18nc("@item:intable", "Comment"), QString());
     }
 
-    template <class Container, class Iterator>
-    void fillExivGroup(const QModelIndex& parent, MetaInfoGroup* group, const Container& container)
+    EntryList formatGroupEntries(int groupRow, const QString& onlyKey) const
     {
-        // key aren't always unique (for example, "Iptc.Application2.Keywords"
-        // may appear multiple times) so we can't know how many rows we will
-        // insert before going through them. That's why we create a hash
-        // before.
-        typedef QHash<QString, MetaInfoGroup::Entry*> EntryHash;
-        EntryHash hash;
-
-        Iterator
-        it = container.begin(),
-        end = container.end();
-
-        for (; it != end; ++it) {
-            try {
-                // Skip metadatum if its tag is an hex number
-                if (it->tagName().substr(0, 2) == "0x") {
-                    continue;
-                }
-                QString key = QString::fromUtf8(it->key().c_str());
-                QString label = QString::fromLocal8Bit(it->tagLabel().c_str());
-                std::ostringstream stream;
-                stream << *it;
-                QString value = QString::fromLocal8Bit(stream.str().c_str());
-
-                EntryHash::iterator hashIt = hash.find(key);
-                if (hashIt != hash.end()) {
-                    hashIt.value()->appendValue(value);
-                } else {
-                    hash.insert(key, new MetaInfoGroup::Entry(key, label, value));
-                }
-            } catch (const Exiv2::Error& error) {
-                qCWarning(GWENVIEW_LIB_LOG) << "Failed to read some meta info:" << error.what();
-            }
+        switch (groupRow) {
+        case ExifGroup:
+            return formatExivData(mExifData, onlyKey);
+        case IptcGroup:
+            return formatExivData(mIptcData, onlyKey);
+        case XmpGroup:
+            return formatExivData(mXmpData, onlyKey);
+        default:
+            return EntryList();
         }
+    }
 
-        if (hash.isEmpty()) {
+    void fillGroup(int groupRow)
+    {
+        if (!mPendingGroups.contains(groupRow) || mLoadingGroups.contains(groupRow)) {
             return;
         }
-        q->beginInsertRows(parent, 0, hash.size() - 1);
-        for (MetaInfoGroup::Entry * entry : qAsConst(hash)) {
-            group->addEntry(entry);
+        mLoadingGroups << groupRow;
+
+        // Format copies of the data: the image may be replaced before the
+        // worker is done with it
+        const QString allKeys;
+        QFuture<EntryList> future;
+        switch (groupRow) {
+        case ExifGroup:
+            future = QtConcurrent::run(&formatExivData<Exiv2::ExifData>, mExifData, allKeys);
+            break;
+        case IptcGroup:
+            future = QtConcurrent::run(&formatExivData<Exiv2::IptcData>, mIptcData, allKeys);
+            break;
+        case XmpGroup:
+            future = QtConcurrent::run(&formatExivData<Exiv2::XmpData>, mXmpData, allKeys);
+            break;
+        default:
+            Q_UNREACHABLE();
         }
-        q->endInsertRows();
+
+        QFutureWatcher<EntryList>* watcher = new QFutureWatcher<EntryList>(q);
+        const int generation = mGeneration;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, q, [this, watcher, groupRow, generation]() {
+            watcher->deleteLater();
+            if (generation != mGeneration) {
+                return;
+            }
+            mLoadingGroups.remove(groupRow);
+            mPendingGroups.remove(groupRow);
+            const EntryList list = watcher->result();
+            if (list.isEmpty()) {
+                return;
+            }
+            MetaInfoGroup* group = mMetaInfoGroupVector[groupRow];
+            q->beginInsertRows(q->index(groupRow, 0), 0, list.size() - 1);
+            for (const MetaInfoGroup::Entry& entry : list) {
+                group->addEntry(new MetaInfoGroup::Entry(entry));
+            }
+            q->endInsertRows();
+        });
+        watcher->setFuture(future);
     }
 };
 
@@ -419,17 +498,31 @@ void ImageMetaInfoModel::setImageSize(const QSize& size)
     d->setGroupEntryValue(GeneralGroup, QStringLiteral("General.ImageSize"), imageSize);
 }
 
+void ImageMetaInfoModel::setAnimationInfo(int frameCount, int duration)
+{
+    QString frameCountString;
+    QString durationString;
+    if (frameCount > 1) {
+        frameCountString = QString::number(frameCount);
+        durationString = i18nc(
+                             "@item:intable %1 is a duration in seconds",
+                             "%1 s", QString::number(duration / 1000., 'f', 2));
+    }
+    d->setGroupEntryValue(GeneralGroup, QStringLiteral("General.FrameCount"), frameCountString);
+    d->setGroupEntryValue(GeneralGroup, QStringLiteral("General.Duration"), durationString);
+}
+
 void ImageMetaInfoModel::setExiv2Image(const Exiv2::Image* image)
 {
-    MetaInfoGroup* exifGroup = d->mMetaInfoGroupVector[ExifGroup];
-    MetaInfoGroup* iptcGroup = d->mMetaInfoGroupVector[IptcGroup];
-    MetaInfoGroup* xmpGroup  = d->mMetaInfoGroupVector[XmpGroup];
-    QModelIndex exifIndex = index(ExifGroup, 0);
-    QModelIndex iptcIndex = index(IptcGroup, 0);
-    QModelIndex xmpIndex  = index(XmpGroup, 0);
-    d->clearGroup(exifGroup, exifIndex);
-    d->clearGroup(iptcGroup, iptcIndex);
-    d->clearGroup(xmpGroup,  xmpIndex);
+    ++d->mGeneration;
+    d->mPendingGroups.clear();
+    d->mLoadingGroups.clear();
+    d->clearGroup(d->mMetaInfoGroupVector[ExifGroup], index(ExifGroup, 0));
+    d->clearGroup(d->mMetaInfoGroupVector[IptcGroup], index(IptcGroup, 0));
+    d->clearGroup(d->mMetaInfoGroupVector[XmpGroup], index(XmpGroup, 0));
+    d->mExifData.clear();
+    d->mIptcData.clear();
+    d->mXmpData.clear();
 
     if (!image) {
         return;
@@ -438,41 +531,52 @@ void ImageMetaInfoModel::setExiv2Image(const Exiv2::Image* image)
     d->setGroupEntryValue(GeneralGroup, QStringLiteral("General.Comment"), QString::fromUtf8(image->comment().c_str()));
 
     if (image->checkMode(Exiv2::mdExif) & Exiv2::amRead) {
-        const Exiv2::ExifData& exifData = image->exifData();
-        d->fillExivGroup<Exiv2::ExifData, Exiv2::ExifData::const_iterator>(exifIndex, exifGroup, exifData);
+        d->mExifData = image->exifData();
+        d->mPendingGroups << ExifGroup;
     }
-
     if (image->checkMode(Exiv2::mdIptc) & Exiv2::amRead) {
-        const Exiv2::IptcData& iptcData = image->iptcData();
-        d->fillExivGroup<Exiv2::IptcData, Exiv2::IptcData::const_iterator>(iptcIndex, iptcGroup, iptcData);
+        d->mIptcData = image->iptcData();
+        d->mPendingGroups << IptcGroup;
     }
-
     if (image->checkMode(Exiv2::mdXmp) & Exiv2::amRead) {
-        const Exiv2::XmpData& xmpData = image->xmpData();
-        d->fillExivGroup<Exiv2::XmpData, Exiv2::XmpData::const_iterator>(xmpIndex, xmpGroup, xmpData);
+        d->mXmpData = image->xmpData();
+        d->mPendingGroups << XmpGroup;
+    }
+    for (int groupRow : qAsConst(d->mRequestedGroups)) {
+        d->fillGroup(groupRow);
     }
 }
 
 void ImageMetaInfoModel::getInfoForKey(const QString& key, QString* label, QString* value) const
 {
-    MetaInfoGroup* group;
+    GroupRow groupRow;
     if (key.startsWith(QLatin1String("General"))) {
-        group = d->mMetaInfoGroupVector[GeneralGroup];
+        groupRow = GeneralGroup;
     } else if (key.startsWith(QLatin1String("Exif"))) {
-        group = d->mMetaInfoGroupVector[ExifGroup];
+        groupRow = ExifGroup;
 #ifdef HAVE_FITS
     } else if (key.startsWith(QLatin1String("Fits"))) {
-        group = d->mMetaInfoGroupVector[FitsGroup];
+        groupRow = FitsGroup;
 #endif
     } else if (key.startsWith(QLatin1String("Iptc"))) {
-        group = d->mMetaInfoGroupVector[IptcGroup];
+        groupRow = IptcGroup;
     } else if (key.startsWith(QLatin1String("Xmp"))) {
-        group = d->mMetaInfoGroupVector[XmpGroup];
+        groupRow = XmpGroup;
     } else {
         qCWarning(GWENVIEW_LIB_LOG) << "Unknown metainfo key" << key;
         return;
     }
-    group->getInfoForKey(key, label, value);
+
+    if (d->mPendingGroups.contains(groupRow)) {
+        // Do not wait for the whole group, only format the requested entry
+        const EntryList list = d->formatGroupEntries(groupRow, key);
+        if (!list.isEmpty()) {
+            *label = list.first().label();
+            *value = list.first().value();
+        }
+        return;
+    }
+    d->mMetaInfoGroupVector[groupRow]->getInfoForKey(key, label, value);
 }
 
 QString ImageMetaInfoModel::getValueForKey(const QString& key) const
@@ -535,6 +639,37 @@ int ImageMetaInfoModel::rowCount(const QModelIndex& parent) const
     }
 }
 
+bool ImageMetaInfoModel::hasChildren(const QModelIndex& parent) const
+{
+    // Views only fetch the entries of groups which have children
+    if (parent.isValid() && parent.internalId() == NoGroup && d->mPendingGroups.contains(parent.row())) {
+        return true;
+    }
+    return QAbstractItemModel::hasChildren(parent);
+}
+
+bool ImageMetaInfoModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid() || parent.internalId() != NoGroup) {
+        return false;
+    }
+    const int row = parent.row();
+    if (row != ExifGroup && row != IptcGroup && row != XmpGroup) {
+        return false;
+    }
+    // Once fetched, a group is filled every time the image changes
+    return !d->mRequestedGroups.contains(row);
+}
+
+void ImageMetaInfoModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    d->mRequestedGroups << parent.row();
+    d->fillGroup(parent.row());
+}
+
 int ImageMetaInfoModel::columnCount(const QModelIndex& /*parent*/) const
 {
     return 2;
@@ -50,7 +50,17 @@ public:
 
     void setUrl(const QUrl&);
     void setImageSize(const QSize&);
+    /**
+     * The metadata of the image is copied, the image can be deleted once this
+     * returns.
+     */
     void setExiv2Image(const Exiv2::Image*);
+    /**
+     * Fills the frame count and duration entries. Pass a frameCount of 0 or 1
+     * to clear them for still images.
+     * @param duration total duration of the animation, in milliseconds
+     */
+    void setAnimationInfo(int frameCount, int duration);
 
     QString keyForIndex(const QModelIndex&) const;
     void getInfoForKey(const QString& key, QString* label, QString* value) const;
@@ -63,6 +73,16 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     QVariant data(const QModelIndex&, int role = Qt::DisplayRole) const override;
 
+    /**
+     * EXIF, IPTC and XMP groups are empty until a view fetches them: their
+     * entries are then formatted in a worker thread, for the current image
+     * and the next ones. getInfoForKey() does not need the groups to be
+     * fetched. Groups which have not been filled yet have children.
+     */
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
 private:
     ImageMetaInfoModelPrivate* const d;
     friend struct ImageMetaInfoModelPrivate;
@@ -29,6 +29,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 // Local
 #include <lib/document/document.h>
+#include <lib/document/editchain.h>
+#include <lib/documentview/renderscheduler.h>
 #include <lib/paintutils.h>
 
 #undef ENABLE_LOG
@@ -59,12 +61,148 @@ static inline QRect scaledRect(const QRect& rect, qreal factor)
     return scaledRect(QRectF(rect), factor).toAlignedRect();
 }
 
+/**
+ * Everything needed to scale a rect, so that scaling can happen outside of
+ * the GUI thread
+ */
+struct ScaleTask
+{
+    QRect mRect;
+    QImage mImage;
+    // Edits to apply to mImage, see Document::edits()
+    EditChain mEdits;
+    qreal mZoom;
+    qreal mDpr;
+    bool mCopyOnly;
+    Qt::TransformationMode mTransformationMode;
+
+    RenderScheduler::Tile run() const;
+    RenderScheduler::Tile runEdited() const;
+};
+
+/**
+ * Renders the tile from the source image and only edits the result: edits
+ * then only work on the visible part of the image, at the zoom it is shown
+ * at.
+ */
+RenderScheduler::Tile ScaleTask::runEdited() const
+{
+    // Variables prefixed with dp are in device pixels
+    const QSize dpZoomedSize = (QSizeF(mImage.size()) * mZoom).toSize();
+    const QRect dpSourceRect = mEdits.sourceRect(Gwenview::scaledRect(mRect, mDpr), dpZoomedSize);
+    if (dpSourceRect.isEmpty()) {
+        return RenderScheduler::Tile();
+    }
+
+    ScaleTask task = *this;
+    task.mEdits = EditChain();
+    task.mRect = Gwenview::scaledRect(dpSourceRect, 1.0 / mDpr);
+    RenderScheduler::Tile tile = task.run();
+    if (tile.image.isNull()) {
+        return tile;
+    }
+
+    QRect dpRect(tile.topLeft * mDpr, tile.image.size());
+    tile.image = mEdits.apply(tile.image, &dpRect, dpZoomedSize);
+    tile.image.setDevicePixelRatio(mDpr);
+    tile.topLeft = dpRect.topLeft() / mDpr;
+    return tile;
+}
+
+RenderScheduler::Tile ScaleTask::run() const
+{
+    if (!mEdits.isEmpty()) {
+        return runEdited();
+    }
+
+    const qreal dpr = mDpr;
+    const qreal zoom = mZoom;
+    const QRect& rect = mRect;
+    const QImage& image = mImage;
+    RenderScheduler::Tile tile;
+
+    if (mCopyOnly) {
+        // variables prefixed with dp are in device pixels
+        const QRect dpRect = Gwenview::scaledRect(rect, dpr);
+        tile.topLeft = rect.topLeft();
+        tile.image = image.copy(dpRect);
+        tile.image.setDevicePixelRatio(dpr);
+        return tile;
+    }
+
+    const QRect imageRect = Gwenview::scaledRect(image.rect(), 1.0 / dpr);
+
+    // If rect contains "half" pixels, make sure sourceRect includes them
+    QRectF sourceRectF = Gwenview::scaledRect(QRectF(rect), 1.0 / zoom);
+
+    sourceRectF = sourceRectF.intersected(imageRect);
+    QRect sourceRect = sourceRectF.toAlignedRect();
+    if (sourceRect.isEmpty()) {
+        return tile;
+    }
+
+    // Compute smooth margin
+    bool needsSmoothMargins = mTransformationMode == Qt::SmoothTransformation;
+
+    int sourceLeftMargin, sourceRightMargin, sourceTopMargin, sourceBottomMargin;
+    int destLeftMargin, destRightMargin, destTopMargin, destBottomMargin;
+    if (needsSmoothMargins) {
+        sourceLeftMargin = qMin(sourceRect.left(), SMOOTH_MARGIN);
+        sourceTopMargin = qMin(sourceRect.top(), SMOOTH_MARGIN);
+        sourceRightMargin = qMin(imageRect.right() - sourceRect.right(), SMOOTH_MARGIN);
+        sourceBottomMargin = qMin(imageRect.bottom() - sourceRect.bottom(), SMOOTH_MARGIN);
+        sourceRect.adjust(
+            -sourceLeftMargin,
+            -sourceTopMargin,
+            sourceRightMargin,
+            sourceBottomMargin);
+        destLeftMargin = int(sourceLeftMargin * zoom);
+        destTopMargin = int(sourceTopMargin * zoom);
+        destRightMargin = int(sourceRightMargin * zoom);
+        destBottomMargin = int(sourceBottomMargin * zoom);
+    } else {
+        sourceLeftMargin = sourceRightMargin = sourceTopMargin = sourceBottomMargin = 0;
+        destLeftMargin = destRightMargin = destTopMargin = destBottomMargin = 0;
+    }
+
+    // destRect is almost like rect, but it contains only "full" pixels
+    QRect destRect = Gwenview::scaledRect(sourceRect, zoom);
+
+    QRect dpSourceRect = Gwenview::scaledRect(sourceRect, dpr);
+    QRect dpDestRect = Gwenview::scaledRect(dpSourceRect, zoom);
+
+    QImage tmp;
+    tmp = image.copy(dpSourceRect);
+    tmp = tmp.scaled(
+              dpDestRect.width(),
+              dpDestRect.height(),
+              Qt::IgnoreAspectRatio, // Do not use KeepAspectRatio, it can lead to skipped rows or columns
+              mTransformationMode);
+
+    if (needsSmoothMargins) {
+        tmp = tmp.copy(
+                  destLeftMargin * dpr, destTopMargin * dpr,
+                  dpDestRect.width() - (destLeftMargin + destRightMargin) * dpr,
+                  dpDestRect.height() - (destTopMargin + destBottomMargin) * dpr
+              );
+    }
+
+    tmp.setDevicePixelRatio(dpr);
+    tile.topLeft = QPoint(destRect.left() + destLeftMargin, destRect.top() + destTopMargin);
+    tile.image = tmp;
+    return tile;
+}
+
 struct ImageScalerPrivate
 {
     Qt::TransformationMode mTransformationMode;
     Document::Ptr mDocument;
     qreal mZoom;
     QRegion mRegion;
+    RenderScheduler* mRenderScheduler;
+    // Incremented whenever tiles being rendered by mRenderScheduler become
+    // obsolete
+    int mGeneration;
 };
 
 ImageScaler::ImageScaler(QObject* parent)
@@ -73,6 +211,8 @@ ImageScaler::ImageScaler(QObject* parent)
 {
     d->mTransformationMode = Qt::FastTransformation;
     d->mZoom = 0;
+    d->mRenderScheduler = nullptr;
+    d->mGeneration = 0;
 }
 
 ImageScaler::~ImageScaler()
@@ -80,12 +220,18 @@ ImageScaler::~ImageScaler()
     delete d;
 }
 
+void ImageScaler::setRenderScheduler(RenderScheduler* scheduler)
+{
+    d->mRenderScheduler = scheduler;
+}
+
 void ImageScaler::setDocument(const Document::Ptr &document)
 {
     if (d->mDocument) {
         disconnect(d->mDocument.data(), nullptr, this, nullptr);
     }
     d->mDocument = document;
+    ++d->mGeneration;
     // Used when scaler asked for a down-sampled image
     connect(d->mDocument.data(), &Document::downSampledImageReady,
             this, &ImageScaler::doScale);
@@ -101,6 +247,9 @@ void ImageScaler::setZoom(qreal zoom)
     d->mTransformationMode = zoom < 4. ? Qt::SmoothTransformation
                                        : Qt::FastTransformation;
 
+    if (!qFuzzyCompare(zoom, d->mZoom)) {
+        ++d->mGeneration;
+    }
     d->mZoom = zoom;
 }
 
@@ -124,7 +273,7 @@ void ImageScaler::doScale()
             LOG("Asked for a down sampled image");
             return;
         }
-    } else if (d->mDocument->image().isNull()) {
+    } else if (d->mDocument->sourceImage().isNull()) {
         LOG("Asked for the full image");
         d->mDocument->startLoadingFullImage();
         return;
@@ -140,89 +289,51 @@ void ImageScaler::doScale()
 
 void ImageScaler::scaleRect(const QRect& rect)
 {
-    const qreal dpr = qApp->devicePixelRatio();
-
-    // variables prefixed with dp are in device pixels
-    const QRect dpRect = Gwenview::scaledRect(rect, dpr);
+    ScaleTask task;
+    task.mRect = rect;
+    task.mDpr = qApp->devicePixelRatio();
+    task.mTransformationMode = d->mTransformationMode;
+    // Do not use Document::image(), it would edit the full image
+    task.mEdits = d->mDocument->edits();
 
     const qreal REAL_DELTA = 0.001;
     if (qAbs(d->mZoom - 1.0) < REAL_DELTA) {
-        QImage tmp = d->mDocument->image().copy(dpRect);
-        tmp.setDevicePixelRatio(dpr);
-        emit scaledRect(rect.left(), rect.top(), tmp);
-        return;
-    }
-
-    QImage image;
-    qreal zoom;
-    if (d->mZoom < Document::maxDownSampledZoom()) {
-        image = d->mDocument->downSampledImageForZoom(d->mZoom);
-        Q_ASSERT(!image.isNull());
-        qreal zoom1 = qreal(image.width()) / d->mDocument->width();
-        zoom = d->mZoom / zoom1;
+        task.mImage = d->mDocument->sourceImage();
+        task.mZoom = 1.0;
+        task.mCopyOnly = true;
+    } else if (d->mZoom < Document::maxDownSampledZoom()) {
+        task.mImage = d->mDocument->downSampledImageForZoom(d->mZoom);
+        Q_ASSERT(!task.mImage.isNull());
+        const QSize sourceSize = task.mEdits.isEmpty() ? d->mDocument->size() : task.mEdits.sourceSize();
+        qreal zoom1 = qreal(task.mImage.width()) / sourceSize.width();
+        task.mZoom = d->mZoom / zoom1;
+        task.mCopyOnly = false;
     } else {
-        image = d->mDocument->image();
-        zoom = d->mZoom;
+        task.mImage = d->mDocument->sourceImage();
+        task.mZoom = d->mZoom;
+        task.mCopyOnly = false;
     }
-    const QRect imageRect = Gwenview::scaledRect(image.rect(), 1.0 / dpr);
-
-    // If rect contains "half" pixels, make sure sourceRect includes them
-    QRectF sourceRectF = Gwenview::scaledRect(QRectF(rect), 1.0 / zoom);
 
-    sourceRectF = sourceRectF.intersected(imageRect);
-    QRect sourceRect = sourceRectF.toAlignedRect();
-    if (sourceRect.isEmpty()) {
+    if (!d->mRenderScheduler) {
+        const RenderScheduler::Tile tile = task.run();
+        if (!tile.image.isNull()) {
+            emit scaledRect(tile.topLeft.x(), tile.topLeft.y(), tile.image);
+        }
         return;
     }
 
-    // Compute smooth margin
-    bool needsSmoothMargins = d->mTransformationMode == Qt::SmoothTransformation;
-
-    int sourceLeftMargin, sourceRightMargin, sourceTopMargin, sourceBottomMargin;
-    int destLeftMargin, destRightMargin, destTopMargin, destBottomMargin;
-    if (needsSmoothMargins) {
-        sourceLeftMargin = qMin(sourceRect.left(), SMOOTH_MARGIN);
-        sourceTopMargin = qMin(sourceRect.top(), SMOOTH_MARGIN);
-        sourceRightMargin = qMin(imageRect.right() - sourceRect.right(), SMOOTH_MARGIN);
-        sourceBottomMargin = qMin(imageRect.bottom() - sourceRect.bottom(), SMOOTH_MARGIN);
-        sourceRect.adjust(
-            -sourceLeftMargin,
-            -sourceTopMargin,
-            sourceRightMargin,
-            sourceBottomMargin);
-        destLeftMargin = int(sourceLeftMargin * zoom);
-        destTopMargin = int(sourceTopMargin * zoom);
-        destRightMargin = int(sourceRightMargin * zoom);
-        destBottomMargin = int(sourceBottomMargin * zoom);
-    } else {
-        sourceLeftMargin = sourceRightMargin = sourceTopMargin = sourceBottomMargin = 0;
-        destLeftMargin = destRightMargin = destTopMargin = destBottomMargin = 0;
-    }
-
-    // destRect is almost like rect, but it contains only "full" pixels
-    QRect destRect = Gwenview::scaledRect(sourceRect, zoom);
-
-    QRect dpSourceRect = Gwenview::scaledRect(sourceRect, dpr);
-    QRect dpDestRect = Gwenview::scaledRect(dpSourceRect, zoom);
-
-    QImage tmp;
-    tmp = image.copy(dpSourceRect);
-    tmp = tmp.scaled(
-              dpDestRect.width(),
-              dpDestRect.height(),
-              Qt::IgnoreAspectRatio, // Do not use KeepAspectRatio, it can lead to skipped rows or columns
-              d->mTransformationMode);
-
-    if (needsSmoothMargins) {
-        tmp = tmp.copy(
-                  destLeftMargin * dpr, destTopMargin * dpr,
-                  dpDestRect.width() - (destLeftMargin + destRightMargin) * dpr,
-                  dpDestRect.height() - (destTopMargin + destBottomMargin) * dpr
-              );
-    }
-
-    tmp.setDevicePixelRatio(dpr);
-    emit scaledRect(destRect.left() + destLeftMargin, destRect.top() + destTopMargin, tmp);
+    const int generation = d->mGeneration;
+    d->mRenderScheduler->schedule(this,
+        [task]() {
+            return task.run();
+        },
+        [this, generation](const RenderScheduler::Tile& tile) {
+            if (generation != d->mGeneration || tile.image.isNull()) {
+                // Zoom or document changed while we were rendering
+                return;
+            }
+            emit scaledRect(tile.topLeft.x(), tile.topLeft.y(), tile.image);
+        });
 }
 
 } // namespace
@@ -37,6 +37,7 @@ namespace Gwenview
 {
 
 class Document;
+class RenderScheduler;
 
 struct ImageScalerPrivate;
 class GWENVIEWLIB_EXPORT ImageScaler : public QObject
@@ -49,6 +50,12 @@ public:
     void setZoom(qreal);
     void setDestinationRegion(const QRegion&);
 
+    /**
+     * If set, rects are scaled by @p scheduler instead of synchronously.
+     * scaledRect() is then emitted when the scheduler delivers them.
+     */
+    void setRenderScheduler(RenderScheduler* scheduler);
+
 Q_SIGNALS:
     void scaledRect(int left, int top, const QImage&);
 
@@ -20,14 +20,352 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 */
 #include "imageutils.h"
 
+// STL
+#include <cstring>
+
 // Qt
+#include <QImage>
+#include <QStringList>
+#include <QThread>
 #include <QTransform>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace Gwenview
 {
 namespace ImageUtils
 {
 
+namespace
+{
+
+// Source and destination tiles must both fit in the L1 cache
+const int TILE_BYTES = 16 * 1024;
+
+// Under this amount of pixels per thread, splitting the work costs more than
+// it brings
+const int MIN_PIXELS_PER_THREAD = 512 * 512;
+
+/**
+ * Tells where a source pixel goes: pixel (x, y) is stored at
+ * base + x * xStep + y * yStep
+ */
+struct PixelMapping
+{
+    uchar* base;
+    qptrdiff xStep;
+    qptrdiff yStep;
+};
+
+PixelMapping pixelMapping(Orientation orientation, QImage* dst, int bpp)
+{
+    // Width and height of the *source* image
+    const bool transposed = orientation >= TRANSPOSE;
+    const int width = transposed ? dst->height() : dst->width();
+    const int height = transposed ? dst->width() : dst->height();
+    const qptrdiff stride = dst->bytesPerLine();
+    uchar* bits = dst->bits();
+
+    PixelMapping map;
+    switch (orientation) {
+    case HFLIP:
+        map = { bits + (width - 1) * bpp, -bpp, stride };
+        break;
+    case VFLIP:
+        map = { bits + (height - 1) * stride, bpp, -stride };
+        break;
+    case ROT_180:
+        map = { bits + (height - 1) * stride + (width - 1) * bpp, -bpp, -stride };
+        break;
+    case TRANSPOSE:
+        map = { bits, stride, bpp };
+        break;
+    case ROT_90:
+        map = { bits + (height - 1) * bpp, stride, -bpp };
+        break;
+    case TRANSVERSE:
+        map = { bits + (width - 1) * stride + (height - 1) * bpp, -stride, -bpp };
+        break;
+    case ROT_270:
+        map = { bits + (width - 1) * stride, -stride, bpp };
+        break;
+    default:
+        map = { bits, bpp, stride };
+        break;
+    }
+    return map;
+}
+
+template<int BPP>
+void transposeRect(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x0, int y0, int x1, int y1)
+{
+    for (int y = y0; y < y1; ++y) {
+        const uchar* srcPixel = src + y * srcStride + x0 * BPP;
+        uchar* dst = map.base + x0 * map.xStep + y * map.yStep;
+        for (int x = x0; x < x1; ++x, srcPixel += BPP, dst += map.xStep) {
+            std::memcpy(dst, srcPixel, BPP);
+        }
+    }
+}
+
+template<int BPP>
+void transposeTile(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x0, int y0, int x1, int y1)
+{
+    transposeRect<BPP>(src, srcStride, map, x0, y0, x1, y1);
+}
+
+template<int BPP>
+void flipRows(const uchar* src, qptrdiff srcStride, int width, const PixelMapping& map, int y0, int y1)
+{
+    for (int y = y0; y < y1; ++y) {
+        const uchar* srcRow = src + y * srcStride;
+        uchar* dstRow = map.base + y * map.yStep;
+        if (map.xStep > 0) {
+            std::memcpy(dstRow, srcRow, width * BPP);
+            continue;
+        }
+        for (int x = 0; x < width; ++x) {
+            std::memcpy(dstRow - x * BPP, srcRow + x * BPP, BPP);
+        }
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * Transposes the 4x4 block of 32-bit pixels starting at (x, y).
+ * Source rows are loaded in the order they are stored in the destination, so
+ * that transposed rows can be stored as is.
+ */
+inline void transposeBlock32(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x, int y)
+{
+    const bool reversed = map.yStep < 0;
+    __m128i row[4];
+    for (int i = 0; i < 4; ++i) {
+        const int srcY = reversed ? y + 3 - i : y + i;
+        row[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + srcY * srcStride + x * 4));
+    }
+    const __m128i t0 = _mm_unpacklo_epi32(row[0], row[1]);
+    const __m128i t1 = _mm_unpacklo_epi32(row[2], row[3]);
+    const __m128i t2 = _mm_unpackhi_epi32(row[0], row[1]);
+    const __m128i t3 = _mm_unpackhi_epi32(row[2], row[3]);
+    const __m128i column[4] = {
+        _mm_unpacklo_epi64(t0, t1),
+        _mm_unpackhi_epi64(t0, t1),
+        _mm_unpacklo_epi64(t2, t3),
+        _mm_unpackhi_epi64(t2, t3)
+    };
+    const int firstY = reversed ? y + 3 : y;
+    for (int i = 0; i < 4; ++i) {
+        uchar* dst = map.base + (x + i) * map.xStep + firstY * map.yStep;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), column[i]);
+    }
+}
+
+/**
+ * Same as transposeBlock32(), for a 8x8 block of 8-bit pixels
+ */
+inline void transposeBlock8(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x, int y)
+{
+    const bool reversed = map.yStep < 0;
+    __m128i row[8];
+    for (int i = 0; i < 8; ++i) {
+        const int srcY = reversed ? y + 7 - i : y + i;
+        row[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + srcY * srcStride + x));
+    }
+    const __m128i b0 = _mm_unpacklo_epi8(row[0], row[1]);
+    const __m128i b1 = _mm_unpacklo_epi8(row[2], row[3]);
+    const __m128i b2 = _mm_unpacklo_epi8(row[4], row[5]);
+    const __m128i b3 = _mm_unpacklo_epi8(row[6], row[7]);
+    const __m128i c0 = _mm_unpacklo_epi16(b0, b1);
+    const __m128i c1 = _mm_unpackhi_epi16(b0, b1);
+    const __m128i c2 = _mm_unpacklo_epi16(b2, b3);
+    const __m128i c3 = _mm_unpackhi_epi16(b2, b3);
+    // Each register holds two transposed rows
+    const __m128i columns[4] = {
+        _mm_unpacklo_epi32(c0, c2),
+        _mm_unpackhi_epi32(c0, c2),
+        _mm_unpacklo_epi32(c1, c3),
+        _mm_unpackhi_epi32(c1, c3)
+    };
+    const int firstY = reversed ? y + 7 : y;
+    for (int i = 0; i < 4; ++i) {
+        uchar* dst = map.base + (x + 2 * i) * map.xStep + firstY * map.yStep;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), columns[i]);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + map.xStep), _mm_srli_si128(columns[i], 8));
+    }
+}
+
+template<int BPP, int BLOCK, void (*transposeBlock)(const uchar*, qptrdiff, const PixelMapping&, int, int)>
+void transposeTileWithBlocks(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x0, int y0, int x1, int y1)
+{
+    const int blockX1 = x0 + (x1 - x0) / BLOCK * BLOCK;
+    const int blockY1 = y0 + (y1 - y0) / BLOCK * BLOCK;
+    for (int y = y0; y < blockY1; y += BLOCK) {
+        for (int x = x0; x < blockX1; x += BLOCK) {
+            transposeBlock(src, srcStride, map, x, y);
+        }
+    }
+    // Right and bottom borders
+    transposeRect<BPP>(src, srcStride, map, blockX1, y0, x1, blockY1);
+    transposeRect<BPP>(src, srcStride, map, x0, blockY1, x1, y1);
+}
+
+template<>
+void transposeTile<4>(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x0, int y0, int x1, int y1)
+{
+    transposeTileWithBlocks<4, 4, transposeBlock32>(src, srcStride, map, x0, y0, x1, y1);
+}
+
+template<>
+void transposeTile<1>(const uchar* src, qptrdiff srcStride, const PixelMapping& map, int x0, int y0, int x1, int y1)
+{
+    transposeTileWithBlocks<1, 8, transposeBlock8>(src, srcStride, map, x0, y0, x1, y1);
+}
+
+template<>
+void flipRows<1>(const uchar* src, qptrdiff srcStride, int width, const PixelMapping& map, int y0, int y1)
+{
+    for (int y = y0; y < y1; ++y) {
+        const uchar* srcRow = src + y * srcStride;
+        uchar* dstRow = map.base + y * map.yStep;
+        if (map.xStep > 0) {
+            std::memcpy(dstRow, srcRow, width);
+            continue;
+        }
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            // No byte shuffle in SSE2: reverse dwords, then words, then bytes
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x));
+            pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+            pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(2, 3, 0, 1));
+            pixels = _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(2, 3, 0, 1));
+            pixels = _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow - (x + 15)), pixels);
+        }
+        for (; x < width; ++x) {
+            dstRow[-x] = srcRow[x];
+        }
+    }
+}
+
+template<>
+void flipRows<4>(const uchar* src, qptrdiff srcStride, int width, const PixelMapping& map, int y0, int y1)
+{
+    if (map.xStep > 0) {
+        flipRows<1>(src, srcStride, width * 4, map, y0, y1);
+        return;
+    }
+    for (int y = y0; y < y1; ++y) {
+        const uchar* srcRow = src + y * srcStride;
+        uchar* dstRow = map.base + y * map.yStep;
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcRow + x * 4));
+            pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dstRow - (x + 3) * 4), pixels);
+        }
+        for (; x < width; ++x) {
+            std::memcpy(dstRow - x * 4, srcRow + x * 4, 4);
+        }
+    }
+}
+#endif
+
+int tileSizeForBpp(int bpp)
+{
+    int size = 8;
+    while ((size * 2) * (size * 2) * bpp <= TILE_BYTES) {
+        size *= 2;
+    }
+    return size;
+}
+
+/**
+ * Moves source rows [y0, y1[ to their place in the destination
+ */
+template<int BPP>
+void transformRows(const uchar* src, qptrdiff srcStride, int width, const PixelMapping& map, bool transposed, int y0, int y1)
+{
+    if (!transposed) {
+        flipRows<BPP>(src, srcStride, width, map, y0, y1);
+        return;
+    }
+    const int tileSize = tileSizeForBpp(BPP);
+    for (int tileY = y0; tileY < y1; tileY += tileSize) {
+        const int tileY1 = qMin(tileY + tileSize, y1);
+        for (int tileX = 0; tileX < width; tileX += tileSize) {
+            transposeTile<BPP>(src, srcStride, map, tileX, tileY, qMin(tileX + tileSize, width), tileY1);
+        }
+    }
+}
+
+void transformRows(const uchar* src, qptrdiff srcStride, int width, const PixelMapping& map, bool transposed, int bpp, int y0, int y1)
+{
+    switch (bpp) {
+    case 1:
+        transformRows<1>(src, srcStride, width, map, transposed, y0, y1);
+        break;
+    case 2:
+        transformRows<2>(src, srcStride, width, map, transposed, y0, y1);
+        break;
+    case 3:
+        transformRows<3>(src, srcStride, width, map, transposed, y0, y1);
+        break;
+    case 4:
+        transformRows<4>(src, srcStride, width, map, transposed, y0, y1);
+        break;
+    case 8:
+        transformRows<8>(src, srcStride, width, map, transposed, y0, y1);
+        break;
+    }
+}
+
+bool hasKernelForDepth(int depth)
+{
+    return depth == 8 || depth == 16 || depth == 24 || depth == 32 || depth == 64;
+}
+
+void transformPixels(const QImage& src, QImage* dst, Orientation orientation)
+{
+    const uchar* srcBits = src.constBits();
+    const qptrdiff srcStride = src.bytesPerLine();
+    const int width = src.width();
+    const int height = src.height();
+    const int bpp = src.depth() / 8;
+    const PixelMapping map = pixelMapping(orientation, dst, bpp);
+    const bool transposed = orientation >= TRANSPOSE;
+    const int tileSize = tileSizeForBpp(bpp);
+
+    // Split the image in bands of whole tiles, one per thread
+    const int threadCount = qBound(1, int(qint64(width) * height / MIN_PIXELS_PER_THREAD), QThread::idealThreadCount());
+    if (threadCount == 1) {
+        transformRows(srcBits, srcStride, width, map, transposed, bpp, 0, height);
+        return;
+    }
+    int bandHeight = (height + threadCount - 1) / threadCount;
+    bandHeight = (bandHeight + tileSize - 1) / tileSize * tileSize;
+
+    QVector<int> bands;
+    for (int y = 0; y < height; y += bandHeight) {
+        bands << y;
+    }
+    QtConcurrent::blockingMap(bands, [&](int y0) {
+        transformRows(srcBits, srcStride, width, map, transposed, bpp, y0, qMin(y0 + bandHeight, height));
+    });
+}
+
+bool sameLinearPart(const QTransform& m1, const QTransform& m2)
+{
+    return qAbs(m1.m11() - m2.m11()) < 1e-6 && qAbs(m1.m12() - m2.m12()) < 1e-6
+        && qAbs(m1.m21() - m2.m21()) < 1e-6 && qAbs(m1.m22() - m2.m22()) < 1e-6;
+}
+
+} // namespace
+
 QTransform transformMatrix(Orientation orientation)
 {
     QTransform matrix;
@@ -70,5 +408,118 @@ QTransform transformMatrix(Orientation orientation)
     return matrix;
 }
 
+Orientation orientationForTransformation(QImageIOHandler::Transformations transformation)
+{
+    switch (transformation) {
+    case QImageIOHandler::TransformationNone:
+        return NORMAL;
+    case QImageIOHandler::TransformationMirror:
+        return HFLIP;
+    case QImageIOHandler::TransformationFlip:
+        return VFLIP;
+    case QImageIOHandler::TransformationRotate180:
+        return ROT_180;
+    case QImageIOHandler::TransformationRotate90:
+        return ROT_90;
+    case QImageIOHandler::TransformationMirrorAndRotate90:
+        return TRANSVERSE;
+    case QImageIOHandler::TransformationFlipAndRotate90:
+        return TRANSPOSE;
+    case QImageIOHandler::TransformationRotate270:
+        return ROT_270;
+    }
+    return NORMAL;
+}
+
+QImage transformed(const QImage& image, Orientation orientation)
+{
+    if (image.isNull() || orientation == NORMAL || orientation == NOT_AVAILABLE) {
+        return image;
+    }
+    if (!hasKernelForDepth(image.depth())) {
+        // Monochrome images
+        return image.transformed(transformMatrix(orientation));
+    }
+
+    const bool transposed = orientation >= TRANSPOSE;
+    QImage result(transposed ? image.size().transposed() : image.size(), image.format());
+    if (result.isNull()) {
+        // Out of memory
+        return result;
+    }
+    if (image.format() == QImage::Format_Indexed8) {
+        result.setColorTable(image.colorTable());
+    }
+    result.setDotsPerMeterX(transposed ? image.dotsPerMeterY() : image.dotsPerMeterX());
+    result.setDotsPerMeterY(transposed ? image.dotsPerMeterX() : image.dotsPerMeterY());
+    result.setDevicePixelRatio(image.devicePixelRatio());
+    const QStringList keys = image.textKeys();
+    for (const QString& key : keys) {
+        result.setText(key, image.text(key));
+    }
+
+    transformPixels(image, &result, orientation);
+    return result;
+}
+
+void transformRows(const QImage& rows, int firstRow, int rowCount, Orientation orientation, QImage* dst)
+{
+    Q_ASSERT(rows.format() == dst->format());
+    Q_ASSERT(hasKernelForDepth(dst->depth()));
+    const int bpp = dst->depth() / 8;
+    PixelMapping map = pixelMapping(orientation, dst, bpp);
+    map.base += firstRow * map.yStep;
+    transformRows(rows.constBits(), rows.bytesPerLine(), rows.width(), map, orientation >= TRANSPOSE, bpp, 0, rowCount);
+}
+
+QImage transformed(const QImage& image, const QTransform& matrix)
+{
+    if (matrix.isIdentity()) {
+        return image;
+    }
+    static const Orientation orientations[] = {
+        HFLIP, ROT_180, VFLIP, TRANSPOSE, ROT_90, TRANSVERSE, ROT_270
+    };
+    for (Orientation orientation : orientations) {
+        if (sameLinearPart(matrix, transformMatrix(orientation))) {
+            return transformed(image, orientation);
+        }
+    }
+    return image.transformed(matrix);
+}
+
+QImage convertToStorageFormat(const QImage& image)
+{
+    switch (image.format()) {
+    case QImage::Format_Invalid:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGB888:
+    case QImage::Format_Grayscale8:
+        return image;
+
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+        if (image.isGrayscale()) {
+            return image.convertToFormat(QImage::Format_Grayscale8);
+        }
+        break;
+
+    case QImage::Format_Indexed8:
+        if (!image.hasAlphaChannel()) {
+            return image.convertToFormat(image.isGrayscale()
+                                         ? QImage::Format_Grayscale8
+                                         : QImage::Format_RGB888);
+        }
+        break;
+
+    default:
+        break;
+    }
+    return image.convertToFormat(image.hasAlphaChannel()
+                                 ? QImage::Format_ARGB32_Premultiplied
+                                 : QImage::Format_RGB32);
+}
+
 } // namespace
 } // namespace
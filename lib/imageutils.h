@@ -24,6 +24,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include <lib/gwenviewlib_export.h>
 #include <lib/orientation.h>
 
+// Qt
+#include <QImageIOHandler>
+
+class QImage;
 class QTransform;
 
 namespace Gwenview
@@ -33,6 +37,49 @@ namespace ImageUtils
 
 GWENVIEWLIB_EXPORT QTransform transformMatrix(Orientation);
 
+/**
+ * Returns the orientation matching the transformation reported by
+ * QImageReader::transformation().
+ */
+GWENVIEWLIB_EXPORT Orientation orientationForTransformation(QImageIOHandler::Transformations);
+
+/**
+ * Returns @p image rotated or flipped according to @p orientation.
+ *
+ * The result is the same as image.transformed(transformMatrix(orientation)),
+ * but pixels are moved by dedicated kernels: rotations go through
+ * cache-sized tiles, and big images are split over several threads. The
+ * image format is kept.
+ */
+GWENVIEWLIB_EXPORT QImage transformed(const QImage& image, Orientation orientation);
+
+/**
+ * Same as above when @p matrix is one of the matrices returned by
+ * transformMatrix(). Falls back to QImage::transformed() otherwise.
+ */
+GWENVIEWLIB_EXPORT QImage transformed(const QImage& image, const QTransform& matrix);
+
+/**
+ * Moves @p rowCount rows of a source image, starting at row @p firstRow, to
+ * their place in @p dst. @p rows holds these rows. @p dst must already have
+ * the size of the transformed image and the same format as @p rows.
+ *
+ * This makes it possible for a decoder to produce a transformed image
+ * without decoding the whole image in an intermediate buffer first.
+ */
+GWENVIEWLIB_EXPORT void transformRows(const QImage& rows, int firstRow, int rowCount, Orientation orientation, QImage* dst);
+
+/**
+ * Returns @p image converted to the format documents keep their pixels in.
+ *
+ * Compact formats (8-bit grayscale, 24-bit RGB) are kept, or used for opaque
+ * indexed images, so that grayscale scans do not take 4 times the memory they
+ * need. They are only converted when a scaled rect is drawn on screen.
+ * Images with an alpha channel are converted to premultiplied ARGB, so that
+ * QPainter does not have to convert them every time they are drawn.
+ */
+GWENVIEWLIB_EXPORT QImage convertToStorageFormat(const QImage& image);
+
 } // namespace
 } // namespace
 
@@ -50,6 +50,7 @@ extern "C" {
 #include "exiv2imageloader.h"
 #include "gwenviewconfig.h"
 #include "imageutils.h"
+#include "paralleljpegencoder.h"
 
 namespace Gwenview
 {
@@ -122,6 +123,10 @@ struct JpegContent::Private
     QByteArray mRawData;
 
     QSize mSize;
+    // Size of the image in mRawData, without any orientation applied
+    QSize mRawSize;
+    // Size of an iMCU in mRawData, this is the granularity of lossless crops
+    QSize mMcuSize;
     QString mComment;
     bool mPendingTransformation;
     QTransform mTransformMatrix;
@@ -176,21 +181,137 @@ struct JpegContent::Private
             return false;
         }
         mSize = QSize(srcinfo.image_width, srcinfo.image_height);
+        mRawSize = mSize;
+#if JPEG_LIB_VERSION >= 70
+        mMcuSize = QSize(srcinfo.max_h_samp_factor * srcinfo.min_DCT_h_scaled_size,
+                         srcinfo.max_v_samp_factor * srcinfo.min_DCT_v_scaled_size);
+#else
+        mMcuSize = QSize(srcinfo.max_h_samp_factor * DCTSIZE,
+                         srcinfo.max_v_samp_factor * DCTSIZE);
+#endif
 
         jpeg_destroy_decompress(&srcinfo);
         return true;
     }
 
-    bool updateRawDataFromImage()
+    /**
+     * If mRawData is still memory-mapped from mFile, replace it with a copy we
+     * own, so that it survives changes to the file
+     */
+    void readFileData()
     {
-        QBuffer buffer;
-        QImageWriter writer(&buffer, "jpeg");
-        writer.setQuality(GwenviewConfig::jPEGQuality());
-        if (!writer.write(mImage)) {
-            mErrorString = writer.errorString();
+        if (mFile.isOpen()) {
+            // backup the mmap() pointer
+            auto* mappedFile = reinterpret_cast<unsigned char*>(mRawData.data());
+            // read the file to memory
+            mRawData = mFile.readAll();
+            mFile.unmap(mappedFile);
+            mFile.close();
+        }
+    }
+
+    /**
+     * Drops the DCT blocks outside of rect. rect must be aligned on mMcuSize.
+     * This is the crop part of jpegtran, which is not available in all the
+     * versions of transupp we ship.
+     */
+    bool cropRawData(const QRect& rect)
+    {
+        struct jpeg_decompress_struct srcinfo;
+        struct jpeg_compress_struct dstinfo;
+        memset(&srcinfo, 0, sizeof(srcinfo));
+        memset(&dstinfo, 0, sizeof(dstinfo));
+
+        // Initialize the JPEG decompression object
+        JPEGErrorManager srcErrorManager;
+        srcinfo.err = &srcErrorManager;
+        jpeg_create_decompress(&srcinfo);
+        if (setjmp(srcErrorManager.jmp_buffer)) {
+            qCCritical(GWENVIEW_LIB_LOG) << "libjpeg error in src\n";
+            jpeg_destroy_compress(&dstinfo);
+            jpeg_destroy_decompress(&srcinfo);
+            return false;
+        }
+
+        // Initialize the JPEG compression object
+        JPEGErrorManager dstErrorManager;
+        dstinfo.err = &dstErrorManager;
+        jpeg_create_compress(&dstinfo);
+        if (setjmp(dstErrorManager.jmp_buffer)) {
+            qCCritical(GWENVIEW_LIB_LOG) << "libjpeg error in dst\n";
+            jpeg_destroy_compress(&dstinfo);
+            jpeg_destroy_decompress(&srcinfo);
             return false;
         }
-        mRawData = buffer.data();
+
+        QBuffer buffer(&mRawData);
+        buffer.open(QIODevice::ReadOnly);
+        IODeviceJpegSourceManager::setup(&srcinfo, &buffer);
+        jcopy_markers_setup(&srcinfo, JCOPYOPT_ALL);
+        (void) jpeg_read_header(&srcinfo, true);
+
+        jvirt_barray_ptr* coefArrays = jpeg_read_coefficients(&srcinfo);
+
+        // Move the blocks we keep to the top-left of the coefficient arrays.
+        // Destination rows and columns are never after their source, so this
+        // can be done in place, one block row at a time.
+        const int mcuWidth = mMcuSize.width();
+        const int mcuHeight = mMcuSize.height();
+        for (int ci = 0; ci < srcinfo.num_components; ++ci) {
+            const jpeg_component_info* compptr = srcinfo.comp_info + ci;
+            const JDIMENSION xOffset = rect.x() / mcuWidth * compptr->h_samp_factor;
+            const JDIMENSION yOffset = rect.y() / mcuHeight * compptr->v_samp_factor;
+            const JDIMENSION widthInBlocks = (rect.width() * compptr->h_samp_factor + mcuWidth - 1) / mcuWidth;
+            const JDIMENSION heightInBlocks = (rect.height() * compptr->v_samp_factor + mcuHeight - 1) / mcuHeight;
+            const size_t rowLength = widthInBlocks * sizeof(JBLOCK);
+            QByteArray rowBuffer(rowLength, Qt::Uninitialized);
+            for (JDIMENSION row = 0; row < heightInBlocks; ++row) {
+                JBLOCKARRAY srcRow = (*srcinfo.mem->access_virt_barray)(
+                    (j_common_ptr)&srcinfo, coefArrays[ci], row + yOffset, 1, false);
+                memcpy(rowBuffer.data(), srcRow[0] + xOffset, rowLength);
+                JBLOCKARRAY dstRow = (*srcinfo.mem->access_virt_barray)(
+                    (j_common_ptr)&srcinfo, coefArrays[ci], row, 1, true);
+                memcpy(dstRow[0], rowBuffer.constData(), rowLength);
+            }
+        }
+
+        jpeg_copy_critical_parameters(&srcinfo, &dstinfo);
+        dstinfo.image_width = rect.width();
+        dstinfo.image_height = rect.height();
+#if JPEG_LIB_VERSION >= 80
+        dstinfo.jpeg_width = rect.width();
+        dstinfo.jpeg_height = rect.height();
+#endif
+
+        QByteArray output;
+        output.resize(mRawData.size());
+        setupInmemDestination(&dstinfo, &output);
+
+        jpeg_write_coefficients(&dstinfo, coefArrays);
+        jcopy_markers_execute(&srcinfo, &dstinfo, JCOPYOPT_ALL);
+
+        jpeg_finish_compress(&dstinfo);
+        jpeg_destroy_compress(&dstinfo);
+        (void) jpeg_finish_decompress(&srcinfo);
+        jpeg_destroy_decompress(&srcinfo);
+
+        mRawData = output;
+        return true;
+    }
+
+    bool updateRawDataFromImage()
+    {
+        mRawData = ParallelJpegEncoder::encode(mImage, GwenviewConfig::jPEGQuality());
+        if (mRawData.isEmpty()) {
+            QBuffer buffer;
+            QImageWriter writer(&buffer, "jpeg");
+            writer.setQuality(GwenviewConfig::jPEGQuality());
+            if (!writer.write(mImage)) {
+                mErrorString = writer.errorString();
+                return false;
+            }
+            mRawData = buffer.data();
+        }
         mImage = QImage();
         return true;
     }
@@ -444,6 +565,125 @@ void JpegContent::transform(Orientation orientation)
     }
 }
 
+/**
+ * Returns the transformation crop() applies to the raw data before cropping:
+ * the Exif orientation, then the pending transformation. These matrices only
+ * contain rotations and flips: they swap axes if m11 is 0.
+ */
+static QTransform cropTransform(const QTransform& pendingMatrix, Orientation orientation)
+{
+    if (!GwenviewConfig::applyExifOrientation()) {
+        return pendingMatrix;
+    }
+    return ImageUtils::transformMatrix(orientation) * pendingMatrix;
+}
+
+/**
+ * libjpeg cannot move the partial iMCUs at the right and bottom edges of an
+ * image to the left or top edges: trimmed transformations drop them instead.
+ * Returns the size of the dropped strips, that is the position of the
+ * transformed raw data in the coordinates of the displayed image.
+ */
+static QPoint trimmedOrigin(const QTransform& matrix, const QSize& rawSize, const QSize& mcuSize)
+{
+    const int partialWidth = rawSize.width() % mcuSize.width();
+    const int partialHeight = rawSize.height() % mcuSize.height();
+    QPoint origin;
+    // Where the right edge of the raw image goes
+    if (matrix.m11() < -0.5) {
+        origin.rx() += partialWidth;
+    } else if (matrix.m12() < -0.5) {
+        origin.ry() += partialWidth;
+    }
+    // Where its bottom edge goes
+    if (matrix.m21() < -0.5) {
+        origin.rx() += partialHeight;
+    } else if (matrix.m22() < -0.5) {
+        origin.ry() += partialHeight;
+    }
+    return origin;
+}
+
+QSize JpegContent::losslessCropAlignment() const
+{
+    if (d->mRawData.isEmpty() || !d->mImage.isNull() || !d->mMcuSize.isValid()) {
+        return QSize();
+    }
+    // crop() applies the Exif orientation and the pending transformation
+    // first, alignment must be expressed in the resulting coordinates
+    const QTransform matrix = cropTransform(d->mTransformMatrix, orientation());
+    return qFuzzyIsNull(matrix.m11()) ? d->mMcuSize.transposed() : d->mMcuSize;
+}
+
+QPoint JpegContent::losslessCropOrigin() const
+{
+    if (!losslessCropAlignment().isValid()) {
+        return QPoint();
+    }
+    const QTransform matrix = cropTransform(d->mTransformMatrix, orientation());
+    return trimmedOrigin(matrix, d->mRawSize, d->mMcuSize);
+}
+
+bool JpegContent::crop(const QRect& rect)
+{
+    const QSize alignment = losslessCropAlignment();
+    if (!alignment.isValid() || rect.isEmpty()) {
+        return false;
+    }
+    // rect is in the coordinates of the displayed image: the raw data must
+    // be brought in the same orientation first
+    const Orientation exifOrientation = GwenviewConfig::applyExifOrientation() ? orientation() : NORMAL;
+    const QTransform matrix = cropTransform(d->mTransformMatrix, exifOrientation);
+    const QSize orientedSize = qFuzzyIsNull(matrix.m11()) ? d->mRawSize.transposed() : d->mRawSize;
+    const QRect rawRect = rect.translated(-trimmedOrigin(matrix, d->mRawSize, d->mMcuSize));
+    if (!QRect(QPoint(0, 0), orientedSize).contains(rect)
+            || rawRect.x() < 0
+            || rawRect.y() < 0
+            || rawRect.x() % alignment.width() != 0
+            || rawRect.y() % alignment.height() != 0) {
+        return false;
+    }
+
+    d->readFileData();
+    // Only commit the changes if everything succeeds
+    const QByteArray rawData = d->mRawData;
+    const QSize size = d->mSize;
+    const QSize rawSize = d->mRawSize;
+    const QSize mcuSize = d->mMcuSize;
+    const QTransform pendingMatrix = d->mTransformMatrix;
+    auto rollback = [this, rawData, size, rawSize, mcuSize, pendingMatrix]() {
+        d->mRawData = rawData;
+        d->mSize = size;
+        d->mRawSize = rawSize;
+        d->mMcuSize = mcuSize;
+        d->mTransformMatrix = pendingMatrix;
+        return false;
+    };
+
+    if (d->mPendingTransformation || (exifOrientation != NORMAL && exifOrientation != NOT_AVAILABLE)) {
+        d->mTransformMatrix = matrix;
+        // Trim the partial iMCUs which cannot be moved, rawRect takes them
+        // into account. readSize() gets the iMCU size of the result, it may
+        // have been transposed.
+        if (!applyPendingTransformation(true) || !d->readSize()) {
+            return rollback();
+        }
+    }
+    if (!d->cropRawData(rawRect)) {
+        return rollback();
+    }
+
+    if (exifOrientation != NORMAL && exifOrientation != NOT_AVAILABLE) {
+        resetOrientation();
+    }
+    d->mPendingTransformation = false;
+    d->mTransformMatrix.reset();
+    d->mSize = rect.size();
+    d->mExifData["Exif.Photo.PixelXDimension"] = rect.width();
+    d->mExifData["Exif.Photo.PixelYDimension"] = rect.height();
+    return true;
+}
+
 #if 0
 static void dumpMatrix(const QTransform& matrix)
 {
@@ -475,11 +715,11 @@ static JXFORM_CODE findJxform(const QTransform& matrix)
     return JXFORM_NONE;
 }
 
-void JpegContent::applyPendingTransformation()
+bool JpegContent::applyPendingTransformation(bool trim)
 {
     if (d->mRawData.size() == 0) {
         qCCritical(GWENVIEW_LIB_LOG) << "No data loaded\n";
-        return;
+        return false;
     }
 
     // The following code is inspired by jpegtran.c from the libjpeg
@@ -496,7 +736,7 @@ void JpegContent::applyPendingTransformation()
     jpeg_create_decompress(&srcinfo);
     if (setjmp(srcErrorManager.jmp_buffer)) {
         qCCritical(GWENVIEW_LIB_LOG) << "libjpeg error in src\n";
-        return;
+        return false;
     }
 
     // Initialize the JPEG compression object
@@ -505,7 +745,7 @@ void JpegContent::applyPendingTransformation()
     jpeg_create_compress(&dstinfo);
     if (setjmp(dstErrorManager.jmp_buffer)) {
         qCCritical(GWENVIEW_LIB_LOG) << "libjpeg error in dst\n";
-        return;
+        return false;
     }
 
     // Specify data source for decompression
@@ -522,6 +762,7 @@ void JpegContent::applyPendingTransformation()
     jpeg_transform_info transformoption;
     memset(&transformoption, 0, sizeof(jpeg_transform_info));
     transformoption.transform = findJxform(d->mTransformMatrix);
+    transformoption.trim = trim;
     jtransform_request_workspace(&srcinfo, &transformoption);
 
     /* Read source file as DCT coefficients */
@@ -561,6 +802,7 @@ void JpegContent::applyPendingTransformation()
 
     // Set rawData to our new JPEG
     d->mRawData = output;
+    return true;
 }
 
 QImage JpegContent::thumbnail() const
@@ -605,7 +847,7 @@ QImage JpegContent::thumbnail() const
 
         Orientation o = orientation();
         if (GwenviewConfig::applyExifOrientation() && o != NORMAL && o != NOT_AVAILABLE) {
-            image = image.transformed(ImageUtils::transformMatrix(o));
+            image = ImageUtils::transformed(image, o);
         }
     }
     return image;
@@ -638,14 +880,7 @@ bool JpegContent::save(const QString& path)
 {
     // we need to take ownership of the input file's data
     // if the input file is still open, data is still only mem-mapped
-    if (d->mFile.isOpen()) {
-        // backup the mmap() pointer
-        auto* mappedFile = reinterpret_cast<unsigned char*>(d->mRawData.data());
-        // read the file to memory
-        d->mRawData = d->mFile.readAll();
-        d->mFile.unmap(mappedFile);
-        d->mFile.close();
-    }
+    d->readFileData();
 
     QFile file(path);
     if (!file.open(QIODevice::WriteOnly)) {
@@ -26,6 +26,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <lib/gwenviewlib_export.h>
 #include <QByteArray>
 class QImage;
+class QPoint;
+class QRect;
 class QSize;
 class QString;
 class QIODevice;
@@ -57,6 +59,30 @@ public:
 
     void transform(Orientation);
 
+    /**
+     * Returns the grid the top-left corner of a rect passed to crop() must be
+     * aligned to, in the coordinates of size(). Returns an invalid size if the
+     * content cannot be cropped losslessly, for example after setImage().
+     */
+    QSize losslessCropAlignment() const;
+
+    /**
+     * Returns the origin of the losslessCropAlignment() grid. It is not (0, 0)
+     * when the transformations crop() applies first move partial DCT blocks
+     * to the left or top edges: libjpeg drops them, so the pixels before the
+     * origin cannot be kept losslessly.
+     */
+    QPoint losslessCropOrigin() const;
+
+    /**
+     * Crops the image by dropping DCT blocks, without decoding it. The Exif
+     * orientation and any pending transformation are applied first.
+     * @return false if @p rect is not aligned on the losslessCropAlignment()
+     * grid starting at losslessCropOrigin(), or if cropping failed. The
+     * content is then left unchanged.
+     */
+    bool crop(const QRect& rect);
+
     QImage thumbnail() const;
     void setThumbnail(const QImage&);
 
@@ -83,7 +109,7 @@ private:
 
     JpegContent(const JpegContent&);
     void operator=(const JpegContent&);
-    void applyPendingTransformation();
+    bool applyPendingTransformation(bool trim = false);
     int dotsPerMeter(const QString& keyName) const;
 };
 
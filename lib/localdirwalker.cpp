@@ -0,0 +1,196 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Self
+#include "localdirwalker.h"
+
+// Qt
+#include <QAtomicInt>
+#include <QDirIterator>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+
+// KDE
+
+// Local
+
+namespace Gwenview
+{
+
+/**
+ * How often results are emitted. Large folders are shown in big batches
+ * instead of one batch per folder.
+ */
+static const int RESULT_INTERVAL = 100;
+
+struct LocalDirWalkerPrivate;
+
+class ListDirTask : public QRunnable
+{
+public:
+    ListDirTask(LocalDirWalkerPrivate* d, const QString& path, bool recursive, int generation)
+    : mD(d)
+    , mPath(path)
+    , mRecursive(recursive)
+    , mGeneration(generation)
+    {}
+
+    void run() override;
+
+private:
+    LocalDirWalkerPrivate* mD;
+    QString mPath;
+    bool mRecursive;
+    int mGeneration;
+};
+
+struct LocalDirWalkerPrivate
+{
+    QThreadPool mPool;
+    QTimer mTimer;
+    // Protects mResults and changes of mGeneration
+    QMutex mMutex;
+    QList<LocalDirWalker::DirListing> mResults;
+    // Incremented by cancel(), tasks of previous generations stop early
+    QAtomicInt mGeneration;
+    QAtomicInt mPendingTasks;
+
+    void startTask(const QString& path, bool recursive, int generation)
+    {
+        mPendingTasks.ref();
+        mPool.start(new ListDirTask(this, path, recursive, generation));
+    }
+
+    void listDir(const QString& path, bool recursive, int generation)
+    {
+        LocalDirWalker::DirListing listing;
+        listing.path = path;
+        // Like KDirLister, skip hidden files
+        QDirIterator it(path, QDir::AllEntries | QDir::NoDotAndDotDot);
+        while (it.hasNext()) {
+            if (mGeneration.load() != generation) {
+                return;
+            }
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            if (info.isDir()) {
+                if (!info.isSymLink()) {
+                    listing.subDirPaths << info.filePath();
+                }
+            } else if (info.isFile()) {
+                // Only reads the file status, the MIME type is determined
+                // the first time it is needed
+                listing.files << KFileItem(QUrl::fromLocalFile(info.filePath()));
+            }
+        }
+
+        if (recursive) {
+            for (const QString& subDirPath : qAsConst(listing.subDirPaths)) {
+                startTask(subDirPath, true, generation);
+            }
+        }
+
+        QMutexLocker locker(&mMutex);
+        if (mGeneration.load() == generation) {
+            mResults << listing;
+        }
+    }
+};
+
+void ListDirTask::run()
+{
+    mD->listDir(mPath, mRecursive, mGeneration);
+    mD->mPendingTasks.deref();
+}
+
+LocalDirWalker::LocalDirWalker(QObject* parent)
+: QObject(parent)
+, d(new LocalDirWalkerPrivate)
+{
+    // Listing is mostly waiting for the disk, a few threads are enough to
+    // keep it busy
+    d->mPool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
+    d->mTimer.setInterval(RESULT_INTERVAL);
+    connect(&d->mTimer, &QTimer::timeout, this, &LocalDirWalker::emitResults);
+}
+
+LocalDirWalker::~LocalDirWalker()
+{
+    cancel();
+    d->mPool.waitForDone();
+    delete d;
+}
+
+void LocalDirWalker::start(const QString& dirPath, bool recursive)
+{
+    d->startTask(dirPath, recursive, d->mGeneration.load());
+    if (!d->mTimer.isActive()) {
+        d->mTimer.start();
+    }
+}
+
+void LocalDirWalker::cancel()
+{
+    QMutexLocker locker(&d->mMutex);
+    d->mGeneration.ref();
+    d->mResults.clear();
+    d->mTimer.stop();
+}
+
+bool LocalDirWalker::isRunning() const
+{
+    return d->mTimer.isActive();
+}
+
+void LocalDirWalker::emitResults()
+{
+    // Tasks add their results before they are done: if no task is pending
+    // now, all results are available
+    const bool done = d->mPendingTasks.load() == 0;
+    QList<DirListing> results;
+    {
+        QMutexLocker locker(&d->mMutex);
+        results.swap(d->mResults);
+    }
+    if (!results.isEmpty()) {
+        emit dirsListed(results);
+    }
+    if (!done) {
+        return;
+    }
+    if (d->mPendingTasks.load() > 0) {
+        // dirsListed() receivers started new tasks
+        return;
+    }
+    {
+        QMutexLocker locker(&d->mMutex);
+        if (!d->mResults.isEmpty()) {
+            return;
+        }
+    }
+    d->mTimer.stop();
+    emit finished();
+}
+
+} // namespace
@@ -0,0 +1,94 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef LOCALDIRWALKER_H
+#define LOCALDIRWALKER_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+// KDE
+#include <KFileItem>
+
+// Local
+
+namespace Gwenview
+{
+
+struct LocalDirWalkerPrivate;
+
+/**
+ * Lists local folders, and optionally their subfolders, in a bounded pool of
+ * threads. Results are collected and emitted in batches from the thread the
+ * walker lives in.
+ *
+ * Symbolic links to folders are not followed, to avoid walking in circles.
+ */
+class GWENVIEWLIB_EXPORT LocalDirWalker : public QObject
+{
+    Q_OBJECT
+public:
+    struct DirListing
+    {
+        QString path;
+        /// Files of the folder, their MIME type is determined on demand
+        KFileItemList files;
+        QStringList subDirPaths;
+    };
+
+    explicit LocalDirWalker(QObject* parent = nullptr);
+    ~LocalDirWalker() override;
+
+    /**
+     * Lists @p dirPath, and all its subfolders if @p recursive is true. Can be
+     * called while other folders are being listed.
+     */
+    void start(const QString& dirPath, bool recursive);
+
+    /**
+     * Drops the folders being listed and the results which have not been
+     * emitted yet
+     */
+    void cancel();
+
+    bool isRunning() const;
+
+Q_SIGNALS:
+    void dirsListed(const QList<LocalDirWalker::DirListing>&);
+
+    /**
+     * Emitted once all the started folders have been listed
+     */
+    void finished();
+
+private Q_SLOTS:
+    void emitResults();
+
+private:
+    LocalDirWalkerPrivate* const d;
+};
+
+} // namespace
+
+#endif /* LOCALDIRWALKER_H */
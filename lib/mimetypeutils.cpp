@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 // Qt
 #include <QApplication>
+#include <QHash>
 #include <QStringList>
 #include "gwenview_lib_debug.h"
 #include <QFileInfo>
@@ -134,7 +135,7 @@ QString urlMimeType(const QUrl &url)
     return db.mimeTypeForUrl(url).name();
 }
 
-Kind mimeTypeKind(const QString& mimeType)
+static Kind computeMimeTypeKind(const QString& mimeType)
 {
     if (rasterImageMimeTypes().contains(mimeType)) {
         return KIND_RASTER_IMAGE;
@@ -155,6 +156,20 @@ Kind mimeTypeKind(const QString& mimeType)
     return KIND_FILE;
 }
 
+Kind mimeTypeKind(const QString& mimeType)
+{
+    // Views call this for every item, do not go through the MIME type lists
+    // each time
+    static QHash<QString, Kind> cache;
+    QHash<QString, Kind>::ConstIterator it = cache.constFind(mimeType);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+    const Kind kind = computeMimeTypeKind(mimeType);
+    cache.insert(mimeType, kind);
+    return kind;
+}
+
 Kind fileItemKind(const KFileItem& item)
 {
     GV_RETURN_VALUE_IF_FAIL(!item.isNull(), KIND_UNKNOWN);
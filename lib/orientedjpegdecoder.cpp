@@ -0,0 +1,183 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "orientedjpegdecoder.h"
+
+// Qt
+#include <QImage>
+#include <QIODevice>
+#include <QSize>
+#include <QVector>
+#include "gwenview_lib_debug.h"
+
+// Local
+#include "imageutils.h"
+#include "iodevicejpegsourcemanager.h"
+#include "jpegerrormanager.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+namespace OrientedJpegDecoder
+{
+
+// Number of scanlines decoded before they are moved to the destination image.
+// Matches the tile size used by ImageUtils for 32-bit rotations.
+static const int STRIP_HEIGHT = 64;
+
+bool read(QIODevice* device, Orientation orientation, const QSize& scaledSize, QImage* outImage)
+{
+    struct jpeg_decompress_struct cinfo;
+    // Declared before setjmp() so that they are released if libjpeg fails
+    QImage image;
+    QImage strip;
+    QVector<JSAMPLE> scanline;
+
+    JPEGErrorManager errorManager;
+    cinfo.err = &errorManager;
+    jpeg_create_decompress(&cinfo);
+    if (setjmp(errorManager.jmp_buffer)) {
+        qCWarning(GWENVIEW_LIB_LOG) << "libjpeg error, could not decode image";
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    IODeviceJpegSourceManager::setup(&cinfo, device);
+    if (jpeg_read_header(&cinfo, true) != JPEG_HEADER_OK) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    QImage::Format format;
+    bool needsRgbExpansion = false;
+    switch (cinfo.jpeg_color_space) {
+    case JCS_GRAYSCALE:
+        cinfo.out_color_space = JCS_GRAYSCALE;
+        format = QImage::Format_Grayscale8;
+        break;
+    case JCS_RGB:
+    case JCS_YCbCr:
+#ifdef JCS_EXTENSIONS
+        // libjpeg-turbo can write QImage::Format_RGB32 pixels directly
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        cinfo.out_color_space = JCS_EXT_BGRX;
+#else
+        cinfo.out_color_space = JCS_EXT_XRGB;
+#endif
+#else
+        cinfo.out_color_space = JCS_RGB;
+        needsRgbExpansion = true;
+#endif
+        format = QImage::Format_RGB32;
+        break;
+    default:
+        LOG("Unsupported color space" << cinfo.jpeg_color_space);
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    if (scaledSize.isValid()) {
+        unsigned int denom = 1;
+        while (denom < 8
+               && cinfo.image_width / (denom * 2) >= unsigned(scaledSize.width())
+               && cinfo.image_height / (denom * 2) >= unsigned(scaledSize.height())) {
+            denom *= 2;
+        }
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = denom;
+    }
+
+    jpeg_start_decompress(&cinfo);
+    const QSize size(cinfo.output_width, cinfo.output_height);
+    LOG("Decoding" << size << "orientation" << orientation);
+
+    image = QImage(orientation >= TRANSPOSE ? size.transposed() : size, format);
+    strip = QImage(size.width(), STRIP_HEIGHT, format);
+    if (image.isNull() || strip.isNull()) {
+        qCWarning(GWENVIEW_LIB_LOG) << "Not enough memory to decode image of size" << size;
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+    if (needsRgbExpansion) {
+        scanline.resize(size.width() * cinfo.output_components);
+    }
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        const int firstRow = cinfo.output_scanline;
+        int rowCount = 0;
+        for (; rowCount < STRIP_HEIGHT && cinfo.output_scanline < cinfo.output_height; ++rowCount) {
+            if (!needsRgbExpansion) {
+                JSAMPROW row = strip.scanLine(rowCount);
+                jpeg_read_scanlines(&cinfo, &row, 1);
+                continue;
+            }
+            JSAMPROW row = scanline.data();
+            jpeg_read_scanlines(&cinfo, &row, 1);
+            QRgb* dst = reinterpret_cast<QRgb*>(strip.scanLine(rowCount));
+            const JSAMPLE* src = scanline.constData();
+            for (int x = 0; x < size.width(); ++x, src += 3) {
+                dst[x] = qRgb(src[0], src[1], src[2]);
+            }
+        }
+        ImageUtils::transformRows(strip, firstRow, rowCount, orientation, &image);
+    }
+
+    switch (cinfo.density_unit) {
+    case 1: // Dots per inch
+        image.setDotsPerMeterX(qRound(cinfo.X_density / 0.0254));
+        image.setDotsPerMeterY(qRound(cinfo.Y_density / 0.0254));
+        break;
+    case 2: // Dots per centimeter
+        image.setDotsPerMeterX(cinfo.X_density * 100);
+        image.setDotsPerMeterY(cinfo.Y_density * 100);
+        break;
+    }
+    if (orientation >= TRANSPOSE) {
+        const int dpmX = image.dotsPerMeterX();
+        image.setDotsPerMeterX(image.dotsPerMeterY());
+        image.setDotsPerMeterY(dpmX);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+
+    // DCT scaling only goes down to powers of 2 not smaller than scaledSize,
+    // scale the rest of the way like QImageReader does
+    if (scaledSize.isValid() && size != scaledSize) {
+        const QSize targetSize = orientation >= TRANSPOSE ? scaledSize.transposed() : scaledSize;
+        LOG("Scaling to" << targetSize);
+        image = image.scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    *outImage = image;
+    return true;
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,69 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef ORIENTEDJPEGDECODER_H
+#define ORIENTEDJPEGDECODER_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+
+// KDE
+
+// Local
+#include <lib/orientation.h>
+
+class QImage;
+class QIODevice;
+class QSize;
+
+namespace Gwenview
+{
+
+/**
+ * Decodes JPEG images directly in the layout required by an orientation.
+ *
+ * QImageReader::setAutoTransform() decodes the whole image, then allocates a
+ * second buffer to rotate it. Here decoded scanlines are moved to their place
+ * in the rotated image a few rows at a time, so only one full size buffer is
+ * ever allocated.
+ */
+namespace OrientedJpegDecoder
+{
+
+/**
+ * Decodes the JPEG image from @p device into @p image, transformed by
+ * @p orientation.
+ *
+ * If @p scaledSize is valid, the image is down scaled to it: as much as
+ * possible with libjpeg DCT scaling, then with a smooth transformation for the
+ * remaining factor. Like QImageReader::setScaledSize(), @p scaledSize is the
+ * size before the orientation is applied.
+ *
+ * Returns false if the image could not be decoded, or if it uses a color
+ * space this decoder does not handle (CMYK). In this case callers should fall
+ * back to QImageReader.
+ */
+GWENVIEWLIB_EXPORT bool read(QIODevice* device, Orientation orientation, const QSize& scaledSize, QImage* image);
+
+} // namespace
+} // namespace
+
+#endif /* ORIENTEDJPEGDECODER_H */
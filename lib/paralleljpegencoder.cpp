@@ -0,0 +1,277 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "paralleljpegencoder.h"
+
+// Qt
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+#include "gwenview_lib_debug.h"
+
+// Local
+#include "jpegerrormanager.h"
+#include "pixelkernels.h"
+
+namespace Gwenview
+{
+
+#undef ENABLE_LOG
+#undef LOG
+//#define ENABLE_LOG
+#ifdef ENABLE_LOG
+#define LOG(x) qCDebug(GWENVIEW_LIB_LOG) << x
+#else
+#define LOG(x) ;
+#endif
+
+namespace ParallelJpegEncoder
+{
+
+// Under this amount of pixels, QImageWriter is fast enough
+static const qint64 MIN_PIXEL_COUNT = 1024 * 1024;
+
+// Restart markers are numbered modulo 8: stripes start on a multiple of this
+// amount of MCU rows so that the markers they contain keep their numbers
+static const int RESTART_MARKER_CYCLE = 8;
+
+static const int OUTPUT_CHUNK_SIZE = 64 * 1024;
+
+static const uchar MARKER_SOF0 = 0xC0;
+static const uchar MARKER_RST0 = 0xD0;
+static const uchar MARKER_EOI = 0xD9;
+static const uchar MARKER_SOS = 0xDA;
+
+/**
+ * A libjpeg destination manager which writes to a QByteArray
+ */
+struct ByteArrayDestinationManager : public jpeg_destination_mgr
+{
+    QByteArray* mOutput;
+
+    static void setup(j_compress_ptr cinfo, QByteArray* output)
+    {
+        auto* manager = static_cast<ByteArrayDestinationManager*>(
+                            (*cinfo->mem->alloc_small)((j_common_ptr) cinfo, JPOOL_PERMANENT,
+                                    sizeof(ByteArrayDestinationManager)));
+        manager->init_destination = initDestination;
+        manager->empty_output_buffer = emptyOutputBuffer;
+        manager->term_destination = termDestination;
+        manager->mOutput = output;
+        cinfo->dest = manager;
+    }
+
+    static void initDestination(j_compress_ptr cinfo)
+    {
+        auto* manager = static_cast<ByteArrayDestinationManager*>(cinfo->dest);
+        manager->mOutput->resize(OUTPUT_CHUNK_SIZE);
+        manager->next_output_byte = reinterpret_cast<JOCTET*>(manager->mOutput->data());
+        manager->free_in_buffer = manager->mOutput->size();
+    }
+
+    static boolean emptyOutputBuffer(j_compress_ptr cinfo)
+    {
+        // libjpeg only calls us when the whole buffer is full
+        auto* manager = static_cast<ByteArrayDestinationManager*>(cinfo->dest);
+        const int size = manager->mOutput->size();
+        manager->mOutput->resize(size * 2);
+        manager->next_output_byte = reinterpret_cast<JOCTET*>(manager->mOutput->data() + size);
+        manager->free_in_buffer = size;
+        return true;
+    }
+
+    static void termDestination(j_compress_ptr cinfo)
+    {
+        auto* manager = static_cast<ByteArrayDestinationManager*>(cinfo->dest);
+        manager->mOutput->resize(manager->next_output_byte - reinterpret_cast<JOCTET*>(manager->mOutput->data()));
+    }
+};
+
+/**
+ * Encodes rows [firstRow, firstRow + rowCount[ of @p image as a JPEG image
+ * with a restart marker after each MCU row. @p image must be either
+ * Format_Grayscale8 or one of the 32-bit RGB formats.
+ */
+static bool encodeRows(const QImage& image, int firstRow, int rowCount, int quality, QByteArray* output)
+{
+    struct jpeg_compress_struct cinfo;
+    // Declared before setjmp() so that it is released if libjpeg fails
+    QVector<JSAMPLE> scanline;
+
+    JPEGErrorManager errorManager;
+    cinfo.err = &errorManager;
+    jpeg_create_compress(&cinfo);
+    if (setjmp(errorManager.jmp_buffer)) {
+        qCWarning(GWENVIEW_LIB_LOG) << "libjpeg error, could not encode rows" << firstRow << "to" << firstRow + rowCount;
+        jpeg_destroy_compress(&cinfo);
+        return false;
+    }
+
+    ByteArrayDestinationManager::setup(&cinfo, output);
+    const bool grayscale = image.format() == QImage::Format_Grayscale8;
+    cinfo.image_width = image.width();
+    cinfo.image_height = rowCount;
+    cinfo.input_components = grayscale ? 1 : 3;
+    cinfo.in_color_space = grayscale ? JCS_GRAYSCALE : JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, quality, true /* force baseline */);
+    // Stripes are stitched behind the header of the first one: they must
+    // all use the same, standard, Huffman tables
+    cinfo.optimize_coding = false;
+    cinfo.restart_in_rows = 1;
+    cinfo.density_unit = 1; // Dots per inch
+    cinfo.X_density = qRound(image.dotsPerMeterX() * 0.0254);
+    cinfo.Y_density = qRound(image.dotsPerMeterY() * 0.0254);
+    jpeg_start_compress(&cinfo, true);
+
+    if (!grayscale) {
+        scanline.resize(image.width() * 3);
+    }
+    for (int y = firstRow; y < firstRow + rowCount; ++y) {
+        JSAMPROW row;
+        if (grayscale) {
+            row = const_cast<JSAMPROW>(image.constScanLine(y));
+        } else {
+            const QRgb* src = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            JSAMPLE* dst = scanline.data();
+            for (int x = 0; x < image.width(); ++x, dst += 3) {
+                dst[0] = qRed(src[x]);
+                dst[1] = qGreen(src[x]);
+                dst[2] = qBlue(src[x]);
+            }
+            row = scanline.data();
+        }
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return true;
+}
+
+/**
+ * Finds the SOF0 marker segment in @p data and the offset at which the
+ * entropy-coded data starts, right after the SOS marker segment
+ */
+static bool findSegments(const QByteArray& data, int* sofOffset, int* scanOffset)
+{
+    const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+    const int size = data.size();
+    if (size < 4 || bytes[size - 2] != 0xFF || bytes[size - 1] != MARKER_EOI) {
+        return false;
+    }
+    *sofOffset = -1;
+    // Skip SOI
+    int pos = 2;
+    while (pos + 4 <= size && bytes[pos] == 0xFF) {
+        const uchar marker = bytes[pos + 1];
+        const int length = (bytes[pos + 2] << 8) | bytes[pos + 3];
+        if (marker == MARKER_SOF0) {
+            *sofOffset = pos;
+        }
+        pos += 2 + length;
+        if (marker == MARKER_SOS) {
+            *scanOffset = pos;
+            return *sofOffset >= 0 && pos <= size - 2;
+        }
+    }
+    return false;
+}
+
+QByteArray encode(const QImage& sourceImage, int quality)
+{
+    if (qint64(sourceImage.width()) * sourceImage.height() < MIN_PIXEL_COUNT
+            || sourceImage.width() > JPEG_MAX_DIMENSION || sourceImage.height() > JPEG_MAX_DIMENSION) {
+        return QByteArray();
+    }
+
+    QImage image = sourceImage;
+    switch (image.format()) {
+    case QImage::Format_Grayscale8:
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        break;
+    default:
+        image = image.convertToFormat(image.isGrayscale() ? QImage::Format_Grayscale8 : QImage::Format_RGB32);
+        break;
+    }
+
+    // jpeg_set_defaults() uses 2x2 luminance sampling for color images,
+    // grayscale images have a single, 8x8 sampled, component
+    const int mcuHeight = image.format() == QImage::Format_Grayscale8 ? 8 : 16;
+    const int cycleHeight = mcuHeight * RESTART_MARKER_CYCLE;
+    const int cycleCount = (image.height() + cycleHeight - 1) / cycleHeight;
+
+    QMutex mutex;
+    QMap<int, QByteArray> stripes;
+    bool ok = true;
+    PixelKernels::forEachStripe(cycleCount, image.width() * cycleHeight, [&](int firstCycle, int endCycle) {
+        const int firstRow = firstCycle * cycleHeight;
+        const int endRow = qMin(endCycle * cycleHeight, image.height());
+        QByteArray data;
+        const bool stripeOk = encodeRows(image, firstRow, endRow - firstRow, quality, &data);
+        QMutexLocker locker(&mutex);
+        ok = ok && stripeOk;
+        stripes.insert(firstRow, data);
+    });
+    if (!ok) {
+        return QByteArray();
+    }
+    LOG("Encoded" << stripes.size() << "stripes");
+
+    int totalSize = 0;
+    for (const QByteArray& data : qAsConst(stripes)) {
+        totalSize += data.size();
+    }
+    QByteArray output;
+    output.reserve(totalSize);
+    for (auto it = stripes.constBegin(), end = stripes.constEnd(); it != end; ++it) {
+        const QByteArray& data = it.value();
+        int sofOffset, scanOffset;
+        if (!findSegments(data, &sofOffset, &scanOffset)) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Unexpected layout in encoded stripe";
+            return QByteArray();
+        }
+        if (it == stripes.constBegin()) {
+            // Use the header of the first stripe, with the height of the
+            // whole image
+            output.append(data.constData(), scanOffset);
+            output[sofOffset + 5] = char(image.height() >> 8);
+            output[sofOffset + 6] = char(image.height() & 0xFF);
+        } else {
+            // The restart marker a single encoder would have written before
+            // this MCU row
+            const int mcuRow = it.key() / mcuHeight;
+            output.append(char(0xFF));
+            output.append(char(MARKER_RST0 + (mcuRow - 1) % 8));
+        }
+        // Entropy-coded data, without the EOI marker
+        output.append(data.constData() + scanOffset, data.size() - scanOffset - 2);
+    }
+    output.append(char(0xFF));
+    output.append(char(MARKER_EOI));
+    return output;
+}
+
+} // namespace
+} // namespace
@@ -0,0 +1,66 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef PARALLELJPEGENCODER_H
+#define PARALLELJPEGENCODER_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QByteArray>
+
+// KDE
+
+// Local
+
+class QImage;
+
+namespace Gwenview
+{
+
+/**
+ * Encodes big images to baseline JPEG on several threads.
+ *
+ * The image is encoded with a restart marker at the end of each MCU row.
+ * Stripes of MCU rows are encoded separately by PixelKernels, then their
+ * entropy-coded data is concatenated behind a single header. Stripes start
+ * on a multiple of 8 MCU rows, so the numbers of the restart markers inside
+ * each stripe are the ones a single encoder would have written, and the
+ * result is the same as if the image had been encoded in one go.
+ *
+ * Like QImageWriter, the encoder uses the standard Huffman tables and 4:2:0
+ * chroma subsampling. Metadata is not written, JpegContent adds it.
+ */
+namespace ParallelJpegEncoder
+{
+
+/**
+ * Returns @p image encoded with @p quality (0 to 100).
+ *
+ * Returns a null array if the image is too small for parallel encoding to
+ * be worth it, or if it could not be encoded. Callers should then use
+ * QImageWriter.
+ */
+GWENVIEWLIB_EXPORT QByteArray encode(const QImage& image, int quality);
+
+} // namespace
+} // namespace
+
+#endif /* PARALLELJPEGENCODER_H */
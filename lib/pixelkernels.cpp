@@ -0,0 +1,62 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+// Self
+#include "pixelkernels.h"
+
+// Qt
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+namespace Gwenview
+{
+namespace PixelKernels
+{
+
+// Under this amount of pixels per stripe, splitting the work costs more than
+// it brings
+static const int MIN_PIXELS_PER_STRIPE = 256 * 256;
+
+void forEachStripe(int rowCount, int rowWidth, const std::function<void(int, int)>& function)
+{
+    if (rowCount <= 0 || rowWidth <= 0) {
+        return;
+    }
+    const qint64 pixelCount = qint64(rowCount) * rowWidth;
+    const int stripeCount = qBound(1, int(pixelCount / MIN_PIXELS_PER_STRIPE), QThread::idealThreadCount() * 2);
+    if (stripeCount == 1) {
+        function(0, rowCount);
+        return;
+    }
+    // Use a few more stripes than threads, so that a thread which gets
+    // preempted does not hold everybody else back
+    const int stripeHeight = (rowCount + stripeCount - 1) / stripeCount;
+    QVector<int> stripes;
+    for (int row = 0; row < rowCount; row += stripeHeight) {
+        stripes << row;
+    }
+    QtConcurrent::blockingMap(stripes, [&](int firstRow) {
+        function(firstRow, qMin(firstRow + stripeHeight, rowCount));
+    });
+}
+
+} // namespace
+} // namespace
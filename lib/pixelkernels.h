@@ -0,0 +1,101 @@
+// vim: set tabstop=4 shiftwidth=4 expandtab:
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include <lib/gwenviewlib_export.h>
+
+// Qt
+#include <QImage>
+#include <QRect>
+
+// STL
+#include <functional>
+
+namespace Gwenview
+{
+
+/**
+ * Helpers to run per-row and per-pixel kernels over an image.
+ *
+ * Kernels get raw scanline pointers, so that their inner loops work on plain
+ * arrays the compiler can vectorize. Rows are split in stripes which are
+ * processed in parallel on the global thread pool, so a kernel must only
+ * write to the row it is given.
+ *
+ * These helpers block until all rows have been processed. They are meant to
+ * be called from ThreadedDocumentJob::threadedStart(), or from any code which
+ * already runs outside of the GUI thread.
+ */
+namespace PixelKernels
+{
+
+/**
+ * Calls @p function(firstRow, endRow) on consecutive stripes covering rows
+ * [0, rowCount[. Stripes only run in parallel when there are enough pixels
+ * for it to be worth it. The calling thread takes its share of the work.
+ */
+GWENVIEWLIB_EXPORT void forEachStripe(int rowCount, int rowWidth, const std::function<void(int, int)>& function);
+
+/**
+ * Runs @p kernel on each row of @p rect in @p image. The kernel is called as
+ * kernel(uchar* line, int x, int y, int width): @p line points at pixel
+ * (x, y), and @p width pixels must be processed from there.
+ */
+template<typename RowKernel>
+void forEachRow(QImage* image, const QRect& rect, RowKernel kernel)
+{
+    const QRect r = rect.intersected(image->rect());
+    if (r.isEmpty()) {
+        return;
+    }
+    // bits() detaches the image: call it once, before going parallel
+    uchar* bits = image->bits();
+    const qptrdiff stride = image->bytesPerLine();
+    const int offset = r.left() * image->depth() / 8;
+    forEachStripe(r.height(), r.width(), [&](int firstRow, int endRow) {
+        for (int row = firstRow; row < endRow; ++row) {
+            const int y = r.top() + row;
+            kernel(bits + y * stride + offset, r.left(), y, r.width());
+        }
+    });
+}
+
+/**
+ * Runs @p kernel on each pixel of @p rect in @p image, which must be a 32-bit
+ * image. The kernel is called as kernel(QRgb& pixel, int x, int y).
+ */
+template<typename PixelKernel>
+void forEachPixel(QImage* image, const QRect& rect, PixelKernel kernel)
+{
+    Q_ASSERT(image->depth() == 32);
+    forEachRow(image, rect, [&](uchar* line, int x0, int y, int width) {
+        QRgb* ptr = reinterpret_cast<QRgb*>(line);
+        for (int x = x0; x < x0 + width; ++x, ++ptr) {
+            kernel(*ptr, x, y);
+        }
+    });
+}
+
+} // namespace
+} // namespace
+
+#endif /* PIXELKERNELS_H */
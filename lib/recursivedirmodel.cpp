@@ -27,8 +27,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 // KDE
 #include <KDirLister>
 #include <KDirModel>
+#include <KDirWatch>
 
 // Qt
+#include <QDir>
+#include <QSet>
 #include "gwenview_lib_debug.h"
 
 namespace Gwenview
@@ -36,6 +39,11 @@ namespace Gwenview
 
 struct RecursiveDirModelPrivate {
     KDirLister* mDirLister;
+    LocalDirWalker* mWalker;
+    KDirWatch* mDirWatch;
+    QUrl mUrl;
+    // Local dirs which have been listed, they are all watched
+    QSet<QString> mListedDirs;
 
     int rowForUrl(const QUrl &url) const
     {
@@ -90,6 +98,12 @@ RecursiveDirModel::RecursiveDirModel(QObject* parent)
     connect(d->mDirLister, QOverload<>::of(&KDirLister::completed), this, &RecursiveDirModel::completed);
     connect(d->mDirLister, QOverload<>::of(&KDirLister::clear), this, &RecursiveDirModel::slotCleared);
     connect(d->mDirLister, QOverload<const QUrl &>::of(&KDirLister::clear), this, &RecursiveDirModel::slotDirCleared);
+
+    d->mWalker = new LocalDirWalker(this);
+    connect(d->mWalker, &LocalDirWalker::dirsListed, this, &RecursiveDirModel::slotDirsListed);
+    connect(d->mWalker, &LocalDirWalker::finished, this, &RecursiveDirModel::completed);
+
+    d->mDirWatch = nullptr;
 }
 
 RecursiveDirModel::~RecursiveDirModel()
@@ -99,7 +113,7 @@ RecursiveDirModel::~RecursiveDirModel()
 
 QUrl RecursiveDirModel::url() const
 {
-    return d->mDirLister->url();
+    return d->mUrl;
 }
 
 void RecursiveDirModel::setUrl(const QUrl &url)
@@ -107,7 +121,23 @@ void RecursiveDirModel::setUrl(const QUrl &url)
     beginResetModel();
     d->clear();
     endResetModel();
-    d->mDirLister->openUrl(url);
+    d->mUrl = url;
+
+    d->mWalker->cancel();
+    d->mDirLister->stop();
+    d->mListedDirs.clear();
+    // Recreating the watcher is the simplest way to stop watching all dirs
+    delete d->mDirWatch;
+    d->mDirWatch = nullptr;
+
+    if (url.isLocalFile()) {
+        d->mDirWatch = new KDirWatch(this);
+        connect(d->mDirWatch, &KDirWatch::dirty, this, &RecursiveDirModel::slotDirDirty);
+        connect(d->mDirWatch, &KDirWatch::deleted, this, &RecursiveDirModel::slotDirDeleted);
+        d->mWalker->start(QDir::cleanPath(url.toLocalFile()), true);
+    } else {
+        d->mDirLister->openUrl(url);
+    }
 }
 
 int RecursiveDirModel::rowCount(const QModelIndex& parent) const
@@ -143,27 +173,41 @@ QVariant RecursiveDirModel::data(const QModelIndex& index, int role) const
     return QVariant();
 }
 
+void RecursiveDirModel::addItems(const KFileItemList& list)
+{
+    KFileItemList newList;
+    QSet<QUrl> newUrls;
+    for (const KFileItem& item : list) {
+        const QUrl url = item.url();
+        if (d->rowForUrl(url) == -1 && !newUrls.contains(url)) {
+            newUrls << url;
+            newList << item;
+        }
+    }
+    if (newList.isEmpty()) {
+        return;
+    }
+    const int count = d->list().count();
+    beginInsertRows(QModelIndex(), count, count + newList.count() - 1);
+    for (const KFileItem& item : qAsConst(newList)) {
+        d->addItem(item);
+    }
+    endInsertRows();
+}
+
 void RecursiveDirModel::slotItemsAdded(const QUrl&, const KFileItemList& newList)
 {
     QList<QUrl> dirUrls;
     KFileItemList fileList;
     for (const KFileItem& item : newList) {
         if (item.isFile()) {
-            if (d->rowForUrl(item.url()) == -1) {
-                fileList << item;
-            }
+            fileList << item;
         } else {
             dirUrls << item.url();
         }
     }
 
-    if (!fileList.isEmpty()) {
-        beginInsertRows(QModelIndex(), d->list().count(), d->list().count() + fileList.count());
-        for (const KFileItem& item : qAsConst(fileList)) {
-            d->addItem(item);
-        }
-        endInsertRows();
-    }
+    addItems(fileList);
 
     for (const QUrl &url : qAsConst(dirUrls)) {
         d->mDirLister->openUrl(url, KDirLister::Keep);
@@ -211,4 +255,78 @@ void RecursiveDirModel::slotDirCleared(const QUrl &dirUrl)
     }
 }
 
+void RecursiveDirModel::slotDirsListed(const QList<LocalDirWalker::DirListing>& listings)
+{
+    // Insert the files of all dirs at once
+    KFileItemList fileList;
+    for (const LocalDirWalker::DirListing& listing : listings) {
+        fileList += listing.files;
+        if (!d->mListedDirs.contains(listing.path)) {
+            d->mListedDirs << listing.path;
+            d->mDirWatch->addDir(listing.path);
+            continue;
+        }
+
+        // This dir changed: remove what is gone, walk new subdirs
+        const QString prefix = listing.path + QLatin1Char('/');
+        QSet<QUrl> urls;
+        for (const KFileItem& item : listing.files) {
+            urls << item.url();
+        }
+        for (int row = d->list().count() - 1; row >= 0; --row) {
+            const QUrl url = d->list().at(row).url();
+            const QString path = url.toLocalFile();
+            if (path.startsWith(prefix) && path.indexOf(QLatin1Char('/'), prefix.length()) == -1 && !urls.contains(url)) {
+                beginRemoveRows(QModelIndex(), row, row);
+                d->removeAt(row);
+                endRemoveRows();
+            }
+        }
+
+        const QSet<QString> subDirPaths = listing.subDirPaths.toSet();
+        const QSet<QString> listedDirs = d->mListedDirs;
+        for (const QString& path : listedDirs) {
+            if (path.startsWith(prefix) && path.indexOf(QLatin1Char('/'), prefix.length()) == -1 && !subDirPaths.contains(path)) {
+                removeLocalDir(path);
+            }
+        }
+        for (const QString& path : listing.subDirPaths) {
+            if (!d->mListedDirs.contains(path)) {
+                // Watch it right away so that files added while it is being
+                // listed are not missed. Its own subdirs are handled when
+                // its listing comes back here.
+                d->mListedDirs << path;
+                d->mDirWatch->addDir(path);
+                d->mWalker->start(path, false);
+            }
+        }
+    }
+    addItems(fileList);
+}
+
+void RecursiveDirModel::slotDirDirty(const QString& path)
+{
+    if (d->mListedDirs.contains(path)) {
+        d->mWalker->start(path, false);
+    }
+}
+
+void RecursiveDirModel::slotDirDeleted(const QString& path)
+{
+    removeLocalDir(path);
+}
+
+void RecursiveDirModel::removeLocalDir(const QString& dirPath)
+{
+    slotDirCleared(QUrl::fromLocalFile(dirPath));
+    const QString prefix = dirPath + QLatin1Char('/');
+    const QSet<QString> listedDirs = d->mListedDirs;
+    for (const QString& path : listedDirs) {
+        if (path == dirPath || path.startsWith(prefix)) {
+            d->mListedDirs.remove(path);
+            d->mDirWatch->removeDir(path);
+        }
+    }
+}
+
 } // namespace
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 // Local
 #include <lib/gwenviewlib_export.h>
+#include <lib/localdirwalker.h>
 
 // KDE
 #include <KFileItem>
@@ -38,6 +39,9 @@ namespace Gwenview
 struct RecursiveDirModelPrivate;
 /**
  * Recursively list content of a dir
+ *
+ * Local dirs are listed in parallel by LocalDirWalker and watched with
+ * KDirWatch, other dirs are listed with KDirLister.
  */
 class GWENVIEWLIB_EXPORT RecursiveDirModel : public QAbstractListModel
 {
@@ -60,8 +64,14 @@ private Q_SLOTS:
     void slotItemsDeleted(const KFileItemList&);
     void slotDirCleared(const QUrl&);
     void slotCleared();
+    void slotDirsListed(const QList<LocalDirWalker::DirListing>&);
+    void slotDirDirty(const QString& path);
+    void slotDirDeleted(const QString& path);
 private:
     RecursiveDirModelPrivate* const d;
+
+    void addItems(const KFileItemList&);
+    void removeLocalDir(const QString& path);
 };
 
 } // namespace
@@ -22,11 +22,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "redeyereductionimageoperation.h"
 
 // Stdc
+#include <limits.h>
 #include <math.h>
 
 // Qt
 #include <QImage>
-#include <QPainter>
+#include <QTransform>
 #include "gwenview_lib_debug.h"
 
 // KDE
@@ -37,7 +38,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "document/document.h"
 #include "document/documentjob.h"
 #include "document/abstractdocumenteditor.h"
-#include "paintutils.h"
+#include "document/editchain.h"
+#include "pixelkernels.h"
 
 namespace Gwenview
 {
@@ -54,9 +56,11 @@ public:
         if (!checkDocumentEditor()) {
             return;
         }
-        QImage img = document()->image();
-        RedEyeReductionImageOperation::apply(&img, mRectF);
-        document()->editor()->setImage(img);
+        const QRectF rectF = mRectF;
+        document()->editor()->applyEdit(ImageEdit::pixelFunction(
+            [rectF](QImage* image, const QTransform& matrix) {
+                RedEyeReductionImageOperation::apply(image, matrix.mapRect(rectF));
+            }));
         setError(NoError);
     }
 
@@ -67,7 +71,6 @@ private:
 struct RedEyeReductionImageOperationPrivate
 {
     QRectF mRectF;
-    QImage mOriginalImage;
 };
 
 RedEyeReductionImageOperation::RedEyeReductionImageOperation(const QRectF& rectF)
@@ -84,9 +87,6 @@ RedEyeReductionImageOperation::~RedEyeReductionImageOperation()
 
 void RedEyeReductionImageOperation::redo()
 {
-    QImage img = document()->image();
-    QRect rect = d->mRectF.toAlignedRect();
-    d->mOriginalImage = img.copy(rect);
     redoAsDocumentJob(new RedEyeReductionJob(d->mRectF));
 }
 
@@ -96,14 +96,7 @@ void RedEyeReductionImageOperation::undo()
         qCWarning(GWENVIEW_LIB_LOG) << "!document->editor()";
         return;
     }
-    QImage img = document()->image();
-    {
-        QPainter painter(&img);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-        QRect rect = d->mRectF.toAlignedRect();
-        painter.drawImage(rect.topLeft(), d->mOriginalImage);
-    }
-    document()->editor()->setImage(img);
+    document()->editor()->revertLastEdit();
     finish(true);
 }
 
@@ -111,10 +104,32 @@ void RedEyeReductionImageOperation::undo()
  * This code is inspired from code found in a Paint.net plugin:
  * http://paintdotnet.forumer.com/viewtopic.php?f=27&t=26193&p=205954&hilit=red+eye#p205954
  */
-inline qreal computeRedEyeAlpha(const QColor& src)
+inline qreal computeRedEyeAlpha(int r, int g, int b)
 {
-    int hue, sat, value;
-    src.getHsv(&hue, &sat, &value);
+    // Same hue and saturation as QColor::getHsv(), without creating a QColor
+    // for each pixel
+    const int max = qMax(r, qMax(g, b));
+    const int min = qMin(r, qMin(g, b));
+    const int delta = max - min;
+    if (delta == 0) {
+        // Gray pixel: no saturation, nothing to reduce
+        return 0;
+    }
+    const int sat = qRound(qreal(delta) / max * USHRT_MAX) >> 8;
+
+    qreal hueF;
+    if (r == max) {
+        hueF = qreal(g - b) / delta;
+    } else if (g == max) {
+        hueF = 2 + qreal(b - r) / delta;
+    } else {
+        hueF = 4 + qreal(r - g) / delta;
+    }
+    hueF *= 60;
+    if (hueF < 0) {
+        hueF += 360;
+    }
+    const int hue = qRound(hueF * 100) / 100;
 
     qreal axs = 1.0;
     if (hue > 259) {
@@ -125,11 +140,19 @@ inline qreal computeRedEyeAlpha(const QColor& src)
         axs = ramp(sat);
     }
 
-    return qBound(qreal(0.), src.alphaF() * axs, qreal(1.));
+    return qBound(qreal(0.), axs, qreal(1.));
 }
 
 void RedEyeReductionImageOperation::apply(QImage* img, const QRectF& rectF)
 {
+    if (img->depth() != 32) {
+        // Documents can be kept in compact formats. There is no red to
+        // reduce in a grayscale image, convert the others.
+        if (img->format() == QImage::Format_Grayscale8) {
+            return;
+        }
+        *img = img->convertToFormat(img->hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    }
     const QRect rect = rectF.toAlignedRect();
     const qreal radius = rectF.width() / 2;
     const qreal centerX = rectF.x() + radius;
@@ -137,31 +160,35 @@ void RedEyeReductionImageOperation::apply(QImage* img, const QRectF& rectF)
     const Ramp radiusRamp(
         qMin(qreal(radius * 0.7), qreal(radius - 1)), radius,
         qreal(1.), qreal(0.));
-
-    uchar* line = img->scanLine(rect.top()) + rect.left() * 4;
-    for (int y = rect.top(); y < rect.bottom(); ++y, line += img->bytesPerLine()) {
-        QRgb* ptr = (QRgb*)line;
-
-        for (int x = rect.left(); x < rect.right(); ++x, ++ptr) {
-            const qreal currentRadius = sqrt(pow(y - centerY, 2) + pow(x - centerX, 2));
-            qreal alpha = radiusRamp(currentRadius);
+    const qreal radius2 = radius * radius;
+
+    // Like the implementation this replaces, stop before rect.right() and
+    // rect.bottom(), so that the same pixels are modified
+    PixelKernels::forEachRow(img, rect.adjusted(0, 0, -1, -1), [&](uchar* line, int x0, int y, int width) {
+        QRgb* ptr = reinterpret_cast<QRgb*>(line);
+        const qreal dy2 = (y - centerY) * (y - centerY);
+        for (int x = x0; x < x0 + width; ++x, ++ptr) {
+            const qreal dx = x - centerX;
+            const qreal currentRadius2 = dx * dx + dy2;
+            if (currentRadius2 >= radius2) {
+                continue;
+            }
+            qreal alpha = radiusRamp(sqrt(currentRadius2));
             if (qFuzzyCompare(alpha, 0)) {
                 continue;
             }
 
-            const QColor src(*ptr);
-            alpha *= computeRedEyeAlpha(src);
-            int r = src.red();
-            int g = src.green();
-            int b = src.blue();
-            QColor dst;
-            // Replace red with green, and blend according to alpha
-            dst.setRed(int((1 - alpha) * r + alpha * g));
-            dst.setGreen(g);
-            dst.setBlue(b);
-            *ptr = dst.rgba();
+            const QRgb src = *ptr;
+            const int r = qRed(src);
+            const int g = qGreen(src);
+            const int b = qBlue(src);
+            alpha *= computeRedEyeAlpha(r, g, b);
+            // Replace red with green, and blend according to alpha. Green
+            // and red are both premultiplied or both not, so the alpha
+            // channel can be kept as is.
+            *ptr = qRgba(int((1 - alpha) * r + alpha * g), g, b, qAlpha(src));
         }
-    }
+    });
 }
 
 } // namespace
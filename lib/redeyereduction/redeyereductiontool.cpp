@@ -124,7 +124,7 @@ void RedEyeReductionTool::paint(QPainter* painter)
     imageView()->document()->waitUntilLoaded();
 
     QRect docRect = docRectF.toAlignedRect();
-    QImage img = imageView()->document()->image().copy(docRect);
+    QImage img = imageView()->document()->imageRect(docRect);
     QRectF imgRectF(
         docRectF.left() - docRect.left(),
         docRectF.top()  - docRect.top(),
@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include "document/abstractdocumenteditor.h"
 #include "document/document.h"
 #include "document/documentjob.h"
+#include "document/editchain.h"
 
 namespace Gwenview
 {
@@ -39,7 +40,6 @@ namespace Gwenview
 struct ResizeImageOperationPrivate
 {
     QSize mSize;
-    QImage mOriginalImage;
 };
 
 class ResizeJob : public ThreadedDocumentJob
@@ -54,9 +54,7 @@ public:
         if (!checkDocumentEditor()) {
             return;
         }
-        QImage image = document()->image();
-        image = image.scaled(mSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-        document()->editor()->setImage(image);
+        document()->editor()->applyEdit(ImageEdit::resize(mSize));
         setError(NoError);
     }
 
@@ -78,7 +76,6 @@ ResizeImageOperation::~ResizeImageOperation()
 
 void ResizeImageOperation::redo()
 {
-    d->mOriginalImage = document()->image();
     redoAsDocumentJob(new ResizeJob(d->mSize));
 }
 
@@ -88,7 +85,7 @@ void ResizeImageOperation::undo()
         qCWarning(GWENVIEW_LIB_LOG) << "!document->editor()";
         return;
     }
-    document()->editor()->setImage(d->mOriginalImage);
+    document()->editor()->revertLastEdit();
     finish(true);
 }
 
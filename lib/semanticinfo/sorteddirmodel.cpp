@@ -21,7 +21,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <config-gwenview.h>
 
 // Qt
+#include <QCollator>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QSet>
 #include <QTimer>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include "gwenview_lib_debug.h"
 #include <QUrl>
 
@@ -30,7 +36,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 
 // Local
-#include <lib/archiveutils.h>
+#include <lib/dirsnapshot.h>
 #include <lib/timeutils.h>
 #ifdef GWENVIEW_SEMANTICINFO_BACKEND_NONE
 #include <KDirModel>
@@ -59,8 +65,55 @@ AbstractSortedDirModelFilter::~AbstractSortedDirModelFilter()
     }
 }
 
+/**
+ * Returns the kind of @p item. The dir lister does not determine MIME types
+ * from the content of files: only do it for files whose name is not enough.
+ */
+static MimeTypeUtils::Kind itemKind(const KFileItem& item)
+{
+    if (!item.isMimeTypeKnown() && item.mimetype() == QLatin1String("application/octet-stream")) {
+        item.determineMimeType();
+    }
+    return MimeTypeUtils::fileItemKind(item);
+}
+
+/**
+ * What filterAcceptsRow() and lessThan() need to know about an item, computed
+ * once per item
+ */
+struct SortKey
+{
+    MimeTypeUtils::Kind mKind;
+    bool mDirOrArchive;
+    bool mHidden;
+    int mRating;
+    QDateTime mTime;
+    // Same as mTime until the capture date has been read
+    QDateTime mDate;
+    bool mHasCaptureDate;
+};
+
+/**
+ * Small dirs are listed quickly anyway, do not keep snapshots of them
+ */
+static const int SNAPSHOT_MIN_ITEM_COUNT = 100;
+
+struct CaptureDateRequest
+{
+    const void* mNode;
+    QUrl mUrl;
+    QDateTime mTime;
+    qint64 mSize;
+};
+
+static QDateTime readCaptureDate(const CaptureDateRequest& request)
+{
+    return TimeUtils::dateTimeForFile(request.mUrl, request.mTime, request.mSize);
+}
+
 struct SortedDirModelPrivate
 {
+    SortedDirModel* q;
 #ifdef GWENVIEW_SEMANTICINFO_BACKEND_NONE
     KDirModel* mSourceModel;
 #else
@@ -70,6 +123,205 @@ struct SortedDirModelPrivate
     QList<AbstractSortedDirModelFilter*> mFilters;
     QTimer mDelayedApplyFiltersTimer;
     MimeTypeUtils::Kinds mKindFilter;
+
+    // Sort keys of the source items, keyed by the internal pointer of their
+    // index, which identifies a KDirModel item for its whole life
+    QHash<const void*, SortKey> mSortKeys;
+    QHash<const void*, QCollatorSortKey> mNameKeys;
+    // Items whose capture date is being read
+    QSet<const void*> mPendingCaptureDates;
+    // Incremented when the keys are reset, to ignore outdated results
+    int mSortKeyGeneration;
+    QCollator mCollator;
+
+    // What was known about the items of the listed dir the last time it was
+    // listed
+    QUrl mSnapshotUrl;
+    DirSnapshot::Entries mSnapshot;
+
+    SortKey computeSortKey(const QModelIndex& sourceIndex, const KFileItem& item) const
+    {
+        SortKey key;
+        key.mHidden = item.isHidden();
+#ifdef GWENVIEW_SEMANTICINFO_BACKEND_NONE
+        key.mRating = 0;
+#else
+        key.mRating = mSourceModel->data(sourceIndex, SemanticInfoDirModel::RatingRole).toInt();
+#endif
+        key.mTime = item.time(KFileItem::ModificationTime);
+        key.mDate = key.mTime;
+        key.mHasCaptureDate = false;
+
+        const auto snapshotIt = sourceIndex.parent().isValid()
+            ? mSnapshot.constEnd()
+            : mSnapshot.constFind(item.name());
+        if (snapshotIt != mSnapshot.constEnd()
+            && snapshotIt->mtime == key.mTime
+            && snapshotIt->size == qint64(item.size())) {
+            key.mKind = snapshotIt->kind;
+            if (snapshotIt->hasCaptureDate) {
+                key.mDate = snapshotIt->captureDate;
+                key.mHasCaptureDate = true;
+            }
+        } else {
+            key.mKind = itemKind(item);
+        }
+        key.mDirOrArchive = item.isDir()
+            || key.mKind == MimeTypeUtils::KIND_DIR
+            || key.mKind == MimeTypeUtils::KIND_ARCHIVE;
+        return key;
+    }
+
+    SortKey sortKey(const QModelIndex& sourceIndex) const
+    {
+        const auto it = mSortKeys.constFind(sourceIndex.internalPointer());
+        if (it != mSortKeys.constEnd()) {
+            return it.value();
+        }
+        return computeSortKey(sourceIndex, mSourceModel->itemForIndex(sourceIndex));
+    }
+
+    void updateSortKeys(const QModelIndex& parent, int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            const QModelIndex index = mSourceModel->index(row, 0, parent);
+            const KFileItem item = mSourceModel->itemForIndex(index);
+            const void* node = index.internalPointer();
+            SortKey key = computeSortKey(index, item);
+            const auto it = mSortKeys.constFind(node);
+            if (it != mSortKeys.constEnd() && it->mHasCaptureDate && it->mTime == key.mTime) {
+                // The item changed, but not the file
+                key.mDate = it->mDate;
+                key.mHasCaptureDate = true;
+            }
+            mSortKeys.insert(node, key);
+            mNameKeys.remove(node);
+            mNameKeys.insert(node, mCollator.sortKey(item.text()));
+        }
+        scheduleCaptureDates(q->sortColumn(), parent, first, last);
+    }
+
+    void removeSortKeys(const QModelIndex& parent, int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            const void* node = mSourceModel->index(row, 0, parent).internalPointer();
+            mSortKeys.remove(node);
+            mNameKeys.remove(node);
+            mPendingCaptureDates.remove(node);
+        }
+    }
+
+    void resetSortKeys()
+    {
+        ++mSortKeyGeneration;
+        mSortKeys.clear();
+        mNameKeys.clear();
+        mPendingCaptureDates.clear();
+        const int count = mSourceModel->rowCount();
+        if (count > 0) {
+            updateSortKeys(QModelIndex(), 0, count - 1);
+        }
+    }
+
+    void loadSnapshot(const QUrl& url)
+    {
+        // Subdirs opened in the same lister have no snapshot
+        if (url == mSnapshotUrl || url != mSourceModel->dirLister()->url()) {
+            return;
+        }
+        mSnapshotUrl = url;
+        mSnapshot = DirSnapshot::instance()->load(url);
+    }
+
+    void saveSnapshot()
+    {
+        const int count = mSourceModel->rowCount();
+        if (!mSnapshotUrl.isValid() || count < SNAPSHOT_MIN_ITEM_COUNT) {
+            return;
+        }
+        DirSnapshot::Entries entries;
+        entries.reserve(count);
+        for (int row = 0; row < count; ++row) {
+            const QModelIndex index = mSourceModel->index(row, 0);
+            const auto it = mSortKeys.constFind(index.internalPointer());
+            if (it == mSortKeys.constEnd()) {
+                continue;
+            }
+            const KFileItem item = mSourceModel->itemForIndex(index);
+            DirSnapshot::Entry entry;
+            entry.mtime = it->mTime;
+            entry.size = item.size();
+            entry.kind = it->mKind;
+            entry.hasCaptureDate = it->mHasCaptureDate;
+            entry.captureDate = it->mDate;
+            entries.insert(item.name(), entry);
+        }
+        QtConcurrent::run(DirSnapshot::instance(), &DirSnapshot::save, mSnapshotUrl, entries);
+    }
+
+    void connectDirLister()
+    {
+        QObject::connect(mSourceModel->dirLister(), &KDirLister::started, q, [this](const QUrl& url) {
+            loadSnapshot(url);
+        });
+    }
+
+    /**
+     * Reads the capture dates of rows [first, last] of @p parent in the
+     * thread pool, if they are needed to sort by @p column. The model is
+     * sorted again once they are known.
+     */
+    void scheduleCaptureDates(int column, const QModelIndex& parent, int first, int last)
+    {
+        if (column != KDirModel::ModifiedTime) {
+            return;
+        }
+        QVector<CaptureDateRequest> requests;
+        for (int row = first; row <= last; ++row) {
+            const QModelIndex index = mSourceModel->index(row, 0, parent);
+            const void* node = index.internalPointer();
+            const auto it = mSortKeys.constFind(node);
+            if (it == mSortKeys.constEnd() || it->mDirOrArchive || it->mHasCaptureDate || mPendingCaptureDates.contains(node)) {
+                continue;
+            }
+            const KFileItem item = mSourceModel->itemForIndex(index);
+            const CaptureDateRequest request = { node, item.url(), it->mTime, qint64(item.size()) };
+            requests << request;
+            mPendingCaptureDates.insert(node);
+        }
+        if (requests.isEmpty()) {
+            return;
+        }
+
+        QFutureWatcher<QDateTime>* watcher = new QFutureWatcher<QDateTime>(q);
+        const int generation = mSortKeyGeneration;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, q, [this, watcher, requests, generation]() {
+            watcher->deleteLater();
+            if (generation != mSortKeyGeneration) {
+                return;
+            }
+            bool changed = false;
+            for (int i = 0; i < requests.size(); ++i) {
+                const CaptureDateRequest& request = requests.at(i);
+                mPendingCaptureDates.remove(request.mNode);
+                const auto it = mSortKeys.find(request.mNode);
+                // Skip items which have been removed or modified meanwhile
+                if (it == mSortKeys.end() || it->mHasCaptureDate || it->mTime != request.mTime) {
+                    continue;
+                }
+                const QDateTime date = watcher->resultAt(i);
+                it->mHasCaptureDate = true;
+                if (date != it->mDate) {
+                    it->mDate = date;
+                    changed = true;
+                }
+            }
+            if (changed && q->sortColumn() == KDirModel::ModifiedTime) {
+                q->invalidate();
+            }
+        });
+        watcher->setFuture(QtConcurrent::mapped(requests, readCaptureDate));
+    }
 };
 
 SortedDirModel::SortedDirModel(QObject* parent)
@@ -81,7 +333,33 @@ SortedDirModel::SortedDirModel(QObject* parent)
 #else
     d->mSourceModel = new SemanticInfoDirModel(this);
 #endif
+    d->q = this;
+    d->mSortKeyGeneration = 0;
+    // KDirSortFilterProxyModel sorts names naturally
+    d->mCollator.setNumericMode(true);
+    d->mCollator.setCaseSensitivity(sortCaseSensitivity());
+    // Connect before setSourceModel() so that the keys of new items are
+    // ready when they are sorted
+    connect(d->mSourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex& parent, int first, int last) {
+        d->updateSortKeys(parent, first, last);
+    });
+    connect(d->mSourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        d->updateSortKeys(topLeft.parent(), topLeft.row(), bottomRight.row());
+    });
+    connect(d->mSourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex& parent, int first, int last) {
+        d->removeSortKeys(parent, first, last);
+    });
+    connect(d->mSourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+        // The dir lister is about to list another dir
+        d->saveSnapshot();
+    });
+    connect(d->mSourceModel, &QAbstractItemModel::modelReset, this, [this]() {
+        d->resetSortKeys();
+    });
     setSourceModel(d->mSourceModel);
+    // Only look at file names while listing, see itemKind()
+    d->mSourceModel->dirLister()->setDelayedMimeTypes(true);
+    d->connectDirLister();
     d->mDelayedApplyFiltersTimer.setInterval(0);
     d->mDelayedApplyFiltersTimer.setSingleShot(true);
     connect(&d->mDelayedApplyFiltersTimer, &QTimer::timeout, this, &SortedDirModel::doApplyFilters);
@@ -89,6 +367,7 @@ SortedDirModel::SortedDirModel(QObject* parent)
 
 SortedDirModel::~SortedDirModel()
 {
+    d->saveSnapshot();
     delete d;
 }
 
@@ -195,7 +474,7 @@ bool SortedDirModel::filterAcceptsRow(int row, const QModelIndex& parent) const
     QModelIndex index = d->mSourceModel->index(row, 0, parent);
     KFileItem fileItem = d->mSourceModel->itemForIndex(index);
 
-    MimeTypeUtils::Kinds kind = MimeTypeUtils::fileItemKind(fileItem);
+    MimeTypeUtils::Kinds kind = d->sortKey(index).mKind;
     if (d->mKindFilter != MimeTypeUtils::Kinds() && !(d->mKindFilter & kind)) {
         return false;
     }
@@ -257,39 +536,56 @@ void SortedDirModel::doApplyFilters()
     QSortFilterProxyModel::invalidateFilter();
 }
 
-bool SortedDirModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+void SortedDirModel::sort(int column, Qt::SortOrder order)
 {
-    const KFileItem leftItem = itemForSourceIndex(left);
-    const KFileItem rightItem = itemForSourceIndex(right);
+    if (d->mCollator.caseSensitivity() != sortCaseSensitivity()) {
+        d->mCollator.setCaseSensitivity(sortCaseSensitivity());
+        d->resetSortKeys();
+    }
+    KDirSortFilterProxyModel::sort(column, order);
+    // Items are sorted by modification time until their capture date is
+    // known
+    d->scheduleCaptureDates(column, QModelIndex(), 0, d->mSourceModel->rowCount() - 1);
+}
 
-    const bool leftIsDirOrArchive = ArchiveUtils::fileItemIsDirOrArchive(leftItem);
-    const bool rightIsDirOrArchive = ArchiveUtils::fileItemIsDirOrArchive(rightItem);
+bool SortedDirModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    const SortKey leftKey = d->sortKey(left);
+    const SortKey rightKey = d->sortKey(right);
 
-    if (leftIsDirOrArchive != rightIsDirOrArchive) {
-        return sortOrder() == Qt::AscendingOrder ? leftIsDirOrArchive : rightIsDirOrArchive;
+    if (leftKey.mDirOrArchive != rightKey.mDirOrArchive) {
+        return sortOrder() == Qt::AscendingOrder ? leftKey.mDirOrArchive : rightKey.mDirOrArchive;
     }
 
     // Apply special sort handling only to images. For folders/archives or when
     // a secondary criterion is needed, delegate sorting to the parent class.
-    if (!leftIsDirOrArchive) {
+    if (!leftKey.mDirOrArchive) {
         if (sortColumn() == KDirModel::ModifiedTime) {
-            const QDateTime leftDate = TimeUtils::dateTimeForFileItem(leftItem);
-            const QDateTime rightDate = TimeUtils::dateTimeForFileItem(rightItem);
-
-            if (leftDate != rightDate) {
-                return leftDate < rightDate;
+            if (leftKey.mDate != rightKey.mDate) {
+                return leftKey.mDate < rightKey.mDate;
             }
         }
 #ifndef GWENVIEW_SEMANTICINFO_BACKEND_NONE
         if (sortRole() == SemanticInfoDirModel::RatingRole) {
-            const int leftRating = d->mSourceModel->data(left, SemanticInfoDirModel::RatingRole).toInt();
-            const int rightRating = d->mSourceModel->data(right, SemanticInfoDirModel::RatingRole).toInt();
-
-            if (leftRating != rightRating) {
-                return leftRating < rightRating;
+            if (leftKey.mRating != rightKey.mRating) {
+                return leftKey.mRating < rightKey.mRating;
             }
         }
 #endif
+        if (sortColumn() == KDirModel::Name) {
+            const auto leftName = d->mNameKeys.constFind(left.internalPointer());
+            const auto rightName = d->mNameKeys.constFind(right.internalPointer());
+            if (leftName != d->mNameKeys.constEnd() && rightName != d->mNameKeys.constEnd()) {
+                // Same order as KDirSortFilterProxyModel: hidden files first
+                if (leftKey.mHidden != rightKey.mHidden) {
+                    return leftKey.mHidden;
+                }
+                const int result = leftName->compare(*rightName);
+                if (result != 0) {
+                    return result < 0;
+                }
+            }
+        }
     }
 
     return KDirSortFilterProxyModel::lessThan(left, right);
@@ -303,8 +599,7 @@ bool SortedDirModel::hasDocuments() const
     }
     for (int row = 0; row < count; ++row) {
         const QModelIndex idx = index(row, 0);
-        const KFileItem item = itemForIndex(idx);
-        if (!ArchiveUtils::fileItemIsDirOrArchive(item)) {
+        if (!d->sortKey(mapToSource(idx)).mDirOrArchive) {
             return true;
         }
     }
@@ -313,7 +608,9 @@ bool SortedDirModel::hasDocuments() const
 
 void SortedDirModel::setDirLister(KDirLister* dirLister)
 {
+    dirLister->setDelayedMimeTypes(true);
     d->mSourceModel->setDirLister(dirLister);
+    d->connectDirLister();
 }
 
 } //namespace
@@ -113,6 +113,13 @@ public:
 
     bool hasDocuments() const;
 
+    /**
+     * Sort keys are computed once per item. When sorting by date, capture
+     * dates are read in the thread pool, the model is sorted again once they
+     * are known.
+     */
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
 public Q_SLOTS:
     void applyFilters();
 
@@ -25,6 +25,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include "jpegcontent.h"
 #include "gwenviewconfig.h"
 #include "exiv2imageloader.h"
+#include "imageutils.h"
+#include "orientedjpegdecoder.h"
 
 // KDE
 #include "gwenview_lib_debug.h"
@@ -141,19 +143,33 @@ bool ThumbnailContext::load(const QString &pixPath, int pixelSize)
         }
     }
 
-    // Rotate if necessary
+    Orientation orientation = NORMAL;
     if (GwenviewConfig::applyExifOrientation()) {
-        reader.setAutoTransform(true);
+        orientation = ImageUtils::orientationForTransformation(reader.transformation());
     }
 
     // format() is empty after QImageReader::read() is called
     format = reader.format();
-    if (!reader.read(&originalImage)) {
+    bool oriented = false;
+    if (format == "jpeg" && orientation != NORMAL) {
+        // Decode straight into the rotated layout. Read the data the reader
+        // uses: for RAW files, this is the extracted preview, not the file.
+        QIODevice* device = reader.device();
+        const qint64 pos = device ? device->pos() : 0;
+        oriented = device && device->isOpen() && device->seek(0)
+            && OrientedJpegDecoder::read(device, orientation, reader.scaledSize(), &originalImage);
+        if (!oriented && device) {
+            // Let the reader go on from where it stopped
+            device->seek(pos);
+        }
+    }
+    if (!oriented && !reader.read(&originalImage)) {
         return false;
     }
 
     if (!originalSize.isValid()) {
-        originalSize = originalImage.size();
+        // The size before orientation: the swap below applies it
+        originalSize = oriented && orientation >= TRANSPOSE ? originalImage.size().transposed() : originalImage.size();
     }
     mOriginalWidth = originalSize.width() * previewRatio;
     mOriginalHeight = originalSize.height() * previewRatio;
@@ -165,7 +181,12 @@ bool ThumbnailContext::load(const QString &pixPath, int pixelSize)
         mImage = originalImage.scaled(pixelSize, pixelSize, Qt::KeepAspectRatio);
     }
 
-    if (reader.autoTransform() && (reader.transformation() & QImageIOHandler::TransformationRotate90)) {
+    // Rotate if necessary. Done after scaling so that only the thumbnail
+    // pixels are moved.
+    if (!oriented) {
+        mImage = ImageUtils::transformed(mImage, orientation);
+    }
+    if (orientation >= TRANSPOSE) {
         qSwap(mOriginalWidth, mOriginalHeight);
     }
 
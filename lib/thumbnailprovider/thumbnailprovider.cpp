@@ -30,6 +30,7 @@
 // Qt
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QImage>
 #include <QPixmap>
 #include <QCryptographicHash>
@@ -146,6 +147,37 @@ void ThumbnailProvider::moveThumbnail(const QUrl &oldUrl, const QUrl& newUrl)
     moveThumbnailHelper(oldUri, newUri, ThumbnailGroup::Large);
 }
 
+void ThumbnailProvider::cacheThumbnails(const QUrl &url, const QImage& image, const QSize& fullSize)
+{
+    if (!url.isLocalFile() || image.isNull()) {
+        return;
+    }
+    const QFileInfo info(url.toLocalFile());
+    if (!info.exists()) {
+        return;
+    }
+    const QString uri = generateOriginalUri(url);
+    const QString mimeType = MimeTypeUtils::urlMimeType(url);
+
+    // Scale down from the largest group to the smallest one, each thumbnail
+    // is computed from the previous one
+    QImage thumbnail = image;
+    for (int group = ThumbnailGroup::Large; group >= ThumbnailGroup::Normal; --group) {
+        const int pixelSize = ThumbnailGroup::pixelSize(ThumbnailGroup::Enum(group));
+        if (thumbnail.width() > pixelSize || thumbnail.height() > pixelSize) {
+            thumbnail = thumbnail.scaled(pixelSize, pixelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        }
+        thumbnail.setText(QStringLiteral("Thumb::URI")          , uri);
+        thumbnail.setText(QStringLiteral("Thumb::MTime")        , QString::number(info.lastModified().toSecsSinceEpoch()));
+        thumbnail.setText(QStringLiteral("Thumb::Size")         , QString::number(info.size()));
+        thumbnail.setText(QStringLiteral("Thumb::Mimetype")     , mimeType);
+        thumbnail.setText(QStringLiteral("Thumb::Image::Width") , QString::number(fullSize.width()));
+        thumbnail.setText(QStringLiteral("Thumb::Image::Height"), QString::number(fullSize.height()));
+        thumbnail.setText(QStringLiteral("Software")            , QStringLiteral("Gwenview"));
+        sThumbnailWriter->queueThumbnail(generateThumbnailPath(uri, ThumbnailGroup::Enum(group)), thumbnail);
+    }
+}
+
 //------------------------------------------------------------------------
 //
 // ThumbnailProvider implementation
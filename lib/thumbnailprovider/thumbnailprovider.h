@@ -108,6 +108,15 @@ public:
      */
     static void moveThumbnail(const QUrl &oldUrl, const QUrl& newUrl);
 
+    /**
+     * Stores thumbnails of @p image, the content of the local file @p url,
+     * for the groups which are cached on disk. @p image should be at least as
+     * big as the largest of these groups, @p fullSize is the size of the
+     * image in the file. Used to refresh thumbnails of a file which has just
+     * been saved without loading it again.
+     */
+    static void cacheThumbnails(const QUrl &url, const QImage& image, const QSize& fullSize);
+
     /**
      * Returns true if all thumbnails have been written to disk. Useful for
      * unit-testing.
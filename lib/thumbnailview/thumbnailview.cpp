@@ -906,6 +906,11 @@ void ThumbnailView::generateThumbnailsForItems()
             visibleItemFract = visibleItemRect.width() * visibleItemRect.height() / itemSurface;
         }
         if (visibleItemFract > 0.7) {
+            // Dir models may only know MIME types from file names, get the
+            // precise one of visible items
+            if (!item.isMimeTypeKnown()) {
+                item.determineMimeType();
+            }
             // Item is visible, order thumbnails from left to right, top to bottom
             // Distance is computed so that it is between 0 and visibleSurface
             distance = itemRect.top() * visibleRect.width() + itemRect.left();
@@ -27,6 +27,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 // Qt
 #include <QFile>
 #include <QDateTime>
+#include <QSize>
+#include <QUrl>
 #include "gwenview_lib_debug.h"
 
 // KDE
@@ -36,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 #include <exiv2/exiv2.hpp>
 
 // Local
+#include <lib/exifindex.h>
 #include <lib/exiv2imageloader.h>
 #include <lib/urlutils.h>
 
@@ -64,87 +67,82 @@ static Exiv2::ExifData::const_iterator findDateTimeKey(const Exiv2::ExifData& ex
     return end;
 }
 
-struct CacheItem
+/**
+ * Reads the Exif information of the local file @p path. Leaves entry
+ * fields untouched if they are not available.
+ */
+static void readExifEntry(const QString& path, ExifIndex::Entry* entry)
 {
-    QDateTime fileMTime;
-    QDateTime realTime;
-
-    void update(const KFileItem& fileItem)
-    {
-        QDateTime time = fileItem.time(KFileItem::ModificationTime);
-        if (fileMTime == time) {
+    Exiv2ImageLoader loader;
+    if (!loader.loadHeader(path)) {
+        return;
+    }
+    std::unique_ptr<Exiv2::Image> img(loader.popImage().release());
+    try {
+        entry->size = QSize(img->pixelWidth(), img->pixelHeight());
+        Exiv2::ExifData exifData = img->exifData();
+        if (exifData.empty()) {
             return;
         }
-
-        fileMTime = time;
-
-        if (!updateFromExif(fileItem.url())) {
-            realTime = time;
-        }
-    }
-
-    bool updateFromExif(const QUrl &url)
-    {
-        if (!UrlUtils::urlIsFastLocalFile(url)) {
-            return false;
+        Exiv2::ExifData::const_iterator orientationIt = exifData.findKey(Exiv2::ExifKey("Exif.Image.Orientation"));
+        if (orientationIt != exifData.end()) {
+            const long orientation = orientationIt->toLong();
+            if (orientation >= NORMAL && orientation <= ROT_270) {
+                entry->orientation = Orientation(orientation);
+            }
         }
-        QString path = url.path();
-        Exiv2ImageLoader loader;
 
-        if (!loader.load(path)) {
-            return false;
+        Exiv2::ExifData::const_iterator it = findDateTimeKey(exifData);
+        if (it == exifData.end()) {
+            qCWarning(GWENVIEW_LIB_LOG) << "No date in exif header of" << path;
+            return;
         }
-        std::unique_ptr<Exiv2::Image> img(loader.popImage().release());
-        try {
-            Exiv2::ExifData exifData = img->exifData();
-            if (exifData.empty()) {
-                return false;
-            }
-            Exiv2::ExifData::const_iterator it = findDateTimeKey(exifData);
-            if (it == exifData.end()) {
-                qCWarning(GWENVIEW_LIB_LOG) << "No date in exif header of" << path;
-                return false;
-            }
 
-            std::ostringstream stream;
-            stream << *it;
-            QString value = QString::fromLocal8Bit(stream.str().c_str());
+        std::ostringstream stream;
+        stream << *it;
+        QString value = QString::fromLocal8Bit(stream.str().c_str());
 
-            QDateTime dt = QDateTime::fromString(value, QStringLiteral("yyyy:MM:dd hh:mm:ss"));
-            if (!dt.isValid()) {
-                qCWarning(GWENVIEW_LIB_LOG) << "Invalid date in exif header of" << path;
-                return false;
-            }
-
-            realTime = dt;
-            return true;
-        } catch (const Exiv2::Error& error) {
-            qCWarning(GWENVIEW_LIB_LOG) << "Failed to read date from exif header of" << path << ". Error:" << error.what();
-            return false;
+        QDateTime dt = QDateTime::fromString(value, QStringLiteral("yyyy:MM:dd hh:mm:ss"));
+        if (!dt.isValid()) {
+            qCWarning(GWENVIEW_LIB_LOG) << "Invalid date in exif header of" << path;
+            return;
         }
-    }
-};
 
-typedef QHash<QUrl, CacheItem> Cache;
+        entry->dateTime = dt;
+    } catch (const Exiv2::Error& error) {
+        qCWarning(GWENVIEW_LIB_LOG) << "Failed to read date from exif header of" << path << ". Error:" << error.what();
+    }
+}
 
 QDateTime dateTimeForFileItem(const KFileItem& fileItem, CachePolicy cachePolicy)
 {
-    if (cachePolicy == SkipCache) {
-        CacheItem item;
-        item.update(fileItem);
-        return item.realTime;
-    }
+    return dateTimeForFile(fileItem.url(), fileItem.time(KFileItem::ModificationTime), fileItem.size(), cachePolicy);
+}
 
-    static Cache cache;
-    const QUrl url = fileItem.targetUrl();
+QDateTime dateTimeForFile(const QUrl& url, const QDateTime& mtime, qint64 fileSize, CachePolicy cachePolicy)
+{
+    if (!url.isLocalFile()) {
+        return mtime;
+    }
 
-    Cache::iterator it = cache.find(url);
-    if (it == cache.end()) {
-        it = cache.insert(url, CacheItem());
+    // Only files which are fast to read are indexed, but looking them up is
+    // cheaper than checking their mount point
+    const QString path = url.path();
+    ExifIndex::Entry entry;
+    if (cachePolicy == UseCache && ExifIndex::instance()->find(path, mtime, fileSize, &entry)) {
+        return entry.dateTime.isValid() ? entry.dateTime : mtime;
+    }
+    if (!UrlUtils::urlIsFastLocalFile(url)) {
+        return mtime;
     }
 
-    it.value().update(fileItem);
-    return it.value().realTime;
+    readExifEntry(path, &entry);
+    if (cachePolicy == UseCache) {
+        // Files without a date are indexed too, so that they are not parsed
+        // again
+        ExifIndex::instance()->insert(path, mtime, fileSize, entry);
+    }
+    return entry.dateTime.isValid() ? entry.dateTime : mtime;
 }
 
 } // namespace
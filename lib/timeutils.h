@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Cambridge, MA 02110-1301, USA
 
 class KFileItem;
 class QDateTime;
+class QUrl;
 
 namespace Gwenview
 {
@@ -41,6 +42,13 @@ enum CachePolicy
 
 QDateTime GWENVIEWLIB_EXPORT dateTimeForFileItem(const KFileItem& fileItem, Gwenview::TimeUtils::CachePolicy cachePolicy = UseCache);
 
+/**
+ * Same as dateTimeForFileItem(), for the file @p url whose modification time
+ * is @p mtime and size is @p fileSize. Unlike KFileItem, these can be passed
+ * to another thread: this function is thread-safe.
+ */
+QDateTime GWENVIEWLIB_EXPORT dateTimeForFile(const QUrl& url, const QDateTime& mtime, qint64 fileSize, Gwenview::TimeUtils::CachePolicy cachePolicy = UseCache);
+
 } // namespace
 
 } // namespace
@@ -0,0 +1,177 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "animatedframedecodertest.h"
+
+// Qt
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QImageReader>
+#include <QTest>
+
+// Local
+#include "../lib/document/animatedframedecoder.h"
+
+QTEST_MAIN(AnimatedFrameDecoderTest)
+
+using namespace Gwenview;
+
+static const int TIMEOUT = 5000;
+
+// Frame delays of the test animation, in hundredths of a second, and the
+// delays the decoder must report for them, in milliseconds: too short
+// delays are raised like web browsers do
+static const int GIF_DELAYS[] = {5, 1, 0};
+static const int EXPECTED_DELAYS[] = {50, 20, 100};
+static const int FRAME_COUNT = 3;
+
+static void appendLittleEndian16(QByteArray* data, int value)
+{
+    data->append(char(value & 0xff));
+    data->append(char((value >> 8) & 0xff));
+}
+
+/**
+ * Returns a 1x1 GIF animation with the frames of GIF_DELAYS. If loopCount
+ * is not negative, it contains a NETSCAPE loop extension with this count.
+ */
+static QByteArray createGif(int loopCount)
+{
+    QByteArray data("GIF89a");
+    appendLittleEndian16(&data, 1);
+    appendLittleEndian16(&data, 1);
+    // Global color table of 2 colors: black and white
+    data.append("\x80\x00\x00", 3);
+    data.append("\x00\x00\x00\xff\xff\xff", 6);
+    if (loopCount >= 0) {
+        data.append("\x21\xff\x0b" "NETSCAPE2.0" "\x03\x01", 16);
+        appendLittleEndian16(&data, loopCount);
+        data.append('\x00');
+    }
+    for (int delay : GIF_DELAYS) {
+        // Graphic control extension
+        data.append("\x21\xf9\x04\x00", 4);
+        appendLittleEndian16(&data, delay);
+        data.append("\x00\x00", 2);
+        // Image descriptor
+        data.append('\x2c');
+        appendLittleEndian16(&data, 0);
+        appendLittleEndian16(&data, 0);
+        appendLittleEndian16(&data, 1);
+        appendLittleEndian16(&data, 1);
+        data.append('\x00');
+        // LZW data: clear code, one pixel of color 0, end of information
+        data.append("\x02\x02\x44\x01\x00", 5);
+    }
+    data.append('\x3b');
+    return data;
+}
+
+/**
+ * Returns the loop count Qt reports for data
+ */
+static int qtLoopCount(const QByteArray& data)
+{
+    QByteArray copy = data;
+    QBuffer buffer(&copy);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "gif");
+    reader.read();
+    return reader.loopCount();
+}
+
+/**
+ * Waits for the next frame. Returns false if there is none.
+ */
+static bool waitForFrame(AnimatedFrameDecoder* decoder, QImage* image, int* delay)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!decoder->takeFrame(image, delay)) {
+        if (decoder->atEnd() || timer.elapsed() > TIMEOUT) {
+            return false;
+        }
+        QTest::qWait(10);
+    }
+    return true;
+}
+
+void AnimatedFrameDecoderTest::testFrameTiming()
+{
+    AnimatedFrameDecoder decoder(createGif(0), "gif");
+    decoder.start();
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        QImage image;
+        int delay;
+        QVERIFY(waitForFrame(&decoder, &image, &delay));
+        QCOMPARE(image.size(), QSize(1, 1));
+        QCOMPARE(delay, EXPECTED_DELAYS[i]);
+    }
+}
+
+void AnimatedFrameDecoderTest::testLooping()
+{
+    const QByteArray data = createGif(2);
+    const int loopCount = qtLoopCount(data);
+    QVERIFY(loopCount > 0);
+
+    AnimatedFrameDecoder decoder(data, "gif");
+    decoder.start();
+    // The animation is played once, then repeated loopCount times
+    const int expectedFrameCount = FRAME_COUNT * (1 + loopCount);
+    for (int i = 0; i < expectedFrameCount; ++i) {
+        QImage image;
+        int delay;
+        QVERIFY2(waitForFrame(&decoder, &image, &delay), qPrintable(QStringLiteral("Missing frame %1").arg(i)));
+        QCOMPARE(delay, EXPECTED_DELAYS[i % FRAME_COUNT]);
+    }
+    QImage image;
+    int delay;
+    QVERIFY(!waitForFrame(&decoder, &image, &delay));
+    QVERIFY(decoder.atEnd());
+}
+
+void AnimatedFrameDecoderTest::testLoopingForever()
+{
+    // A NETSCAPE loop count of 0 means forever
+    const QByteArray data = createGif(0);
+    QCOMPARE(qtLoopCount(data), -1);
+
+    AnimatedFrameDecoder decoder(data, "gif");
+    decoder.start();
+    for (int i = 0; i < FRAME_COUNT * 5; ++i) {
+        QImage image;
+        int delay;
+        QVERIFY(waitForFrame(&decoder, &image, &delay));
+        QCOMPARE(delay, EXPECTED_DELAYS[i % FRAME_COUNT]);
+    }
+    QVERIFY(!decoder.atEnd());
+}
+
+void AnimatedFrameDecoderTest::testScaledSize()
+{
+    AnimatedFrameDecoder decoder(createGif(0), "gif");
+    decoder.setScaledSize(QSize(4, 4));
+    decoder.start();
+    QImage image;
+    int delay;
+    QVERIFY(waitForFrame(&decoder, &image, &delay));
+    QCOMPARE(image.size(), QSize(4, 4));
+}
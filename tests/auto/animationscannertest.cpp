@@ -0,0 +1,94 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "animationscannertest.h"
+
+// Qt
+#include <QFile>
+#include <QTest>
+
+// Local
+#include "../lib/animationscanner.h"
+#include "testutils.h"
+
+QTEST_MAIN(AnimationScannerTest)
+
+using namespace Gwenview;
+
+static QByteArray readTestFile(const QString& name)
+{
+    QFile file(pathForTestFile(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void AnimationScannerTest::testScan_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<int>("expectedFrameCount");
+    QTest::addColumn<int>("expectedDuration");
+
+    QTest::newRow("1frame") << "1frame.gif" << 1 << 0;
+    QTest::newRow("4frames") << "4frames.gif" << 4 << 400;
+    QTest::newRow("40frames") << "40frames.gif" << 40 << 4000;
+    // A single frame with a graphic control extension must not be reported
+    // as animated (Bug #185523)
+    QTest::newRow("185523") << "185523_1frame_with_graphic_control_extension.gif" << 1 << 600;
+    QTest::newRow("png") << "test.png" << 1 << 0;
+}
+
+void AnimationScannerTest::testScan()
+{
+    QFETCH(QString, fileName);
+    QFETCH(int, expectedFrameCount);
+    QFETCH(int, expectedDuration);
+
+    QByteArray data = readTestFile(fileName);
+    QVERIFY(!data.isEmpty());
+
+    AnimationScanner::Info info;
+    QVERIFY(AnimationScanner::scan(data, &info));
+    QCOMPARE(info.frameCount, expectedFrameCount);
+    QCOMPARE(info.duration, expectedDuration);
+}
+
+void AnimationScannerTest::testTruncatedGif()
+{
+    QByteArray data = readTestFile("40frames.gif");
+    QVERIFY(!data.isEmpty());
+    data.truncate(data.size() / 2);
+
+    // Only the frames which are complete are counted
+    AnimationScanner::Info info;
+    QVERIFY(AnimationScanner::scan(data, &info));
+    QVERIFY(info.frameCount > 1);
+    QVERIFY(info.frameCount < 40);
+}
+
+void AnimationScannerTest::testUnknownFormat()
+{
+    QByteArray data = readTestFile("orient6.jpg");
+    QVERIFY(!data.isEmpty());
+
+    AnimationScanner::Info info;
+    QVERIFY(!AnimationScanner::scan(data, &info));
+    QCOMPARE(info.frameCount, 0);
+}
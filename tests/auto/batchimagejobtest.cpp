@@ -0,0 +1,143 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "batchimagejobtest.h"
+
+// STL
+#include <memory>
+
+// Qt
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Exiv2
+#include <exiv2/exiv2.hpp>
+
+// Local
+#include "../lib/batchimagejob.h"
+#include "../lib/gwenviewconfig.h"
+#include "../lib/imageutils.h"
+#include "../lib/jpegcontent.h"
+#include "testutils.h"
+
+QTEST_MAIN(BatchImageJobTest)
+
+using namespace Gwenview;
+
+static void compareImages(const QImage& image, const QImage& expected, int delta)
+{
+    QCOMPARE(image.size(), expected.size());
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb pixel = image.pixel(x, y);
+            const QRgb expectedPixel = expected.pixel(x, y);
+            QVERIFY2(qAbs(qRed(pixel) - qRed(expectedPixel)) <= delta
+                     && qAbs(qGreen(pixel) - qGreen(expectedPixel)) <= delta
+                     && qAbs(qBlue(pixel) - qBlue(expectedPixel)) <= delta,
+                     qPrintable(QStringLiteral("Pixels differ at %1,%2").arg(x).arg(y)));
+        }
+    }
+}
+
+void BatchImageJobTest::initTestCase()
+{
+    GwenviewConfig::setApplyExifOrientation(true);
+}
+
+void BatchImageJobTest::testJpeg()
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/orient6.jpg";
+    QVERIFY(QFile::copy(pathForTestFile("orient6.jpg"), path));
+
+    QImage expected;
+    QImage expectedThumbnail;
+    {
+        QImageReader reader(path);
+        reader.setAutoTransform(true);
+        expected = ImageUtils::transformed(reader.read().convertToFormat(QImage::Format_RGB32), ROT_90);
+        JpegContent content;
+        QVERIFY(content.load(path));
+        QCOMPARE(content.orientation(), ROT_90);
+        // Already oriented
+        expectedThumbnail = content.thumbnail();
+        QVERIFY(!expectedThumbnail.isNull());
+        expectedThumbnail = ImageUtils::transformed(expectedThumbnail, ROT_90);
+    }
+
+    BatchImageJob job({QUrl::fromLocalFile(path)}, {ROT_90});
+    job.setAutoDelete(false);
+    QVERIFY2(job.exec(), qPrintable(job.errorList().join('\n')));
+
+    // Pixels have been transformed losslessly, the Exif orientation is gone
+    JpegContent content;
+    QVERIFY(content.load(path));
+    QCOMPARE(content.orientation(), NORMAL);
+    QImageReader reader(path);
+    reader.setAutoTransform(false);
+    compareImages(reader.read().convertToFormat(QImage::Format_RGB32), expected, 2);
+
+    // The thumbnail went through the same transformations: compare coarse
+    // versions, it has been encoded again
+    const QImage thumbnail = content.thumbnail();
+    QCOMPARE(thumbnail.size(), expectedThumbnail.size());
+    compareImages(
+        thumbnail.scaled(4, 4, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_RGB32),
+        expectedThumbnail.scaled(4, 4, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_RGB32),
+        24);
+}
+
+void BatchImageJobTest::testPng()
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/test.png";
+    QImage original(40, 20, QImage::Format_RGB32);
+    for (int y = 0; y < original.height(); ++y) {
+        for (int x = 0; x < original.width(); ++x) {
+            original.setPixel(x, y, qRgb(x * 6, y * 12, x + y));
+        }
+    }
+    original.setText("Title", "Batch");
+    QVERIFY(original.save(path, "png"));
+    {
+        std::unique_ptr<Exiv2::Image> image(Exiv2::ImageFactory::open(path.toStdString()).release());
+        image->readMetadata();
+        image->exifData()["Exif.Image.Artist"] = "Gwenview";
+        image->writeMetadata();
+    }
+
+    BatchImageJob job({QUrl::fromLocalFile(path)}, {ROT_90});
+    job.setAutoDelete(false);
+    QVERIFY2(job.exec(), qPrintable(job.errorList().join('\n')));
+
+    // PNG is lossless: pixels must be exactly the same
+    const QImage image = QImage(path).convertToFormat(QImage::Format_RGB32);
+    QCOMPARE(image, ImageUtils::transformed(original, ROT_90));
+    QCOMPARE(image.text("Title"), QStringLiteral("Batch"));
+
+    std::unique_ptr<Exiv2::Image> exiv2Image(Exiv2::ImageFactory::open(path.toStdString()).release());
+    exiv2Image->readMetadata();
+    const Exiv2::ExifData& exifData = exiv2Image->exifData();
+    Exiv2::ExifData::const_iterator it = exifData.findKey(Exiv2::ExifKey("Exif.Image.Artist"));
+    QVERIFY(it != exifData.end());
+    QCOMPARE(QString::fromStdString(it->toString()), QStringLiteral("Gwenview"));
+}
@@ -0,0 +1,96 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "dirsnapshottest.h"
+
+// Qt
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+// Local
+#include "../lib/dirsnapshot.h"
+
+QTEST_MAIN(DirSnapshotTest)
+
+using namespace Gwenview;
+
+void DirSnapshotTest::testSaveLoad()
+{
+    QTemporaryDir storageDir;
+    QVERIFY(storageDir.isValid());
+    const QUrl dirUrl = QUrl::fromLocalFile(QStringLiteral("/photos/2020"));
+
+    DirSnapshot::Entries entries;
+    DirSnapshot::Entry entry;
+    entry.mtime = QDateTime::fromMSecsSinceEpoch(1577880000000);
+    entry.size = 1234567;
+    entry.kind = MimeTypeUtils::KIND_RASTER_IMAGE;
+    entry.hasCaptureDate = true;
+    entry.captureDate = QDateTime::fromMSecsSinceEpoch(1577800000000);
+    entries.insert(QStringLiteral("a.jpg"), entry);
+
+    entry.mtime = QDateTime::fromMSecsSinceEpoch(1577890000000);
+    entry.size = 42;
+    entry.kind = MimeTypeUtils::KIND_FILE;
+    entry.hasCaptureDate = false;
+    entry.captureDate = QDateTime();
+    entries.insert(QStringLiteral("notes.txt"), entry);
+
+    {
+        DirSnapshot snapshot(storageDir.path());
+        QVERIFY(snapshot.load(dirUrl).isEmpty());
+        snapshot.save(dirUrl, entries);
+    }
+
+    // Use another instance to make sure the entries come from the disk
+    DirSnapshot snapshot(storageDir.path());
+    const DirSnapshot::Entries loaded = snapshot.load(dirUrl);
+    QCOMPARE(loaded.count(), 2);
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QVERIFY(loaded.contains(it.key()));
+        const DirSnapshot::Entry& loadedEntry = loaded[it.key()];
+        QCOMPARE(loadedEntry.mtime, it->mtime);
+        QCOMPARE(loadedEntry.size, it->size);
+        QCOMPARE(loadedEntry.kind, it->kind);
+        QCOMPARE(loadedEntry.hasCaptureDate, it->hasCaptureDate);
+        if (it->hasCaptureDate) {
+            QCOMPARE(loadedEntry.captureDate, it->captureDate);
+        }
+    }
+
+    QVERIFY(snapshot.load(QUrl::fromLocalFile(QStringLiteral("/photos/2019"))).isEmpty());
+}
+
+void DirSnapshotTest::testPrune()
+{
+    QTemporaryDir storageDir;
+    QVERIFY(storageDir.isValid());
+    DirSnapshot snapshot(storageDir.path());
+
+    DirSnapshot::Entries entries;
+    entries.insert(QStringLiteral("a.jpg"), DirSnapshot::Entry());
+    for (int idx = 0; idx < 40; ++idx) {
+        snapshot.save(QUrl::fromLocalFile(QStringLiteral("/photos/%1").arg(idx)), entries);
+    }
+
+    const QStringList files = QDir(storageDir.path()).entryList(QDir::Files);
+    QCOMPARE(files.count(), 32);
+}
@@ -0,0 +1,107 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "editchaintest.h"
+
+// Qt
+#include <QImage>
+#include <QPainter>
+#include <QTest>
+
+// Local
+#include "../lib/document/editchain.h"
+
+QTEST_MAIN(EditChainTest)
+
+using namespace Gwenview;
+
+static QImage createTestImage(const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    QPainter painter(&image);
+    painter.fillRect(image.rect(), Qt::white);
+    for (int x = 0; x < size.width(); x += 3) {
+        painter.setPen(QColor::fromHsv(x * 7 % 360, 255, 255));
+        painter.drawLine(x, 0, size.width() - x, size.height());
+    }
+    return image;
+}
+
+// Inverts the pixels of a rect of the full size image
+static void invertRect(QImage* image, const QTransform& matrix)
+{
+    const QRect rect = matrix.mapRect(QRectF(10, 10, 8, 8)).toAlignedRect() & image->rect();
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            image->setPixel(x, y, ~image->pixel(x, y) | 0xff000000);
+        }
+    }
+}
+
+void EditChainTest::testSize()
+{
+    EditChain chain;
+    QVERIFY(chain.isEmpty());
+
+    chain.append(ImageEdit::transformation(ROT_90), QSize(40, 30));
+    QCOMPARE(chain.size(), QSize(30, 40));
+
+    // Rotating back cancels the rotation
+    chain.append(ImageEdit::transformation(ROT_270), chain.size());
+    QVERIFY(chain.isEmpty());
+
+    chain.append(ImageEdit::crop(QRect(5, 5, 10, 20)), QSize(40, 30));
+    chain.append(ImageEdit::transformation(ROT_90), chain.size());
+    QCOMPARE(chain.size(), QSize(20, 10));
+    chain.append(ImageEdit::resize(QSize(40, 20)), chain.size());
+    QCOMPARE(chain.size(), QSize(40, 20));
+    QCOMPARE(chain.sourceSize(), QSize(40, 30));
+
+    chain.removeLast();
+    QCOMPARE(chain.size(), QSize(20, 10));
+}
+
+/**
+ * Editing parts of an image and putting them together must give the same
+ * result as editing the whole image
+ */
+void EditChainTest::testApplyToParts()
+{
+    const QImage image = createTestImage(QSize(60, 40));
+    EditChain chain;
+    chain.append(ImageEdit::transformation(ROT_90), image.size());
+    chain.append(ImageEdit::crop(QRect(3, 5, 30, 40)), chain.size());
+    chain.append(ImageEdit::pixelFunction(invertRect), chain.size());
+    chain.append(ImageEdit::transformation(HFLIP), chain.size());
+
+    const QImage expected = chain.apply(image);
+    QCOMPARE(expected.size(), chain.size());
+
+    const int halfWidth = chain.size().width() / 2;
+    const QRect parts[] = {
+        QRect(0, 0, halfWidth, chain.size().height()),
+        QRect(halfWidth, 0, chain.size().width() - halfWidth, chain.size().height())
+    };
+    for (const QRect& part : parts) {
+        QRect rect = chain.sourceRect(part, image.size());
+        const QImage result = chain.apply(image.copy(rect), &rect, image.size());
+        QVERIFY(rect.contains(part));
+        QCOMPARE(result.copy(part.translated(-rect.topLeft())), expected.copy(part));
+    }
+}
@@ -0,0 +1,178 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "exifindextest.h"
+
+// Qt
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Local
+#include "../lib/exifindex.h"
+
+QTEST_MAIN(ExifIndexTest)
+
+using namespace Gwenview;
+
+static const QString PATH = QStringLiteral("/photos/img_0001.jpg");
+static const QDateTime MTIME = QDateTime::fromString("2020-05-01T10:00:00", Qt::ISODate);
+static const qint64 SIZE = 123456;
+
+static ExifIndex::Entry createEntry()
+{
+    ExifIndex::Entry entry;
+    entry.dateTime = QDateTime::fromString("2003-03-10T17:45:21", Qt::ISODate);
+    entry.size = QSize(4000, 3000);
+    entry.orientation = ROT_90;
+    return entry;
+}
+
+void ExifIndexTest::testPersistence()
+{
+    QTemporaryDir dir;
+    const QString indexPath = dir.path() + "/index";
+    {
+        ExifIndex index(indexPath);
+        index.insert(PATH, MTIME, SIZE, createEntry());
+        // Files without a date are indexed too
+        index.insert(PATH + "2", MTIME, SIZE, ExifIndex::Entry());
+    }
+
+    ExifIndex index(indexPath);
+    ExifIndex::Entry entry;
+    QVERIFY(index.find(PATH, MTIME, SIZE, &entry));
+    const ExifIndex::Entry expected = createEntry();
+    QCOMPARE(entry.dateTime, expected.dateTime);
+    QCOMPARE(entry.size, expected.size);
+    QCOMPARE(entry.orientation, expected.orientation);
+
+    QVERIFY(index.find(PATH + "2", MTIME, SIZE, &entry));
+    QVERIFY(!entry.dateTime.isValid());
+
+    // Entries of modified files are ignored
+    QVERIFY(!index.find(PATH, MTIME.addSecs(1), SIZE, &entry));
+    QVERIFY(!index.find(PATH, MTIME, SIZE + 1, &entry));
+    QVERIFY(!index.find(PATH + "3", MTIME, SIZE, &entry));
+}
+
+void ExifIndexTest::testUpdatedEntry()
+{
+    QTemporaryDir dir;
+    const QString indexPath = dir.path() + "/index";
+    const QDateTime newMTime = MTIME.addDays(1);
+    {
+        ExifIndex index(indexPath);
+        index.insert(PATH, MTIME, SIZE, createEntry());
+    }
+    {
+        // The new entry is appended to the mapped file
+        ExifIndex index(indexPath);
+        index.insert(PATH, newMTime, SIZE, ExifIndex::Entry());
+    }
+
+    ExifIndex index(indexPath);
+    ExifIndex::Entry entry;
+    QVERIFY(!index.find(PATH, MTIME, SIZE, &entry));
+    QVERIFY(index.find(PATH, newMTime, SIZE, &entry));
+    QVERIFY(!entry.dateTime.isValid());
+}
+
+void ExifIndexTest::testInvalidFile()
+{
+    QTemporaryDir dir;
+    const QString indexPath = dir.path() + "/index";
+    {
+        QFile file(indexPath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("This is not an index");
+    }
+    {
+        ExifIndex index(indexPath);
+        ExifIndex::Entry entry;
+        QVERIFY(!index.find(PATH, MTIME, SIZE, &entry));
+        index.insert(PATH, MTIME, SIZE, createEntry());
+    }
+
+    ExifIndex index(indexPath);
+    ExifIndex::Entry entry;
+    QVERIFY(index.find(PATH, MTIME, SIZE, &entry));
+    QCOMPARE(entry.dateTime, createEntry().dateTime);
+}
+
+void ExifIndexTest::testManyEntries()
+{
+    QTemporaryDir dir;
+    const QString indexPath = dir.path() + "/index";
+    // Enough entries to go through several batches
+    const int count = 1000;
+    {
+        ExifIndex index(indexPath);
+        for (int i = 0; i < count; ++i) {
+            index.insert(PATH + QString::number(i), MTIME, SIZE, createEntry());
+        }
+        ExifIndex::Entry entry;
+        for (int i = 0; i < count; ++i) {
+            QVERIFY(index.find(PATH + QString::number(i), MTIME, SIZE, &entry));
+        }
+        // Entries inserted after the first rewrite are appended to the
+        // mapped file
+        for (int i = 0; i < count; ++i) {
+            index.insert(PATH + QString::number(i), MTIME.addSecs(1), SIZE, createEntry());
+        }
+        for (int i = 0; i < count; ++i) {
+            QVERIFY(index.find(PATH + QString::number(i), MTIME.addSecs(1), SIZE, &entry));
+        }
+    }
+
+    ExifIndex index(indexPath);
+    ExifIndex::Entry entry;
+    for (int i = 0; i < count; ++i) {
+        QVERIFY(!index.find(PATH + QString::number(i), MTIME, SIZE, &entry));
+        QVERIFY(index.find(PATH + QString::number(i), MTIME.addSecs(1), SIZE, &entry));
+        QCOMPARE(entry.dateTime, createEntry().dateTime);
+    }
+}
+
+void ExifIndexTest::testConcurrentIndexes()
+{
+    QTemporaryDir dir;
+    const QString indexPath = dir.path() + "/index";
+    {
+        ExifIndex index(indexPath);
+        index.insert(PATH, MTIME, SIZE, createEntry());
+    }
+    {
+        // Like two instances of the application, both appending to the file
+        ExifIndex index1(indexPath);
+        ExifIndex index2(indexPath);
+        for (int i = 0; i < 300; ++i) {
+            index1.insert(PATH + "a" + QString::number(i), MTIME, SIZE, createEntry());
+            index2.insert(PATH + "b" + QString::number(i), MTIME, SIZE, createEntry());
+        }
+    }
+
+    ExifIndex index(indexPath);
+    ExifIndex::Entry entry;
+    QVERIFY(index.find(PATH, MTIME, SIZE, &entry));
+    for (int i = 0; i < 300; ++i) {
+        QVERIFY(index.find(PATH + "a" + QString::number(i), MTIME, SIZE, &entry));
+        QVERIFY(index.find(PATH + "b" + QString::number(i), MTIME, SIZE, &entry));
+    }
+}
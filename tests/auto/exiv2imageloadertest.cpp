@@ -0,0 +1,108 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "exiv2imageloadertest.h"
+
+// STL
+#include <memory>
+#include <sstream>
+
+// Qt
+#include <QImage>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Exiv2
+#include <exiv2/exiv2.hpp>
+
+// Local
+#include "../lib/exiv2imageloader.h"
+#include "testutils.h"
+
+QTEST_MAIN(Exiv2ImageLoaderTest)
+
+using namespace Gwenview;
+
+/**
+ * Returns the pixel size and the Exif entries of @p image as a list of
+ * strings, to compare images loaded in different ways
+ */
+static QStringList describeImage(Exiv2::Image* image)
+{
+    QStringList list;
+    list << QStringLiteral("%1x%2").arg(image->pixelWidth()).arg(image->pixelHeight());
+    const Exiv2::ExifData& exifData = image->exifData();
+    for (auto it = exifData.begin(); it != exifData.end(); ++it) {
+        std::ostringstream stream;
+        stream << it->key() << '=' << *it;
+        list << QString::fromStdString(stream.str());
+    }
+    return list;
+}
+
+static void compareLoaders(const QString& path)
+{
+    Exiv2ImageLoader fullLoader;
+    QVERIFY(fullLoader.load(path));
+    std::unique_ptr<Exiv2::Image> fullImage = fullLoader.popImage();
+
+    Exiv2ImageLoader headerLoader;
+    QVERIFY(headerLoader.loadHeader(path));
+    std::unique_ptr<Exiv2::Image> headerImage = headerLoader.popImage();
+
+    QCOMPARE(describeImage(headerImage.get()), describeImage(fullImage.get()));
+}
+
+void Exiv2ImageLoaderTest::testLoadHeader_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    QTest::newRow("orientation") << "orient6.jpg";
+    QTest::newRow("thumbnail") << "embedded-thumbnail.jpg";
+    QTest::newRow("datetime") << "date/exif-datetimeoriginal.jpg";
+    // Not a JPEG or TIFF file: loaded as a whole
+    QTest::newRow("png") << "test.png";
+}
+
+void Exiv2ImageLoaderTest::testLoadHeader()
+{
+    QFETCH(QString, fileName);
+    compareLoaders(pathForTestFile(fileName));
+}
+
+void Exiv2ImageLoaderTest::testLoadTiffHeader()
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/image.tif";
+    QImage image(300, 200, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QVERIFY(image.save(path, "TIFF"));
+
+    {
+        std::unique_ptr<Exiv2::Image> exivImage(Exiv2::ImageFactory::open(QFile::encodeName(path).constData()).release());
+        exivImage->readMetadata();
+        Exiv2::ExifData exifData = exivImage->exifData();
+        exifData["Exif.Photo.DateTimeOriginal"] = "2003:03:10 17:45:21";
+        exifData["Exif.Image.Orientation"] = uint16_t(6);
+        exivImage->setExifData(exifData);
+        exivImage->writeMetadata();
+    }
+
+    compareLoaders(path);
+}
@@ -0,0 +1,119 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "filenameindextest.h"
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+// KDE
+#include <KDirLister>
+#include <KDirModel>
+
+// Local
+#include "../lib/filenameindex.h"
+#include "testutils.h"
+
+QTEST_MAIN(FileNameIndexTest)
+
+using namespace Gwenview;
+
+static QStringList matchingNames(const KDirModel& model, const FileNameIndex& index)
+{
+    QStringList names;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        const QModelIndex modelIndex = model.index(row, 0);
+        if (index.matches(modelIndex)) {
+            names << modelIndex.data().toString();
+        }
+    }
+    names.sort();
+    return names;
+}
+
+static void loadDir(KDirModel* model, const QString& path, int expectedCount)
+{
+    model->dirLister()->openUrl(QUrl::fromLocalFile(path));
+    QTRY_COMPARE(model->rowCount(), expectedCount);
+}
+
+void FileNameIndexTest::testMatches()
+{
+    QTemporaryDir dir;
+    createEmptyFile(dir.path() + "/Holidays-001.jpg");
+    createEmptyFile(dir.path() + "/holidays-002.jpg");
+    createEmptyFile(dir.path() + "/birthday.png");
+
+    KDirModel model;
+    loadDir(&model, dir.path(), 3);
+    FileNameIndex index(&model);
+
+    // Empty text matches everything
+    QCOMPARE(matchingNames(model, index).size(), 3);
+
+    QVERIFY(index.setText(QStringLiteral("HOLI")));
+    QCOMPARE(matchingNames(model, index), QStringList() << "Holidays-001.jpg" << "holidays-002.jpg");
+
+    // Narrowing, shorter than a trigram
+    QVERIFY(index.setText(QStringLiteral("HOLIDAYS-0")));
+    QCOMPARE(matchingNames(model, index), QStringList() << "Holidays-001.jpg" << "holidays-002.jpg");
+    QVERIFY(index.setText(QStringLiteral("holidays-002")));
+    QCOMPARE(matchingNames(model, index), QStringList() << "holidays-002.jpg");
+
+    // Same matches
+    QVERIFY(!index.setText(QStringLiteral("holidays-002.")));
+
+    QVERIFY(index.setText(QStringLiteral("day")));
+    QCOMPARE(matchingNames(model, index).size(), 3);
+    QVERIFY(!index.setText(QStringLiteral("y")));
+    QCOMPARE(matchingNames(model, index).size(), 3);
+    QVERIFY(index.setText(QStringLiteral("xyz")));
+    QCOMPARE(matchingNames(model, index), QStringList());
+}
+
+void FileNameIndexTest::testModelChanges()
+{
+    QTemporaryDir dir;
+    createEmptyFile(dir.path() + "/a-photo.jpg");
+    createEmptyFile(dir.path() + "/b.jpg");
+
+    KDirModel model;
+    loadDir(&model, dir.path(), 2);
+    FileNameIndex index(&model);
+    index.setText(QStringLiteral("photo"));
+    QCOMPARE(matchingNames(model, index), QStringList() << "a-photo.jpg");
+
+    const QUrl url = QUrl::fromLocalFile(dir.path());
+    createEmptyFile(dir.path() + "/c-photo.jpg");
+    model.dirLister()->updateDirectory(url);
+    QTRY_COMPARE(model.rowCount(), 3);
+    QCOMPARE(matchingNames(model, index), QStringList() << "a-photo.jpg" << "c-photo.jpg");
+
+    QVERIFY(QFile::remove(dir.path() + "/a-photo.jpg"));
+    model.dirLister()->updateDirectory(url);
+    QTRY_COMPARE(model.rowCount(), 2);
+    QCOMPARE(matchingNames(model, index), QStringList() << "c-photo.jpg");
+
+    // Narrowing must not bring back removed items
+    QVERIFY(!index.setText(QStringLiteral("photo.")));
+    QCOMPARE(matchingNames(model, index), QStringList() << "c-photo.jpg");
+}
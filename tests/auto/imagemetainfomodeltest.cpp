@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <memory>
 
 // Qt
+#include <QThreadPool>
+#include <QTreeView>
 
 // KDE
 #include <QDebug>
@@ -30,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 // Local
 #include "../lib/exiv2imageloader.h"
 #include "../lib/imagemetainfomodel.h"
+#include "../lib/preferredimagemetainfomodel.h"
 #include "testutils.h"
 
 // Exiv2
@@ -60,4 +63,86 @@ void ImageMetaInfoModelTest::testCatchExiv2Errors()
 
     ImageMetaInfoModel model;
     model.setExiv2Image(image.get());
+    // Groups are formatted when fetched
+    for (int row = 0; row < model.rowCount(); ++row) {
+        model.fetchMore(model.index(row, 0));
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+}
+
+void ImageMetaInfoModelTest::testLazyGroups()
+{
+    std::unique_ptr<Exiv2::Image> image;
+    {
+        Exiv2ImageLoader loader;
+        QVERIFY(loader.load(pathForTestFile("orient6.jpg")));
+        image = loader.popImage();
+    }
+
+    ImageMetaInfoModel model;
+    model.setExiv2Image(image.get());
+
+    QModelIndex exifIndex;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        QModelIndex index = model.index(row, 0);
+        if (index.data().toString() == QLatin1String("EXIF")) {
+            exifIndex = index;
+        }
+    }
+    QVERIFY(exifIndex.isValid());
+    QCOMPARE(model.rowCount(exifIndex), 0);
+
+    // Keys can be read before the group is filled
+    const QString orientation = model.getValueForKey(QStringLiteral("Exif.Image.Orientation"));
+    QVERIFY(!orientation.isEmpty());
+
+    QVERIFY(model.canFetchMore(exifIndex));
+    model.fetchMore(exifIndex);
+    QTRY_VERIFY(model.rowCount(exifIndex) > 0);
+    QVERIFY(!model.canFetchMore(exifIndex));
+    QCOMPARE(model.getValueForKey(QStringLiteral("Exif.Image.Orientation")), orientation);
+
+    // Fetched groups are filled again when the image changes
+    model.setExiv2Image(image.get());
+    QCOMPARE(model.rowCount(exifIndex), 0);
+    QTRY_VERIFY(model.rowCount(exifIndex) > 0);
+
+    // The model keeps its own copy of the metadata
+    image.reset();
+    QCOMPARE(model.getValueForKey(QStringLiteral("Exif.Image.Orientation")), orientation);
+}
+
+void ImageMetaInfoModelTest::testTreeViewFetchesGroups()
+{
+    std::unique_ptr<Exiv2::Image> image;
+    {
+        Exiv2ImageLoader loader;
+        QVERIFY(loader.load(pathForTestFile("orient6.jpg")));
+        image = loader.popImage();
+    }
+
+    ImageMetaInfoModel model;
+    model.setExiv2Image(image.get());
+    PreferredImageMetaInfoModel proxy(&model, QStringList());
+
+    QModelIndex exifIndex;
+    for (int row = 0; row < proxy.rowCount(); ++row) {
+        QModelIndex index = proxy.index(row, 0);
+        if (index.data().toString() == QLatin1String("EXIF")) {
+            exifIndex = index;
+        }
+    }
+    QVERIFY(exifIndex.isValid());
+    // The group is empty, but must not look childless: views would never
+    // fetch it
+    QCOMPARE(proxy.rowCount(exifIndex), 0);
+    QVERIFY(proxy.hasChildren(exifIndex));
+
+    // Expanding the group in a view is enough to fill it
+    QTreeView view;
+    view.setModel(&proxy);
+    view.expand(exifIndex);
+    view.doItemsLayout();
+    QTRY_VERIFY(proxy.rowCount(exifIndex) > 0);
 }
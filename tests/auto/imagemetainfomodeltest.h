@@ -33,6 +33,8 @@ class ImageMetaInfoModelTest : public QObject
 
 private Q_SLOTS:
     void testCatchExiv2Errors();
+    void testLazyGroups();
+    void testTreeViewFetchesGroups();
 };
 
 #endif // IMAGEMETAINFOMODELTEST_H
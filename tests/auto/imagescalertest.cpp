@@ -17,12 +17,15 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 */
+#include <QEventLoop>
 #include <qtest.h>
 
 #include "imagescalertest.h"
 
 #include "../lib/imagescaler.h"
 #include "../lib/document/documentfactory.h"
+#include "../lib/document/editchain.h"
+#include "../lib/transformimageoperation.h"
 
 #include "testutils.h"
 
@@ -66,6 +69,39 @@ void ImageScalerTest::testScaleFullImage()
     QVERIFY(TestUtils::imageCompare(scaledImage, expectedImage));
 }
 
+/**
+ * Scale an image which has a pending rotation: the result must be the same as
+ * scaling the rotated image
+ */
+void ImageScalerTest::testScaleTransformedImage()
+{
+    QUrl url = urlForTestFile("test.png");
+    Document::Ptr doc = DocumentFactory::instance()->load(url);
+    doc->waitUntilLoaded();
+
+    QEventLoop loop;
+    connect(doc.data(), &Document::allTasksDone, &loop, &QEventLoop::quit);
+    TransformImageOperation* op = new TransformImageOperation(ROT_90);
+    op->applyToDocument(doc);
+    loop.exec();
+    QVERIFY(!doc->edits().isEmpty());
+
+    ImageScaler scaler;
+    ImageScalerClient client(&scaler);
+    scaler.setDocument(doc);
+    scaler.setZoom(1);
+    // Render in two parts to check tiles are put at the right place
+    QRegion region;
+    region |= QRect(0, 0, doc->width() / 2, doc->height());
+    region |= QRect(doc->width() / 2, 0, doc->width() - doc->width() / 2, doc->height());
+    scaler.setDestinationRegion(region);
+    QImage scaledImage = client.createFullImage();
+
+    // Scaling must not have applied the transformation to the document
+    QVERIFY(!doc->edits().isEmpty());
+    QVERIFY(TestUtils::imageCompare(scaledImage, doc->image()));
+}
+
 #if 0
 /**
  * Scale parts of an image
@@ -0,0 +1,163 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "imageutilstest.h"
+
+// Qt
+#include <QImage>
+#include <QPainter>
+#include <QTest>
+#include <QTransform>
+
+// Local
+#include "../lib/imageutils.h"
+
+QTEST_MAIN(ImageUtilsTest)
+
+using namespace Gwenview;
+
+static QImage createTestImage(const QSize& size, QImage::Format format)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    QPainter painter(&image);
+    painter.fillRect(image.rect(), Qt::white);
+    for (int x = 0; x < size.width(); x += 5) {
+        painter.setPen(QColor::fromHsv(x % 360, 255, 255));
+        painter.drawLine(x, 0, size.width() - x, size.height());
+    }
+    painter.end();
+    return image.convertToFormat(format);
+}
+
+static QImage createTranslucentTestImage(const QSize& size)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            line[x] = qRgba(x * 255 / size.width(), y * 255 / size.height(), 128, (x + y) % 256);
+        }
+    }
+    return image;
+}
+
+/**
+ * Paints @p image over an opaque background, like RasterImageView does
+ */
+static QImage paintOverBackground(const QImage& image)
+{
+    QImage result(image.size(), QImage::Format_RGB32);
+    QPainter painter(&result);
+    painter.fillRect(result.rect(), QColor(64, 128, 192));
+    painter.drawImage(0, 0, image);
+    return result;
+}
+
+void ImageUtilsTest::testTransformed_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<int>("orientation");
+
+    const QList<QPair<QByteArray, QImage::Format>> formats = {
+        { "rgb32", QImage::Format_RGB32 },
+        { "argb32pm", QImage::Format_ARGB32_Premultiplied },
+        { "rgb888", QImage::Format_RGB888 },
+        { "rgb16", QImage::Format_RGB16 },
+        { "gray8", QImage::Format_Grayscale8 },
+        { "indexed8", QImage::Format_Indexed8 },
+        { "mono", QImage::Format_Mono },
+    };
+    const QList<QPair<QByteArray, Orientation>> orientations = {
+        { "hflip", HFLIP },
+        { "vflip", VFLIP },
+        { "rot180", ROT_180 },
+        { "transpose", TRANSPOSE },
+        { "rot90", ROT_90 },
+        { "transverse", TRANSVERSE },
+        { "rot270", ROT_270 },
+    };
+    for (const auto& format : formats) {
+        for (const auto& orientation : orientations) {
+            QTest::newRow((format.first + '-' + orientation.first).constData()) << int(format.second) << int(orientation.second);
+        }
+    }
+}
+
+void ImageUtilsTest::testTransformed()
+{
+    QFETCH(int, format);
+    QFETCH(int, orientation);
+    // Big enough to be split over several threads, odd sizes to exercise
+    // borders of tiles and SIMD blocks
+    const QImage image = createTestImage(QSize(1031, 517), QImage::Format(format));
+
+    const QImage result = ImageUtils::transformed(image, Orientation(orientation));
+    const QImage expected = image.transformed(ImageUtils::transformMatrix(Orientation(orientation)));
+
+    QCOMPARE(result.size(), expected.size());
+    QCOMPARE(result.convertToFormat(QImage::Format_ARGB32), expected.convertToFormat(QImage::Format_ARGB32));
+    if (image.depth() >= 8) {
+        QCOMPARE(result.format(), image.format());
+    }
+}
+
+void ImageUtilsTest::testTransformedWithMatrix()
+{
+    const QImage image = createTestImage(QSize(40, 30), QImage::Format_RGB32);
+
+    // Composed orientations are recognized
+    QTransform matrix = ImageUtils::transformMatrix(ROT_90) * ImageUtils::transformMatrix(HFLIP);
+    QCOMPARE(ImageUtils::transformed(image, matrix), image.transformed(matrix));
+
+    // Other transformations fall back to QImage::transformed()
+    matrix = QTransform().rotate(30);
+    QCOMPARE(ImageUtils::transformed(image, matrix), image.transformed(matrix));
+}
+
+void ImageUtilsTest::testConvertToStorageFormat_data()
+{
+    QTest::addColumn<QImage>("image");
+    QTest::addColumn<int>("expectedFormat");
+
+    const QSize size(67, 43);
+    const QImage translucent = createTranslucentTestImage(size);
+    QTest::newRow("argb32") << translucent << int(QImage::Format_ARGB32_Premultiplied);
+    QTest::newRow("argb32pm") << translucent.convertToFormat(QImage::Format_ARGB32_Premultiplied) << int(QImage::Format_ARGB32_Premultiplied);
+
+    QTest::newRow("rgb32") << createTestImage(size, QImage::Format_RGB32) << int(QImage::Format_RGB32);
+    QTest::newRow("rgb888") << createTestImage(size, QImage::Format_RGB888) << int(QImage::Format_RGB888);
+    QTest::newRow("rgb16") << createTestImage(size, QImage::Format_RGB16) << int(QImage::Format_RGB32);
+    QTest::newRow("gray8") << createTestImage(size, QImage::Format_Grayscale8) << int(QImage::Format_Grayscale8);
+    QTest::newRow("indexed8") << createTestImage(size, QImage::Format_Indexed8) << int(QImage::Format_RGB888);
+    QTest::newRow("indexed8-gray") << createTestImage(size, QImage::Format_Grayscale8).convertToFormat(QImage::Format_Indexed8) << int(QImage::Format_Grayscale8);
+    QTest::newRow("mono") << createTestImage(size, QImage::Format_Mono) << int(QImage::Format_Grayscale8);
+}
+
+void ImageUtilsTest::testConvertToStorageFormat()
+{
+    QFETCH(QImage, image);
+    QFETCH(int, expectedFormat);
+
+    const QImage result = ImageUtils::convertToStorageFormat(image);
+    QCOMPARE(int(result.format()), expectedFormat);
+    QCOMPARE(result.size(), image.size());
+
+    // The converted image must look the same once painted
+    QCOMPARE(paintOverBackground(result), paintOverBackground(image));
+}
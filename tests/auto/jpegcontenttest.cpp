@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <QDir>
 #include <QFile>
 #include <QImage>
+#include <QImageReader>
 #include <QString>
 
 // KDE
@@ -32,7 +33,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 // Local
 #include "../lib/orientation.h"
+#include "../lib/imageutils.h"
 #include "../lib/jpegcontent.h"
+#include "../lib/orientedjpegdecoder.h"
 #include "testutils.h"
 
 using namespace std;
@@ -302,3 +305,181 @@ void JpegContentTest::testSetImage()
 //    ignoredKeys << "Orientation";
 //    compareMetaInfo(pathForTestFile(ORIENT6_FILE), pathForTestFile(TMP_FILE), ignoredKeys);
 }
+
+void JpegContentTest::testLosslessCrop()
+{
+    // Generate a JPEG without Exif orientation, so that the crop is the only
+    // transformation
+    QImage image(96, 80, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgb(x * 2, y * 3, x + y));
+        }
+    }
+    bool result = image.save(TMP_FILE, "JPEG", 95);
+    QVERIFY(result);
+    const QImage reference(TMP_FILE);
+    QVERIFY(!reference.isNull());
+
+    Gwenview::JpegContent content;
+    result = content.load(TMP_FILE);
+    QVERIFY(result);
+
+    const QSize alignment = content.losslessCropAlignment();
+    QVERIFY(alignment.isValid());
+
+    // Not aligned
+    result = content.crop(QRect(alignment.width() + 1, 0, 16, 16));
+    QVERIFY(!result);
+    QCOMPARE(content.size(), image.size());
+
+    const QRect rect(alignment.width(), alignment.height() * 2, 41, 23);
+    result = content.crop(rect);
+    QVERIFY(result);
+    QCOMPARE(content.size(), rect.size());
+
+    result = content.save(TMP_FILE);
+    QVERIFY(result);
+
+    const QImage cropped(TMP_FILE);
+    QCOMPARE(cropped.size(), rect.size());
+
+    // DCT blocks are kept as is, but chroma upsampling uses neighbor
+    // pixels, which are not the same along the new edges
+    const int margin = 4;
+    for (int y = margin; y < cropped.height() - margin; ++y) {
+        for (int x = margin; x < cropped.width() - margin; ++x) {
+            QCOMPARE(cropped.pixel(x, y), reference.pixel(rect.x() + x, rect.y() + y));
+        }
+    }
+}
+
+void JpegContentTest::testLosslessCropTransformed_data()
+{
+    QTest::addColumn<int>("orientation");
+    QTest::newRow("hflip") << int(HFLIP);
+    QTest::newRow("vflip") << int(VFLIP);
+    QTest::newRow("transpose") << int(TRANSPOSE);
+    QTest::newRow("transverse") << int(TRANSVERSE);
+    QTest::newRow("rot90") << int(ROT_90);
+    QTest::newRow("rot180") << int(ROT_180);
+    QTest::newRow("rot270") << int(ROT_270);
+}
+
+void JpegContentTest::testLosslessCropTransformed()
+{
+    QFETCH(int, orientation);
+    // A size which is not a multiple of the iMCU size, so that some
+    // transformations move partial DCT blocks to the left or top edges
+    QImage image(100, 84, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            image.setPixel(x, y, qRgb(x * 2, y * 3, x + y));
+        }
+    }
+    bool result = image.save(TMP_FILE, "JPEG", 95);
+    QVERIFY(result);
+    const QImage reference = ImageUtils::transformed(QImage(TMP_FILE).convertToFormat(QImage::Format_RGB32), Orientation(orientation));
+    QVERIFY(!reference.isNull());
+
+    Gwenview::JpegContent content;
+    result = content.load(TMP_FILE);
+    QVERIFY(result);
+    content.transform(Orientation(orientation));
+
+    const QSize alignment = content.losslessCropAlignment();
+    QVERIFY(alignment.isValid());
+    const QPoint origin = content.losslessCropOrigin();
+
+    if (!origin.isNull()) {
+        // Partial blocks before the origin cannot be kept
+        result = content.crop(QRect(QPoint(0, 0), reference.size()));
+        QVERIFY(!result);
+        QCOMPARE(content.size(), image.size());
+    }
+
+    const QRect rect(origin.x() + alignment.width(), origin.y() + alignment.height(), 41, 23);
+    result = content.crop(rect);
+    QVERIFY(result);
+    QCOMPARE(content.size(), rect.size());
+
+    result = content.save(TMP_FILE);
+    QVERIFY(result);
+
+    const QImage cropped = QImage(TMP_FILE).convertToFormat(QImage::Format_RGB32);
+    QCOMPARE(cropped.size(), rect.size());
+
+    // Transformed DCT blocks do not decode exactly like transformed pixels,
+    // and chroma upsampling differs along the new edges
+    const int margin = 4;
+    const int delta = 4;
+    for (int y = margin; y < cropped.height() - margin; ++y) {
+        for (int x = margin; x < cropped.width() - margin; ++x) {
+            const QRgb pixel = cropped.pixel(x, y);
+            const QRgb expectedPixel = reference.pixel(rect.x() + x, rect.y() + y);
+            QVERIFY2(qAbs(qRed(pixel) - qRed(expectedPixel)) <= delta
+                     && qAbs(qGreen(pixel) - qGreen(expectedPixel)) <= delta
+                     && qAbs(qBlue(pixel) - qBlue(expectedPixel)) <= delta,
+                     qPrintable(QStringLiteral("Pixels differ at %1,%2").arg(x).arg(y)));
+        }
+    }
+}
+
+void JpegContentTest::testOrientedDecoder_data()
+{
+    QTest::addColumn<int>("orientation");
+    QTest::newRow("normal") << int(NORMAL);
+    QTest::newRow("hflip") << int(HFLIP);
+    QTest::newRow("rot180") << int(ROT_180);
+    QTest::newRow("transpose") << int(TRANSPOSE);
+    QTest::newRow("rot90") << int(ROT_90);
+    QTest::newRow("rot270") << int(ROT_270);
+}
+
+void JpegContentTest::testOrientedDecoder()
+{
+    QFETCH(int, orientation);
+    QFile file(pathForTestFile(ORIENT6_FILE));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QImage image;
+    QVERIFY(OrientedJpegDecoder::read(&file, Orientation(orientation), QSize(), &image));
+
+    QImageReader reader(pathForTestFile(ORIENT6_FILE));
+    reader.setAutoTransform(false);
+    QImage expected = reader.read().convertToFormat(QImage::Format_RGB32);
+    expected = ImageUtils::transformed(expected, Orientation(orientation));
+
+    QCOMPARE(image.size(), expected.size());
+    // Allow small differences between libjpeg settings
+    const int delta = 2;
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb pixel = image.pixel(x, y);
+            const QRgb expectedPixel = expected.pixel(x, y);
+            QVERIFY2(qAbs(qRed(pixel) - qRed(expectedPixel)) <= delta
+                     && qAbs(qGreen(pixel) - qGreen(expectedPixel)) <= delta
+                     && qAbs(qBlue(pixel) - qBlue(expectedPixel)) <= delta,
+                     qPrintable(QStringLiteral("Pixels differ at %1,%2").arg(x).arg(y)));
+        }
+    }
+}
+
+void JpegContentTest::testOrientedDecoderScaled()
+{
+    QFile file(pathForTestFile(ORIENT6_FILE));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QImage image;
+    // Scaled size is before orientation is applied
+    QVERIFY(OrientedJpegDecoder::read(&file, ROT_90, QSize(ORIENT6_HEIGHT / 4, ORIENT6_WIDTH / 4), &image));
+    QCOMPARE(image.size(), QSize(ORIENT6_WIDTH / 4, ORIENT6_HEIGHT / 4));
+
+    // Beyond what DCT scaling can do
+    QVERIFY(file.seek(0));
+    QVERIFY(OrientedJpegDecoder::read(&file, ROT_90, QSize(ORIENT6_HEIGHT / 16, ORIENT6_WIDTH / 16), &image));
+    QCOMPARE(image.size(), QSize(ORIENT6_WIDTH / 16, ORIENT6_HEIGHT / 16));
+
+    // Not a power of 2
+    QVERIFY(file.seek(0));
+    QVERIFY(OrientedJpegDecoder::read(&file, ROT_90, QSize(ORIENT6_HEIGHT / 3, ORIENT6_WIDTH / 3), &image));
+    QCOMPARE(image.size(), QSize(ORIENT6_WIDTH / 3, ORIENT6_HEIGHT / 3));
+}
@@ -39,6 +39,12 @@ private Q_SLOTS:
     void testLoadTruncated();
     void testRawData();
     void testSetImage();
+    void testLosslessCrop();
+    void testLosslessCropTransformed();
+    void testLosslessCropTransformed_data();
+    void testOrientedDecoder();
+    void testOrientedDecoder_data();
+    void testOrientedDecoderScaled();
 };
 
 #endif // JPEGCONTENTTEST_H
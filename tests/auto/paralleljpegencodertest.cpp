@@ -0,0 +1,113 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "paralleljpegencodertest.h"
+
+// Qt
+#include <QBuffer>
+#include <QImage>
+#include <QImageWriter>
+#include <QPainter>
+#include <QTest>
+
+// Local
+#include "../lib/paralleljpegencoder.h"
+
+QTEST_MAIN(ParallelJpegEncoderTest)
+
+using namespace Gwenview;
+
+static const int QUALITY = 90;
+
+static QImage createTestImage(const QSize& size, QImage::Format format)
+{
+    QImage image(size, QImage::Format_RGB32);
+    QPainter painter(&image);
+    painter.fillRect(image.rect(), Qt::white);
+    for (int x = 0; x < size.width(); x += 5) {
+        painter.setPen(QColor::fromHsv(x * 7 % 360, 255, 255));
+        painter.drawLine(x, 0, size.width() - x, size.height());
+    }
+    painter.end();
+    return image.convertToFormat(format);
+}
+
+// Mean absolute difference between the channels of two images
+static qreal difference(const QImage& image1, const QImage& image2)
+{
+    const QImage rgb1 = image1.convertToFormat(QImage::Format_RGB32);
+    const QImage rgb2 = image2.convertToFormat(QImage::Format_RGB32);
+    qint64 sum = 0;
+    for (int y = 0; y < rgb1.height(); ++y) {
+        const QRgb* line1 = reinterpret_cast<const QRgb*>(rgb1.constScanLine(y));
+        const QRgb* line2 = reinterpret_cast<const QRgb*>(rgb2.constScanLine(y));
+        for (int x = 0; x < rgb1.width(); ++x) {
+            sum += qAbs(qRed(line1[x]) - qRed(line2[x]))
+                + qAbs(qGreen(line1[x]) - qGreen(line2[x]))
+                + qAbs(qBlue(line1[x]) - qBlue(line2[x]));
+        }
+    }
+    return qreal(sum) / (rgb1.width() * rgb1.height() * 3);
+}
+
+void ParallelJpegEncoderTest::testEncode_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("format");
+
+    // Heights which are not a multiple of the stripe height
+    QTest::newRow("rgb32") << QSize(1600, 1203) << int(QImage::Format_RGB32);
+    QTest::newRow("argb32") << QSize(1203, 1600) << int(QImage::Format_ARGB32_Premultiplied);
+    QTest::newRow("grayscale") << QSize(1100, 1030) << int(QImage::Format_Grayscale8);
+    QTest::newRow("rgb888") << QSize(1024, 1024) << int(QImage::Format_RGB888);
+}
+
+void ParallelJpegEncoderTest::testEncode()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, format);
+    const QImage image = createTestImage(size, QImage::Format(format));
+
+    const QByteArray data = ParallelJpegEncoder::encode(image, QUALITY);
+    QVERIFY(!data.isEmpty());
+    const QImage result = QImage::fromData(data, "jpeg");
+    QCOMPARE(result.size(), size);
+    QCOMPARE(result.format() == QImage::Format_Grayscale8, format == QImage::Format_Grayscale8);
+
+    // Compare with the single-threaded path
+    QBuffer buffer;
+    QImageWriter writer(&buffer, "jpeg");
+    writer.setQuality(QUALITY);
+    QVERIFY(writer.write(image));
+    const QImage expected = QImage::fromData(buffer.data(), "jpeg");
+
+    // Restart markers add a few bytes per MCU row
+    QVERIFY2(data.size() < buffer.data().size() * 1.02,
+             qPrintable(QStringLiteral("%1 >> %2").arg(data.size()).arg(buffer.data().size())));
+    const qreal resultDifference = difference(image, result);
+    const qreal expectedDifference = difference(image, expected);
+    QVERIFY2(resultDifference <= expectedDifference * 1.02 + 0.01,
+             qPrintable(QStringLiteral("%1 >> %2").arg(resultDifference).arg(expectedDifference)));
+}
+
+void ParallelJpegEncoderTest::testSmallImage()
+{
+    const QImage image = createTestImage(QSize(200, 100), QImage::Format_RGB32);
+    QVERIFY(ParallelJpegEncoder::encode(image, QUALITY).isEmpty());
+}
@@ -84,6 +84,16 @@ void RecursiveDirModelTest::testBasic_data()
             << "d2/a.jpg"
             << "d3/a.jpg"
         );
+    NEW_ROW("images_in_nested_dirs",
+        QStringList()
+            << "d1/pict1.jpg"
+            << "d1/d2/pict2.jpg"
+            << "d1/d2/d3/pict3.jpg",
+        QStringList()
+            << "d1/d2/d4/pict4.jpg",
+        QStringList()
+            << "d1/d2/pict2.jpg"
+        );
 #undef NEW_ROW
 }
 
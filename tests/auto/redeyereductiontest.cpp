@@ -0,0 +1,130 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "redeyereductiontest.h"
+
+// Stdc
+#include <math.h>
+
+// Qt
+#include <QColor>
+#include <QImage>
+#include <QTest>
+
+// Local
+#include "../lib/ramp.h"
+#include "../lib/redeyereduction/redeyereductionimageoperation.h"
+
+QTEST_MAIN(RedEyeReductionTest)
+
+using namespace Gwenview;
+
+/**
+ * Red eye reduction as it was implemented before PixelKernels: one QColor
+ * per pixel, single thread
+ */
+static void legacyRedEye(QImage* img, const QRectF& rectF)
+{
+    const QRect rect = rectF.toAlignedRect();
+    const qreal radius = rectF.width() / 2;
+    const qreal centerX = rectF.x() + radius;
+    const qreal centerY = rectF.y() + radius;
+    const Ramp radiusRamp(qMin(qreal(radius * 0.7), qreal(radius - 1)), radius, qreal(1.), qreal(0.));
+
+    uchar* line = img->scanLine(rect.top()) + rect.left() * 4;
+    for (int y = rect.top(); y < rect.bottom(); ++y, line += img->bytesPerLine()) {
+        QRgb* ptr = (QRgb*)line;
+        for (int x = rect.left(); x < rect.right(); ++x, ++ptr) {
+            const qreal currentRadius = sqrt(pow(y - centerY, 2) + pow(x - centerX, 2));
+            qreal alpha = radiusRamp(currentRadius);
+            if (qFuzzyCompare(alpha, 0)) {
+                continue;
+            }
+            const QColor src(*ptr);
+            int hue, sat, value;
+            src.getHsv(&hue, &sat, &value);
+            const Ramp ramp = hue > 259 ? Ramp(30, 35, 0., 1.) : Ramp(hue * 2 + 29, hue * 2 + 40, 0., 1.);
+            alpha *= qBound(qreal(0.), src.alphaF() * ramp(sat), qreal(1.));
+            QColor dst;
+            dst.setRed(int((1 - alpha) * src.red() + alpha * src.green()));
+            dst.setGreen(src.green());
+            dst.setBlue(src.blue());
+            *ptr = dst.rgba();
+        }
+    }
+}
+
+/**
+ * Reddish pixels of all kinds, with some gray ones
+ */
+static QImage createImage()
+{
+    QImage image(64, 48, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const int red = 128 + (x * 2 + y) % 128;
+            const int other = (x * 7 + y * 3) % 160;
+            image.setPixel(x, y, (x + y) % 11 == 0 ? qRgb(other, other, other) : qRgb(red, other, (other * 3) % 140));
+        }
+    }
+    return image;
+}
+
+void RedEyeReductionTest::testSameAsLegacy_data()
+{
+    QTest::addColumn<QRectF>("rect");
+    QTest::newRow("inside") << QRectF(10, 8, 30, 30);
+    QTest::newRow("fractional") << QRectF(12.4, 5.7, 21.5, 21.5);
+    QTest::newRow("small") << QRectF(30, 20, 4, 4);
+    QTest::newRow("touching edges") << QRectF(0, 0, 48, 48);
+}
+
+void RedEyeReductionTest::testSameAsLegacy()
+{
+    QFETCH(QRectF, rect);
+    const QImage source = createImage();
+    QImage expected = source;
+    legacyRedEye(&expected, rect);
+    QImage image = source;
+    RedEyeReductionImageOperation::apply(&image, rect);
+
+    QCOMPARE(image.size(), expected.size());
+    // Hue and saturation are computed with doubles instead of QColor
+    // integers, allow rounding differences
+    const int delta = 1;
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const QRgb pixel = image.pixel(x, y);
+            const QRgb expectedPixel = expected.pixel(x, y);
+            QVERIFY2(qAbs(qRed(pixel) - qRed(expectedPixel)) <= delta
+                     && qGreen(pixel) == qGreen(expectedPixel)
+                     && qBlue(pixel) == qBlue(expectedPixel),
+                     qPrintable(QStringLiteral("Pixels differ at %1,%2").arg(x).arg(y)));
+        }
+    }
+
+    // The last column and row of the rect are not modified
+    const QRect alignedRect = rect.toAlignedRect();
+    for (int y = alignedRect.top(); y <= alignedRect.bottom(); ++y) {
+        QCOMPARE(image.pixel(alignedRect.right(), y), source.pixel(alignedRect.right(), y));
+    }
+    for (int x = alignedRect.left(); x <= alignedRect.right(); ++x) {
+        QCOMPARE(image.pixel(x, alignedRect.bottom()), source.pixel(x, alignedRect.bottom()));
+    }
+}
@@ -0,0 +1,166 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "renderschedulertest.h"
+
+// Qt
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QTest>
+
+// Local
+#include "../lib/document/documentfactory.h"
+#include "../lib/documentview/renderscheduler.h"
+#include "../lib/imagescaler.h"
+#include "testutils.h"
+
+QTEST_MAIN(RenderSchedulerTest)
+
+using namespace Gwenview;
+
+static RenderScheduler::Tile createTile(int x)
+{
+    RenderScheduler::Tile tile;
+    tile.topLeft = QPoint(x, 0);
+    tile.image = QImage(4, 4, QImage::Format_ARGB32_Premultiplied);
+    return tile;
+}
+
+void RenderSchedulerTest::testBatchDelivery()
+{
+    RenderScheduler scheduler;
+    QObject client;
+    QList<int> delivered;
+    for (int x = 0; x < 3; ++x) {
+        scheduler.schedule(&client,
+            [x]() {
+                return createTile(x);
+            },
+            [&delivered](const RenderScheduler::Tile& tile) {
+                delivered << tile.topLeft.x();
+            });
+    }
+    // Nothing happens before going back to the event loop
+    QVERIFY(delivered.isEmpty());
+
+    QTRY_COMPARE(delivered.count(), 3);
+    QCOMPARE(delivered, QList<int>() << 0 << 1 << 2);
+}
+
+void RenderSchedulerTest::testRequestDuringBatch()
+{
+    RenderScheduler scheduler;
+    QObject client;
+    QSemaphore started;
+    QSemaphore blocker;
+    QList<int> delivered;
+    auto deliver = [&delivered](const RenderScheduler::Tile& tile) {
+        delivered << tile.topLeft.x();
+    };
+    scheduler.schedule(&client,
+        [&started, &blocker]() {
+            started.release();
+            blocker.acquire();
+            return createTile(0);
+        },
+        deliver);
+    QTRY_VERIFY(started.available() == 1);
+
+    // Goes in the next batch
+    scheduler.schedule(&client,
+        []() {
+            return createTile(1);
+        },
+        deliver);
+    blocker.release();
+
+    QTRY_COMPARE(delivered.count(), 2);
+    QCOMPARE(delivered, QList<int>() << 0 << 1);
+}
+
+void RenderSchedulerTest::testDeletedClient()
+{
+    RenderScheduler scheduler;
+    QObject* client = new QObject;
+    QObject otherClient;
+    QSemaphore started;
+    QSemaphore blocker;
+    bool staleDelivered = false;
+    bool otherDelivered = false;
+    scheduler.schedule(client,
+        [&started, &blocker]() {
+            started.release();
+            blocker.acquire();
+            return createTile(0);
+        },
+        [&staleDelivered](const RenderScheduler::Tile&) {
+            staleDelivered = true;
+        });
+    scheduler.schedule(&otherClient,
+        []() {
+            return createTile(1);
+        },
+        [&otherDelivered](const RenderScheduler::Tile&) {
+            otherDelivered = true;
+        });
+    QTRY_VERIFY(started.available() == 1);
+
+    // The client goes away while its tile is being rendered: the tile must
+    // be dropped, the other ones still delivered
+    delete client;
+    blocker.release();
+
+    QTRY_VERIFY(otherDelivered);
+    QVERIFY(!staleDelivered);
+}
+
+void RenderSchedulerTest::testStaleScalerTiles()
+{
+    Document::Ptr doc = DocumentFactory::instance()->load(urlForTestFile("test.png"));
+    doc->waitUntilLoaded();
+
+    RenderScheduler scheduler;
+    ImageScaler scaler;
+    scaler.setRenderScheduler(&scheduler);
+    scaler.setDocument(doc);
+    scaler.setZoom(2);
+    QSignalSpy spy(&scaler, SIGNAL(scaledRect(int,int,QImage)));
+    scaler.setDestinationRegion(QRect(QPoint(0, 0), doc->size() * 2));
+
+    // The zoom changes before the tiles are delivered: they are stale
+    scaler.setZoom(3);
+
+    // Requests are delivered in order: once this one is, the scaler tiles
+    // have been handled
+    QObject client;
+    bool done = false;
+    scheduler.schedule(&client,
+        []() {
+            return createTile(0);
+        },
+        [&done](const RenderScheduler::Tile&) {
+            done = true;
+        });
+    QTRY_VERIFY(done);
+    QCOMPARE(spy.count(), 0);
+
+    // Tiles for the current zoom get through
+    scaler.setDestinationRegion(QRect(QPoint(0, 0), doc->size() * 3));
+    QTRY_VERIFY(spy.count() > 0);
+}
@@ -0,0 +1,198 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "savequeuetest.h"
+
+// Qt
+#include <QHash>
+#include <QPointer>
+#include <QSignalSpy>
+#include <QTest>
+#include <QUrl>
+
+// KDE
+#include <KJob>
+
+// Local
+#include "../app/savequeue.h"
+
+QTEST_MAIN(SaveQueueTest)
+
+using namespace Gwenview;
+
+/**
+ * A job which only finishes when told to
+ */
+class StubJob : public KJob
+{
+public:
+    void start() override
+    {}
+
+    void finish()
+    {
+        emitResult();
+    }
+
+protected:
+    bool doKill() override
+    {
+        return true;
+    }
+};
+
+class StubSaveQueue : public SaveQueue
+{
+public:
+    StubSaveQueue(int maxRunningJobs, qint64 memoryBudget)
+    : SaveQueue(maxRunningJobs, memoryBudget)
+    , mMaxRunningJobCount(0)
+    {}
+
+    QHash<QUrl, qint64> mCosts;
+    QList<QUrl> mFailingUrls;
+    QList<QUrl> mStartedUrls;
+    QHash<QUrl, QPointer<StubJob>> mJobs;
+    int mMaxRunningJobCount;
+
+    void finish(const QUrl& url)
+    {
+        QVERIFY(mJobs.value(url));
+        mJobs.value(url)->finish();
+    }
+
+protected:
+    qint64 memoryCost(const QUrl& url) override
+    {
+        return mCosts.value(url);
+    }
+
+    KJob* createJob(const QUrl& url) override
+    {
+        mStartedUrls << url;
+        if (mFailingUrls.contains(url)) {
+            return nullptr;
+        }
+        // Not counted yet
+        mMaxRunningJobCount = qMax(mMaxRunningJobCount, runningJobCount() + 1);
+        StubJob* job = new StubJob;
+        mJobs.insert(url, job);
+        return job;
+    }
+};
+
+static QUrl urlForIndex(int index)
+{
+    return QUrl::fromLocalFile(QStringLiteral("/tmp/image%1.png").arg(index));
+}
+
+void SaveQueueTest::testConcurrency()
+{
+    StubSaveQueue queue(2, 1000);
+    QSignalSpy finishedSpy(&queue, &SaveQueue::jobFinished);
+    for (int i = 0; i < 5; ++i) {
+        queue.enqueue(urlForIndex(i));
+    }
+    queue.startJobs();
+    QCOMPARE(queue.runningJobCount(), 2);
+    QCOMPARE(queue.mStartedUrls, QList<QUrl>() << urlForIndex(0) << urlForIndex(1));
+
+    // Each finished job makes room for the next url, in order
+    queue.finish(urlForIndex(1));
+    QCOMPARE(queue.runningJobCount(), 2);
+    QCOMPARE(queue.mStartedUrls.last(), urlForIndex(2));
+
+    queue.finish(urlForIndex(0));
+    queue.finish(urlForIndex(2));
+    QCOMPARE(queue.runningJobCount(), 2);
+    queue.finish(urlForIndex(3));
+    QVERIFY(!queue.isEmpty());
+    queue.finish(urlForIndex(4));
+
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.mStartedUrls.count(), 5);
+    QCOMPARE(queue.mMaxRunningJobCount, 2);
+    QCOMPARE(finishedSpy.count(), 5);
+}
+
+void SaveQueueTest::testMemoryBudget()
+{
+    StubSaveQueue queue(4, 100);
+    const qint64 costs[] = {60, 30, 20, 150};
+    for (int i = 0; i < 4; ++i) {
+        queue.mCosts.insert(urlForIndex(i), costs[i]);
+        queue.enqueue(urlForIndex(i));
+    }
+    queue.startJobs();
+    // 60 + 30 + 20 would exceed the budget
+    QCOMPARE(queue.runningJobCount(), 2);
+    QCOMPARE(queue.runningMemoryCost(), qint64(90));
+
+    queue.finish(urlForIndex(0));
+    // 30 + 20 fits, 30 + 20 + 150 does not
+    QCOMPARE(queue.runningJobCount(), 2);
+    QCOMPARE(queue.runningMemoryCost(), qint64(50));
+
+    queue.finish(urlForIndex(1));
+    QCOMPARE(queue.runningJobCount(), 1);
+    QCOMPARE(queue.runningMemoryCost(), qint64(20));
+
+    // A job above the budget still runs, alone
+    queue.finish(urlForIndex(2));
+    QCOMPARE(queue.runningJobCount(), 1);
+    QCOMPARE(queue.runningMemoryCost(), qint64(150));
+
+    queue.finish(urlForIndex(3));
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.runningMemoryCost(), qint64(0));
+}
+
+void SaveQueueTest::testFailedJob()
+{
+    StubSaveQueue queue(1, 1000);
+    queue.mFailingUrls << urlForIndex(0) << urlForIndex(2);
+    for (int i = 0; i < 3; ++i) {
+        queue.enqueue(urlForIndex(i));
+    }
+    queue.startJobs();
+    // Failing urls do not block the queue
+    QCOMPARE(queue.runningJobCount(), 1);
+    QCOMPARE(queue.mStartedUrls.count(), 2);
+
+    queue.finish(urlForIndex(1));
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.mStartedUrls.count(), 3);
+}
+
+void SaveQueueTest::testCancel()
+{
+    StubSaveQueue queue(2, 1000);
+    QSignalSpy finishedSpy(&queue, &SaveQueue::jobFinished);
+    for (int i = 0; i < 4; ++i) {
+        queue.enqueue(urlForIndex(i));
+    }
+    queue.startJobs();
+    QCOMPARE(queue.runningJobCount(), 2);
+
+    queue.cancel();
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.runningMemoryCost(), qint64(0));
+    QCOMPARE(queue.mStartedUrls.count(), 2);
+    QCOMPARE(finishedSpy.count(), 0);
+}
@@ -26,10 +26,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <lib/semanticinfo/sorteddirmodel.h>
 
 // Qt
+#include <QFile>
 
 // KDE
 #include <qtest.h>
 #include <KDirLister>
+#include <KDirModel>
 #include <QTemporaryDir>
 
 using namespace Gwenview;
@@ -47,6 +49,15 @@ void SortedDirModelTest::initTestCase()
     createEmptyFile(mSandBoxDir.absoluteFilePath("dirs_and_docs/file.png"));
     mSandBoxDir.mkdir("docs_only");
     createEmptyFile(mSandBoxDir.absoluteFilePath("docs_only/file.png"));
+    // Name order is not the same as capture date order
+    mSandBoxDir.mkdir("dates");
+    QFile::copy(pathForTestFile("date/exif-datetime-only.jpg"), mSandBoxDir.absoluteFilePath("dates/a.jpg"));
+    QFile::copy(pathForTestFile("date/exif-datetimeoriginal.jpg"), mSandBoxDir.absoluteFilePath("dates/b.jpg"));
+    createEmptyFile(mSandBoxDir.absoluteFilePath("dates/c.png"));
+    // Kinds which cannot be told from the file name
+    mSandBoxDir.mkdir("no_extension");
+    QFile::copy(pathForTestFile("test.png"), mSandBoxDir.absoluteFilePath("no_extension/image"));
+    createEmptyFile(mSandBoxDir.absoluteFilePath("no_extension/notes.txt"));
 }
 
 void SortedDirModelTest::testHasDocuments_data()
@@ -75,3 +86,40 @@ void SortedDirModelTest::testHasDocuments()
     loop.exec();
     QCOMPARE(model.hasDocuments(), hasDocuments);
 }
+
+static QStringList fileNames(const SortedDirModel& model)
+{
+    QStringList names;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        names << model.itemForIndex(model.index(row, 0)).name();
+    }
+    return names;
+}
+
+void SortedDirModelTest::testSortByDate()
+{
+    SortedDirModel model;
+    QEventLoop loop;
+    connect(model.dirLister(), SIGNAL(completed()), &loop, SLOT(quit()));
+    model.dirLister()->openUrl(QUrl::fromLocalFile(mSandBoxDir.absoluteFilePath("dates")));
+    loop.exec();
+
+    model.sort(KDirModel::Name);
+    QCOMPARE(fileNames(model), QStringList({ "a.jpg", "b.jpg", "c.png" }));
+
+    // Capture dates are read asynchronously
+    model.sort(KDirModel::ModifiedTime);
+    QTRY_COMPARE(fileNames(model), QStringList({ "b.jpg", "a.jpg", "c.png" }));
+}
+
+void SortedDirModelTest::testKindFilterWithoutExtension()
+{
+    SortedDirModel model;
+    model.setKindFilter(MimeTypeUtils::KIND_RASTER_IMAGE);
+    QEventLoop loop;
+    connect(model.dirLister(), SIGNAL(completed()), &loop, SLOT(quit()));
+    model.dirLister()->openUrl(QUrl::fromLocalFile(mSandBoxDir.absoluteFilePath("no_extension")));
+    loop.exec();
+
+    QTRY_COMPARE(fileNames(model), QStringList() << "image");
+}
@@ -37,6 +37,8 @@ private Q_SLOTS:
     void initTestCase();
     void testHasDocuments_data();
     void testHasDocuments();
+    void testSortByDate();
+    void testKindFilterWithoutExtension();
 
 private:
     TestUtils::SandBoxDir mSandBoxDir;
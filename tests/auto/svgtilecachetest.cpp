@@ -0,0 +1,163 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include "svgtilecachetest.h"
+
+// Qt
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QSvgRenderer>
+#include <QTest>
+#include <QThreadPool>
+
+// Local
+#include "../lib/documentview/svgtilecache.h"
+#include "testutils.h"
+
+QTEST_MAIN(SvgTileCacheTest)
+
+using namespace Gwenview;
+
+// Memory used by a full tile
+static const int TILE_COST = 256 * 256 * 4;
+
+static const int TIMEOUT = 10000;
+
+/**
+ * Keeps a thread of the global pool busy until blocker is released
+ */
+class BlockingRunnable : public QRunnable
+{
+public:
+    BlockingRunnable(QSemaphore* started, QSemaphore* blocker)
+    : mStarted(started)
+    , mBlocker(blocker)
+    {}
+
+    void run() override
+    {
+        mStarted->release();
+        mBlocker->acquire();
+    }
+
+private:
+    QSemaphore* mStarted;
+    QSemaphore* mBlocker;
+};
+
+static QByteArray loadSvgData(QSize* size)
+{
+    QFile file(pathForTestFile("test.svg"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    const QByteArray data = file.readAll();
+    *size = QSvgRenderer(data).defaultSize();
+    return data;
+}
+
+static void paint(SvgTileCache* cache, const QSize& size, qreal zoom)
+{
+    QImage image(QSizeF(size * zoom).toSize(), QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    cache->paint(&painter, QPointF(), QRectF(QPointF(0, 0), QSizeF(size) * zoom), zoom, 1);
+}
+
+void SvgTileCacheTest::testMaxCost()
+{
+    QSize size;
+    const QByteArray data = loadSvgData(&size);
+    QVERIFY(!data.isEmpty());
+
+    SvgTileCache cache;
+    cache.setMaxCost(3 * TILE_COST);
+    QSignalSpy spy(&cache, &SvgTileCache::tileRendered);
+    cache.setSvgData(data, size);
+    // The preview
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, TIMEOUT);
+
+    // At this zoom the document takes 2 by 3 tiles: they do not all fit
+    const qreal zoom = 0.5;
+    paint(&cache, size, zoom);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 7, TIMEOUT);
+    QVERIFY(cache.cost() <= 3 * TILE_COST);
+    QVERIFY(cache.tileCount(zoom, 1) > 0);
+    QVERIFY(cache.tileCount(zoom, 1) < 6);
+}
+
+void SvgTileCacheTest::testZoomChange()
+{
+    QSize size;
+    const QByteArray data = loadSvgData(&size);
+    QVERIFY(!data.isEmpty());
+
+    SvgTileCache cache;
+    QSignalSpy spy(&cache, &SvgTileCache::tileRendered);
+    cache.setSvgData(data, size);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, TIMEOUT);
+
+    // Keep the worker threads busy, so that tiles stay queued
+    QThreadPool* pool = QThreadPool::globalInstance();
+    const int threadCount = pool->maxThreadCount();
+    QSemaphore started;
+    QSemaphore blocker;
+    for (int i = 0; i < threadCount; ++i) {
+        pool->start(new BlockingRunnable(&started, &blocker));
+    }
+    started.acquire(threadCount);
+
+    // The zoom changes before the tiles for the first one could be rendered:
+    // they must be skipped
+    const qreal oldZoom = 0.5;
+    const qreal newZoom = 0.25;
+    paint(&cache, size, oldZoom);
+    paint(&cache, size, newZoom);
+    blocker.release(threadCount);
+
+    // At this zoom, the document fits in 1 by 2 tiles
+    QTRY_COMPARE_WITH_TIMEOUT(cache.tileCount(newZoom, 1), 2, TIMEOUT);
+    // Skipped tiles are queued before the others, give their results a
+    // chance to arrive
+    QTest::qWait(100);
+    QCOMPARE(cache.tileCount(oldZoom, 1), 0);
+}
+
+void SvgTileCacheTest::testSetSvgData()
+{
+    QSize size;
+    const QByteArray data = loadSvgData(&size);
+    QVERIFY(!data.isEmpty());
+
+    SvgTileCache cache;
+    QSignalSpy spy(&cache, &SvgTileCache::tileRendered);
+    cache.setSvgData(data, size);
+    const qreal zoom = 0.25;
+    paint(&cache, size, zoom);
+    QTRY_COMPARE_WITH_TIMEOUT(cache.tileCount(zoom, 1), 2, TIMEOUT);
+    QVERIFY(cache.cost() > 0);
+
+    // Tiles of the previous document are dropped
+    cache.setSvgData(data, size);
+    QCOMPARE(cache.tileCount(zoom, 1), 0);
+    QCOMPARE(cache.cost(), 0);
+}
@@ -284,3 +284,27 @@ void ThumbnailProviderTest::testRemoveItemsWhileGenerating()
     provider.removeItems(list);
     loop.exec();
 }
+
+void ThumbnailProviderTest::testCacheThumbnails()
+{
+    // Cache thumbnails made from an image which differs from the file: if
+    // the provider returns them, it did not decode the file again
+    const QUrl url = QUrl::fromLocalFile(mSandBox.mPath + "/red.png");
+    const QSize fullSize = mSandBox.mSizeHash.value("red.png");
+    ThumbnailProvider::cacheThumbnails(url, createColoredImage(300, 200, Qt::yellow), fullSize);
+
+    for (ThumbnailGroup::Enum group : { ThumbnailGroup::Normal, ThumbnailGroup::Large }) {
+        ThumbnailProvider provider;
+        provider.setThumbnailGroup(group);
+        provider.appendItems(KFileItemList({ KFileItem(url) }));
+        QSignalSpy spy(&provider, SIGNAL(thumbnailLoaded(KFileItem,QPixmap,QSize,qulonglong)));
+        syncRun(&provider);
+
+        QCOMPARE(spy.count(), 1);
+        const QImage thumbnail = qvariant_cast<QPixmap>(spy.first().at(1)).toImage();
+        const int pixelSize = ThumbnailGroup::pixelSize(group);
+        QCOMPARE(qMax(thumbnail.width(), thumbnail.height()), qMin(pixelSize, 300));
+        QCOMPARE(QColor(thumbnail.pixel(0, 0)), QColor(Qt::yellow));
+        QCOMPARE(spy.first().at(2).toSize(), fullSize);
+    }
+}
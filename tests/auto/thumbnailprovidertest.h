@@ -50,6 +50,7 @@ private Q_SLOTS:
     void testLoadRemote();
     void testUseEmbeddedOrNot();
     void testRemoveItemsWhileGenerating();
+    void testCacheThumbnails();
 
 private:
     SandBox mSandBox;
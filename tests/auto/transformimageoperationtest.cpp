@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 // Local
 #include "../lib/document/documentfactory.h"
+#include "../lib/document/editchain.h"
 #include "../lib/imageutils.h"
 #include "../lib/transformimageoperation.h"
 #include "testutils.h"
@@ -67,3 +68,31 @@ void TransformImageOperationTest::testRotate90()
 
     QCOMPARE(image, doc->image());
 }
+
+void TransformImageOperationTest::testRotateDoesNotTransformPixels()
+{
+    QUrl url = urlForTestFile("test.png");
+    Document::Ptr doc = DocumentFactory::instance()->load(url);
+    doc->waitUntilLoaded();
+    const QImage image = doc->image();
+    const QSize size = doc->size();
+
+    QEventLoop loop;
+    connect(doc.data(), &Document::allTasksDone, &loop, &QEventLoop::quit);
+    TransformImageOperation* op = new TransformImageOperation(ROT_90);
+    op->applyToDocument(doc);
+    loop.exec();
+
+    // The rotation is only recorded
+    QCOMPARE(doc->size(), size.transposed());
+    QVERIFY(!doc->edits().isEmpty());
+    QCOMPARE(doc->sourceImage(), image);
+
+    // Rotating back cancels it
+    op = new TransformImageOperation(ROT_270);
+    op->applyToDocument(doc);
+    loop.exec();
+    QCOMPARE(doc->size(), size);
+    QVERIFY(doc->edits().isEmpty());
+    QCOMPARE(doc->image(), image);
+}
@@ -32,6 +32,7 @@ class TransformImageOperationTest : public QObject
 
 private Q_SLOTS:
     void testRotate90();
+    void testRotateDoesNotTransformPixels();
     void initTestCase();
     void init();
 };
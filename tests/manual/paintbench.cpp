@@ -0,0 +1,82 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+
+#include <lib/imageutils.h>
+
+const int ITERATIONS = 50;
+const QSize VIEWPORT_SIZE(1280, 800);
+
+static QImage createCheckBoardTexture()
+{
+    QImage texture(32, 32, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&texture);
+    painter.fillRect(texture.rect(), QColor(128, 128, 128));
+    const QColor light = QColor(192, 192, 192);
+    painter.fillRect(0, 0, 16, 16, light);
+    painter.fillRect(16, 16, 16, 16, light);
+    return texture;
+}
+
+// Mimics what RasterImageView::updateFromScaler() does for each scaled rect
+static void bench(const QImage& image, const QString& name)
+{
+    const QImage texture = createCheckBoardTexture();
+    QImage buffer(VIEWPORT_SIZE, QImage::Format_ARGB32_Premultiplied);
+    const QRect rect(QPoint(0, 0), image.size().boundedTo(VIEWPORT_SIZE));
+
+    QElapsedTimer chrono;
+    chrono.start();
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        QPainter painter(&buffer);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.fillRect(rect, QBrush(texture));
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        painter.drawImage(0, 0, image, 0, 0, rect.width(), rect.height());
+    }
+    qDebug() << name << "format:" << image.format()
+             << "per frame (ms):" << qreal(chrono.elapsed()) / ITERATIONS;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    if (argc != 2) {
+        qDebug() << "Usage: paintbench <file-with-alpha.png>";
+        return 1;
+    }
+
+    QImageReader reader(QString::fromUtf8(argv[1]));
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "Could not load image:" << reader.errorString();
+        return 2;
+    }
+
+    bench(image, QStringLiteral("Decoder format"));
+    bench(Gwenview::ImageUtils::convertToStorageFormat(image), QStringLiteral("Storage format"));
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include <QColor>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QVector>
+
+#include <math.h>
+
+#include <lib/pixelkernels.h>
+#include <lib/ramp.h>
+#include <lib/redeyereduction/redeyereductionimageoperation.h>
+
+using namespace Gwenview;
+
+const int ITERATIONS = 5;
+
+// Red eye reduction as it was implemented before PixelKernels: one QColor
+// per pixel, single thread
+static void legacyRedEye(QImage* img, const QRectF& rectF)
+{
+    const QRect rect = rectF.toAlignedRect();
+    const qreal radius = rectF.width() / 2;
+    const qreal centerX = rectF.x() + radius;
+    const qreal centerY = rectF.y() + radius;
+    const Ramp radiusRamp(qMin(qreal(radius * 0.7), qreal(radius - 1)), radius, qreal(1.), qreal(0.));
+
+    uchar* line = img->scanLine(rect.top()) + rect.left() * 4;
+    for (int y = rect.top(); y < rect.bottom(); ++y, line += img->bytesPerLine()) {
+        QRgb* ptr = (QRgb*)line;
+        for (int x = rect.left(); x < rect.right(); ++x, ++ptr) {
+            const qreal currentRadius = sqrt(pow(y - centerY, 2) + pow(x - centerX, 2));
+            qreal alpha = radiusRamp(currentRadius);
+            if (qFuzzyCompare(alpha, 0)) {
+                continue;
+            }
+            const QColor src(*ptr);
+            int hue, sat, value;
+            src.getHsv(&hue, &sat, &value);
+            const Ramp ramp = hue > 259 ? Ramp(30, 35, 0., 1.) : Ramp(hue * 2 + 29, hue * 2 + 40, 0., 1.);
+            alpha *= qBound(qreal(0.), src.alphaF() * ramp(sat), qreal(1.));
+            QColor dst;
+            dst.setRed(int((1 - alpha) * src.red() + alpha * src.green()));
+            dst.setGreen(src.green());
+            dst.setBlue(src.blue());
+            *ptr = dst.rgba();
+        }
+    }
+}
+
+static void benchRedEye(const QImage& image)
+{
+    // A big "eye", to measure the per-pixel cost
+    const int diameter = qMin(image.width(), image.height());
+    const QRectF rect(0, 0, diameter, diameter);
+
+    QElapsedTimer chrono;
+    chrono.start();
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        QImage result = image.copy();
+        legacyRedEye(&result, rect);
+    }
+    const qreal legacyTime = qreal(chrono.restart()) / ITERATIONS;
+
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        QImage result = image.copy();
+        RedEyeReductionImageOperation::apply(&result, rect);
+    }
+    const qreal kernelTime = qreal(chrono.elapsed()) / ITERATIONS;
+
+    qDebug() << "red eye, diameter:" << diameter
+             << "before (ms):" << legacyTime
+             << "after (ms):" << kernelTime;
+}
+
+// Same work as the FITS loader: planar 16-bit samples, clamped and scaled to
+// a RGB32 image
+static void benchSampleConversion(int width, int height)
+{
+    const int size = width * height;
+    QVector<quint16> buffer(size * 3);
+    for (int i = 0; i < buffer.size(); ++i) {
+        buffer[i] = quint16(i * 7);
+    }
+    const quint16 bMin = 1000;
+    const quint16 bMax = 60000;
+    const double scale = 255. / (bMax - bMin);
+    const double zero = -bMin * scale;
+    QImage image(width, height, QImage::Format_RGB32);
+
+    QElapsedTimer chrono;
+    chrono.start();
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        for (int j = 0; j < height; j++) {
+            QRgb* scanLine = reinterpret_cast<QRgb*>(image.scanLine(j));
+            for (int i = 0; i < width; i++) {
+                const double rval = qBound(bMin, buffer[j * width + i], bMax);
+                const double gval = qBound(bMin, buffer[j * width + i + size], bMax);
+                const double bval = qBound(bMin, buffer[j * width + i + size * 2], bMax);
+                scanLine[i] = qRgb(rval * scale + zero, gval * scale + zero, bval * scale + zero);
+            }
+        }
+    }
+    const qreal legacyTime = qreal(chrono.restart()) / ITERATIONS;
+
+    auto toByte = [=](quint16 sample) {
+        return int(qBound(0., double(qBound(bMin, sample, bMax)) * scale + zero, 255.));
+    };
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        PixelKernels::forEachRow(&image, image.rect(), [&](uchar* line, int, int j, int lineWidth) {
+            QRgb* scanLine = reinterpret_cast<QRgb*>(line);
+            const quint16* rSrc = buffer.constData() + j * width;
+            const quint16* gSrc = rSrc + size;
+            const quint16* bSrc = rSrc + size * 2;
+            for (int i = 0; i < lineWidth; i++) {
+                scanLine[i] = qRgb(toByte(rSrc[i]), toByte(gSrc[i]), toByte(bSrc[i]));
+            }
+        });
+    }
+    const qreal kernelTime = qreal(chrono.elapsed()) / ITERATIONS;
+
+    qDebug() << "sample conversion, size:" << width << "x" << height
+             << "before (ms):" << legacyTime
+             << "after (ms):" << kernelTime;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QImage image(4000, 4000, QImage::Format_RGB32);
+    image.fill(QColor(200, 40, 50));
+    benchRedEye(image);
+    benchRedEye(image.copy(0, 0, 100, 100));
+
+    benchSampleConversion(4000, 3000);
+    benchSampleConversion(256, 256);
+
+    return 0;
+}
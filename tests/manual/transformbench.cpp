@@ -0,0 +1,86 @@
+/*
+Gwenview: an image viewer
+Copyright 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QImageReader>
+
+#include <lib/imageutils.h>
+
+using namespace Gwenview;
+
+const int ITERATIONS = 5;
+
+static void bench(const QImage& image, Orientation orientation, const char* name)
+{
+    const QTransform matrix = ImageUtils::transformMatrix(orientation);
+
+    QElapsedTimer chrono;
+    chrono.start();
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        QImage result = image.transformed(matrix);
+    }
+    const qreal qtTime = qreal(chrono.restart()) / ITERATIONS;
+
+    for (int iteration = 0; iteration < ITERATIONS; ++iteration) {
+        QImage result = ImageUtils::transformed(image, orientation);
+    }
+    const qreal kernelTime = qreal(chrono.elapsed()) / ITERATIONS;
+
+    qDebug() << name << "format:" << image.format()
+             << "QImage::transformed() (ms):" << qtTime
+             << "ImageUtils::transformed() (ms):" << kernelTime;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QImage image;
+    if (argc == 2) {
+        QImageReader reader(QString::fromUtf8(argv[1]));
+        image = reader.read();
+        if (image.isNull()) {
+            qDebug() << "Could not load image:" << reader.errorString();
+            return 2;
+        }
+    } else if (argc == 1) {
+        // Same size as a 24 megapixel photo
+        image = QImage(6000, 4000, QImage::Format_RGB32);
+        image.fill(Qt::gray);
+    } else {
+        qDebug() << "Usage: transformbench [image]";
+        return 1;
+    }
+
+    const QImage images[] = {
+        ImageUtils::convertToStorageFormat(image),
+        image.convertToFormat(QImage::Format_Grayscale8)
+    };
+    for (const QImage& img : images) {
+        bench(img, ROT_90, "rot90");
+        bench(img, ROT_270, "rot270");
+        bench(img, ROT_180, "rot180");
+        bench(img, HFLIP, "hflip");
+        bench(img, VFLIP, "vflip");
+    }
+
+    return 0;
+}